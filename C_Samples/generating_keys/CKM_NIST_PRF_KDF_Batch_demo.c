@@ -0,0 +1,420 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The " luna-samples" project is provided under the MIT license (see the         *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2024 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to derive a large number of keys from one base key using CKM_NIST_PRF_KDF.
+	- A list of <context>,<label> pairs is read from a file. Each line produces one derived AES key.
+	- The context is used as the KDF context (for example a tenant id) and the label becomes the CKA_LABEL of the derived key.
+	- The base key is located only once. KDF parameters for every pair are built before any thread starts.
+	- The derived key template is built once and each thread only patches the CKA_LABEL entry in its own copy.
+	- Derivations are spread across multiple threads, each with its own session, so that the HSM can process them in parallel.
+
+	Example of an input file :-
+		tenant-0001,tenant-0001-dek
+		tenant-0002,tenant-0002-dek
+*/
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+#define MAX_LINE_LEN 256 // Maximum length of one line in the input file.
+#define JOBS_PER_CLAIM 32 // Number of derivations a thread claims at a time.
+
+
+// One entry per <context>,<label> pair.
+typedef struct
+{
+	CK_BYTE *context;
+	CK_BYTE *label;
+	CK_PRF_KDF_PARAMS param; // Pre-built KDF parameters for this pair.
+	CK_OBJECT_HANDLE hDerived;
+	CK_RV rv;
+} DERIVE_JOB;
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+CK_BYTE *baseKeyLabel = NULL; // Label of the base AES key.
+CK_OBJECT_HANDLE hMaster = 0;
+
+DERIVE_JOB *jobs = NULL;
+CK_ULONG jobCount = 0;
+CK_ULONG nextJob = 0; // Index of the next job to be claimed by a thread.
+pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+int nThreads = 0;
+
+CK_BYTE kdfLabel[] = "tenant-key"; // KDF label shared by all derivations.
+
+// Template for derived keys. Values are shared by all threads, CKA_LABEL is patched per key.
+CK_BBOOL yes = CK_TRUE;
+CK_BBOOL no = CK_FALSE;
+CK_KEY_TYPE keyType = CKK_AES;
+CK_ULONG keyLen = 32;
+CK_ATTRIBUTE derivedTemplate[] =
+{
+	{CKA_TOKEN,             &yes,           sizeof(CK_BBOOL)},
+	{CKA_PRIVATE,           &yes,           sizeof(CK_BBOOL)},
+	{CKA_SENSITIVE,         &yes,           sizeof(CK_BBOOL)},
+	{CKA_MODIFIABLE,        &no,            sizeof(CK_BBOOL)},
+	{CKA_EXTRACTABLE,       &no,            sizeof(CK_BBOOL)},
+	{CKA_ENCRYPT,           &yes,           sizeof(CK_BBOOL)},
+	{CKA_DECRYPT,           &yes,           sizeof(CK_BBOOL)},
+	{CKA_WRAP,              &no,            sizeof(CK_BBOOL)},
+	{CKA_UNWRAP,            &no,            sizeof(CK_BBOOL)},
+	{CKA_VALUE_LEN,         &keyLen,        sizeof(CK_ULONG)},
+	{CKA_KEY_TYPE,          &keyType,       sizeof(CK_KEY_TYPE)},
+	{CKA_LABEL,             NULL,           0} // Must remain the last entry.
+};
+#define TEMPLATE_LEN (sizeof(derivedTemplate)/sizeof(*derivedTemplate))
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+	for(CK_ULONG ctr=0; ctr<jobCount; ctr++)
+	{
+		free(jobs[ctr].context);
+		free(jobs[ctr].label);
+	}
+	free(jobs);
+        free(slotPin);
+	free(baseKeyLabel);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// This function finds the base key to be used for key derivation.
+void findBaseKey()
+{
+        CK_OBJECT_CLASS objClass = CKO_SECRET_KEY;
+	CK_OBJECT_HANDLE handles[1];
+	CK_ULONG objectCount = 0;
+
+        CK_ATTRIBUTE attrib[] =
+        {
+                {CKA_PRIVATE,   	&yes,           sizeof(CK_BBOOL)},
+                {CKA_TOKEN,             &yes,           sizeof(CK_BBOOL)},
+                {CKA_CLASS,             &objClass,      sizeof(CK_OBJECT_CLASS)},
+		{CKA_KEY_TYPE,		&keyType,	sizeof(CK_KEY_TYPE)},
+		{CKA_LABEL,		baseKeyLabel,	strlen(baseKeyLabel)}
+        };
+
+	checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, 5), "C_FindObjectsInit");
+	checkOperation(p11Func->C_FindObjects(hSession, handles, 1, &objectCount), "C_FindObjects");
+	checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+	if(objectCount==0)
+	{
+		printf("\nBase key [ %s ], not found.\n", baseKeyLabel);
+	}
+	else
+	{
+		hMaster = handles[0];
+		printf("  --> Base key found. Handle : %lu\n", hMaster);
+	}
+}
+
+
+
+// Reads <context>,<label> pairs from a file and builds the KDF parameters for each of them.
+void loadJobs(const char *fileName)
+{
+	FILE *fp = NULL;
+	char line[MAX_LINE_LEN];
+	char *comma = NULL;
+	CK_ULONG capacity = 1024;
+
+	fp = fopen(fileName, "r");
+	if(fp==NULL)
+	{
+		printf("Failed to open %s.\n", fileName);
+		exit(1);
+	}
+
+	jobs = (DERIVE_JOB*)calloc(capacity, sizeof(DERIVE_JOB));
+	while(fgets(line, sizeof(line), fp)!=NULL)
+	{
+		line[strcspn(line, "\r\n")] = '\0';
+		comma = strchr(line, ',');
+		if(comma==NULL || comma==line || *(comma+1)=='\0')
+			continue; // Skips empty or malformed lines.
+		*comma = '\0';
+
+		if(jobCount==capacity)
+		{
+			capacity *= 2;
+			jobs = (DERIVE_JOB*)realloc(jobs, capacity * sizeof(DERIVE_JOB));
+		}
+
+		DERIVE_JOB *job = &jobs[jobCount++];
+		job->context = (CK_BYTE*)strdup(line);
+		job->label = (CK_BYTE*)strdup(comma+1);
+		job->hDerived = 0;
+		job->rv = CKR_OK;
+
+		job->param.prfType = CK_NIST_PRF_KDF_AES_CMAC;
+		job->param.pLabel = kdfLabel;
+		job->param.ulLabelLen = sizeof(kdfLabel)-1;
+		job->param.pContext = job->context;
+		job->param.ulContextLen = strlen((const char*)job->context);
+		job->param.ulCounter = 1;
+		job->param.ulEncodingScheme = LUNA_PRF_KDF_ENCODING_SCHEME_1;
+	}
+	fclose(fp);
+
+	printf("\n> %lu <context>,<label> pairs loaded from %s.\n", jobCount, fileName);
+}
+
+
+
+// Claims the next range of jobs. Returns 0 when no jobs are left.
+int claimJobs(CK_ULONG *first, CK_ULONG *last)
+{
+	int claimed = 0;
+
+	pthread_mutex_lock(&jobLock);
+	if(nextJob<jobCount)
+	{
+		*first = nextJob;
+		nextJob += JOBS_PER_CLAIM;
+		if(nextJob>jobCount)
+			nextJob = jobCount;
+		*last = nextJob;
+		claimed = 1;
+	}
+	pthread_mutex_unlock(&jobLock);
+	return claimed;
+}
+
+
+
+// Thread function; derives keys for the claimed jobs using its own session.
+void *deriveKeys(void *arg)
+{
+	CK_SESSION_HANDLE hChildSession = 0;
+	CK_ATTRIBUTE attrib[TEMPLATE_LEN];
+	CK_MECHANISM mech = {CKM_NIST_PRF_KDF, NULL, sizeof(CK_PRF_KDF_PARAMS)};
+	CK_ULONG first = 0, last = 0;
+
+	memcpy(attrib, derivedTemplate, sizeof(derivedTemplate));
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hChildSession), "C_OpenSession");
+
+	while(claimJobs(&first, &last))
+	{
+		for(CK_ULONG ctr=first; ctr<last; ctr++)
+		{
+			mech.pParameter = &jobs[ctr].param;
+			attrib[TEMPLATE_LEN-1].pValue = jobs[ctr].label;
+			attrib[TEMPLATE_LEN-1].ulValueLen = strlen((const char*)jobs[ctr].label);
+			jobs[ctr].rv = p11Func->C_DeriveKey(hChildSession, &mech, hMaster, attrib, TEMPLATE_LEN, &jobs[ctr].hDerived);
+		}
+	}
+
+	checkOperation(p11Func->C_CloseSession(hChildSession), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Starts the worker threads and reports the derivation rate.
+void deriveAllKeys()
+{
+	pthread_t *workers = NULL;
+	struct timespec start, end;
+	double elapsed = 0;
+	CK_ULONG failed = 0;
+
+	workers = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+
+	printf("\n> Deriving %lu keys using %d threads.\n", jobCount, nThreads);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&workers[ctr], NULL, &deriveKeys, NULL);
+
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(workers[ctr], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	free(workers);
+
+	for(CK_ULONG ctr=0; ctr<jobCount; ctr++)
+	{
+		if(jobs[ctr].rv!=CKR_OK)
+		{
+			printf("  --> [ %s ] failed with Ox%lX\n", jobs[ctr].label, jobs[ctr].rv);
+			failed++;
+		}
+	}
+
+	elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("\n> %lu AES keys derived, %lu failed.\n", jobCount-failed, failed);
+	printf("  --> Time taken : %.3f seconds.\n", elapsed);
+	if(elapsed>0)
+		printf("  --> Keys per second : %.1f\n", (jobCount-failed)/elapsed);
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <base_AES-KEY_label> <pairs_file> <number_of_threads>\n\n", exeName);
+	printf("Each line of <pairs_file> must be in the form : <context>,<label>\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<6) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+	baseKeyLabel = (CK_BYTE*)strdup((const char*)argv[3]);
+	nThreads = atoi((const char*)argv[5]);
+	if(nThreads<1)
+		nThreads = 1;
+
+	loadJobs((const char*)argv[4]);
+	loadLunaLibrary();
+	connectToLunaSlot();
+	findBaseKey();
+
+	// Derivation is skipped if the base-key wasn't found.
+	if(hMaster!=0 && jobCount>0)
+		deriveAllKeys();
+
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,417 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The " luna-samples" project is provided under the MIT license (see the         *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2024 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+
+	OBJECTIVE :
+	- This sample measures the cost of CKM_PKCS5_PBKD2 on a Luna HSM and recommends an iteration count.
+	- Key derivation is timed over a sweep of PRFs, salt sizes, iteration counts and thread counts.
+	- For each combination, throughput (derivations per second) and latency percentiles are displayed.
+	- For each PRF and salt size, the highest iteration count whose p95 latency at the highest thread count
+	  stays within the given latency budget is recommended.
+	- Derived keys are session keys and are destroyed right after they are timed.
+	- Please note that this mechanism is not FIPS Approved and will not work on Luna HSMs configured to operate in FIPS mode.
+*/
+
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+
+// Pseudo random functions to benchmark.
+typedef struct
+{
+	CK_ULONG prf;
+	const char *name;
+} PRF_ENTRY;
+
+PRF_ENTRY prfList[] =
+{
+	{CKP_PKCS5_PBKD2_HMAC_SHA1,	"HMAC-SHA1"},
+	{CKP_PKCS5_PBKD2_HMAC_SHA256,	"HMAC-SHA256"},
+	{CKP_PKCS5_PBKD2_HMAC_SHA512,	"HMAC-SHA512"}
+};
+#define PRF_COUNT (sizeof(prfList)/sizeof(*prfList))
+
+CK_ULONG saltSizes[] = {16, 32, 64};
+#define SALT_COUNT (sizeof(saltSizes)/sizeof(*saltSizes))
+
+CK_ULONG iterationCounts[] = {1000, 10000, 50000, 100000, 210000, 310000, 600000};
+#define ITERATION_COUNT (sizeof(iterationCounts)/sizeof(*iterationCounts))
+
+
+// Parameters of one measurement, shared by all the threads running it.
+typedef struct
+{
+	CK_ULONG prf;
+	CK_ULONG saltLen;
+	CK_ULONG iterations;
+	int opsPerThread;
+	double *latencies; // opsPerThread entries per thread, in milliseconds.
+} RUN_CONFIG;
+
+typedef struct
+{
+	RUN_CONFIG *config;
+	int index;
+} THREAD_ARG;
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+
+CK_BYTE salt[64]; // Random salt, the first saltLen bytes are used.
+const CK_BYTE password[] = "Th3W0rld$M0$+$3cur3P@$$w0rd";
+double latencyBudget = 0; // Target p95 latency in milliseconds.
+int maxThreads = 0;
+int opsPerThread = 0;
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+        free(slotPin);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the time elapsed between two timestamps in milliseconds.
+double elapsedMs(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e3 + (end->tv_nsec - start->tv_nsec) / 1e6;
+}
+
+
+
+// Used by qsort to sort latencies.
+int compareDouble(const void *a, const void *b)
+{
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+
+
+// Thread function; derives opsPerThread AES-256 keys using the given configuration and records the latency of each one.
+void *deriveKeys(void *arg)
+{
+	THREAD_ARG *threadArg = (THREAD_ARG*)arg;
+	RUN_CONFIG *config = threadArg->config;
+	double *latencies = config->latencies + (threadArg->index * config->opsPerThread);
+	CK_SESSION_HANDLE hChildSession = 0;
+	CK_OBJECT_HANDLE hDerived = 0;
+	CK_PKCS5_PBKD2_PARAMS param;
+	struct timespec start, end;
+
+	CK_BBOOL yes = CK_TRUE;
+	CK_BBOOL no = CK_FALSE;
+	CK_KEY_TYPE keyType = CKK_AES;
+	CK_ULONG keyLen = 32;
+	CK_OBJECT_CLASS objClass = CKO_SECRET_KEY;
+	CK_MECHANISM mech = {CKM_PKCS5_PBKD2, &param, sizeof(param)};
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_TOKEN,             &no,            sizeof(CK_BBOOL)},
+		{CKA_PRIVATE,           &yes,           sizeof(CK_BBOOL)},
+		{CKA_ENCRYPT,           &yes,           sizeof(CK_BBOOL)},
+		{CKA_DECRYPT,           &yes,           sizeof(CK_BBOOL)},
+		{CKA_EXTRACTABLE,       &no,            sizeof(CK_BBOOL)},
+		{CKA_VALUE_LEN,         &keyLen,        sizeof(CK_ULONG)},
+		{CKA_CLASS,             &objClass,      sizeof(CK_OBJECT_CLASS)},
+		{CKA_KEY_TYPE,          &keyType,       sizeof(CK_KEY_TYPE)}
+	};
+	CK_ULONG attribLen = sizeof(attrib) / sizeof(*attrib);
+
+	param.saltSource = CKZ_SALT_SPECIFIED;
+	param.pSaltSourceData = (CK_VOID_PTR)salt;
+	param.ulSaltSourceDataLen = config->saltLen;
+	param.iterations = config->iterations;
+	param.prf = config->prf;
+	param.pPrfData = NULL;
+	param.ulPrfDataLen = 0;
+	param.pPassword = (CK_UTF8CHAR_PTR)password;
+	param.ulPasswordLen = (CK_ULONG_PTR)(sizeof(password)-1);
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hChildSession), "C_OpenSession");
+	for(int ctr=0; ctr<config->opsPerThread; ctr++)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		checkOperation(p11Func->C_GenerateKey(hChildSession, &mech, attrib, attribLen, &hDerived), "C_GenerateKey");
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		latencies[ctr] = elapsedMs(&start, &end);
+		checkOperation(p11Func->C_DestroyObject(hChildSession, hDerived), "C_DestroyObject");
+	}
+	checkOperation(p11Func->C_CloseSession(hChildSession), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Runs one measurement with nThreads threads and prints its result. Returns the p95 latency in milliseconds.
+double runMeasurement(RUN_CONFIG *config, int nThreads, double *throughput)
+{
+	pthread_t *workers = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	THREAD_ARG *args = (THREAD_ARG*)malloc(nThreads * sizeof(THREAD_ARG));
+	int total = nThreads * config->opsPerThread;
+	struct timespec start, end;
+	double wall, mean = 0, p50, p95, p99;
+
+	config->latencies = (double*)calloc(total, sizeof(double));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+	{
+		args[ctr].config = config;
+		args[ctr].index = ctr;
+		pthread_create(&workers[ctr], NULL, &deriveKeys, &args[ctr]);
+	}
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(workers[ctr], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	wall = elapsedMs(&start, &end);
+
+	qsort(config->latencies, total, sizeof(double), compareDouble);
+	for(int ctr=0; ctr<total; ctr++)
+		mean += config->latencies[ctr];
+	mean /= total;
+	p50 = config->latencies[(total * 50) / 100];
+	p95 = config->latencies[(total * 95) / 100 < total ? (total * 95) / 100 : total-1];
+	p99 = config->latencies[(total * 99) / 100 < total ? (total * 99) / 100 : total-1];
+	*throughput = total / (wall / 1e3);
+
+	printf("  %7lu | %7d | %10.1f | %9.2f | %9.2f | %9.2f | %9.2f\n",
+		config->iterations, nThreads, *throughput, mean, p50, p95, p99);
+
+	free(config->latencies);
+	free(args);
+	free(workers);
+	return p95;
+}
+
+
+
+// Runs the whole sweep and prints the recommended iteration count for each PRF and salt size.
+void runBenchmark()
+{
+	RUN_CONFIG config;
+	CK_ULONG recommended[PRF_COUNT][SALT_COUNT];
+	double recommendedRate[PRF_COUNT][SALT_COUNT];
+	double throughput = 0, p95 = 0;
+
+	checkOperation(p11Func->C_GenerateRandom(hSession, salt, sizeof(salt)), "C_GenerateRandom");
+	config.opsPerThread = opsPerThread;
+
+	for(int p=0; p<PRF_COUNT; p++)
+	{
+		for(int s=0; s<SALT_COUNT; s++)
+		{
+			recommended[p][s] = 0;
+			recommendedRate[p][s] = 0;
+			config.prf = prfList[p].prf;
+			config.saltLen = saltSizes[s];
+
+			printf("\n> PRF : %s, Salt : %lu bytes.\n", prfList[p].name, saltSizes[s]);
+			printf("  %7s | %7s | %10s | %9s | %9s | %9s | %9s\n", "iter", "threads", "ops/sec", "mean(ms)", "p50(ms)", "p95(ms)", "p99(ms)");
+
+			for(int t=1; t<=maxThreads; t*=2)
+			{
+				int nThreads = (t*2>maxThreads) ? maxThreads : t;
+				for(int i=0; i<ITERATION_COUNT; i++)
+				{
+					config.iterations = iterationCounts[i];
+					p95 = runMeasurement(&config, nThreads, &throughput);
+
+					// Higher iteration counts would only be slower.
+					if(p95>latencyBudget)
+						break;
+
+					if(nThreads==maxThreads)
+					{
+						recommended[p][s] = iterationCounts[i];
+						recommendedRate[p][s] = throughput;
+					}
+				}
+				if(nThreads==maxThreads)
+					break;
+			}
+		}
+	}
+
+	printf("\n> Recommended iteration counts for a p95 budget of %.1f ms at %d threads.\n", latencyBudget, maxThreads);
+	for(int p=0; p<PRF_COUNT; p++)
+	{
+		for(int s=0; s<SALT_COUNT; s++)
+		{
+			if(recommended[p][s]==0)
+				printf("  --> %-11s, salt %2lu bytes : budget not met even at %lu iterations.\n", prfList[p].name, saltSizes[s], iterationCounts[0]);
+			else
+				printf("  --> %-11s, salt %2lu bytes : %lu iterations (%.1f derivations/sec).\n", prfList[p].name, saltSizes[s], recommended[p][s], recommendedRate[p][s]);
+		}
+	}
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <p95_latency_budget_ms> <max_threads> <ops_per_thread>\n\n", exeName);
+	printf("Example :-\n");
+	printf("%s 0 userpin 250 16 20\n\n", exeName);
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<6) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+	latencyBudget = atof((const char*)argv[3]);
+	maxThreads = atoi((const char*)argv[4]);
+	opsPerThread = atoi((const char*)argv[5]);
+	if(maxThreads<1)
+		maxThreads = 1;
+	if(opsPerThread<1)
+		opsPerThread = 1;
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+	runBenchmark();
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,605 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+
+
+        OBJECTIVE :
+	- This sample demonstrates how to cache the mechanisms supported by all slots, so they are not queried on every run.
+	- On the first run, C_GetMechanismList and C_GetMechanismInfo are called for every slot with a token present,
+	  and the results are written to a cache file.
+	- The cache of a slot is identified by the token serial number and firmware version. On the following runs only
+	  C_GetTokenInfo is called, and a slot is queried again only when its token or firmware has changed.
+	- Mechanisms can also change without a firmware update (e.g. a policy change or a new capability license), so each
+	  entry records when it was queried and is queried again once it is older than maxage (24 hours by default).
+	  The refresh option ignores the cache and queries every slot.
+	- When the cache of a slot is built, a perfect hash of its mechanism codes is computed (hash and displace: the codes
+	  are split in small groups, and a seed is searched for each group so that every code lands in its own bucket).
+	  The seeds are kept in the cache file, so a lookup by mechanism code is a single probe.
+	- Mechanism names are resolved with the shared table in mechanism_names.h.
+	- The mechanisms given as arguments (by name, e.g. CKM_AES_GCM, or by code, e.g. 0x1087) are looked up in every slot.
+*/
+
+
+
+
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "mechanism_names.h"
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+        #include <unistd.h> // For fsync.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+#define CACHE_MAGIC 0x4C4D4343 // "LMCC"
+#define CACHE_VERSION 2
+#define EMPTY_BUCKET 0xFFFF
+#define MAX_SEED_ATTEMPTS 65536
+#define KEYS_PER_GROUP 4
+#define DEFAULT_MAX_AGE_HOURS 24
+
+
+// Capabilities of one mechanism, as stored in the cache file.
+typedef struct
+{
+	uint32_t code;
+	uint32_t flags;
+	uint32_t minKeySize;
+	uint32_t maxKeySize;
+} MECHANISM_CAPABILITY;
+
+
+// Perfect hash table of 32-bit keys.
+// buckets[hash(key, seeds[group(key)])] is the index of the key, or EMPTY_BUCKET.
+typedef struct
+{
+	uint32_t groupBits;
+	uint32_t bucketBits;
+	uint16_t *seeds;
+	uint16_t *buckets;
+} PERFECT_HASH;
+
+
+// Cached mechanisms of one slot.
+typedef struct
+{
+	CK_SLOT_ID slotId;
+	CK_CHAR serialNumber[16];
+	CK_VERSION firmwareVersion;
+	uint64_t fetchedAt; // Time the mechanisms were queried, in seconds since the epoch.
+	uint32_t mechanismCount;
+	MECHANISM_CAPABILITY *mechanisms;
+	PERFECT_HASH hash;
+} SLOT_CAPABILITIES;
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+
+SLOT_CAPABILITIES *slotCaps = NULL;
+CK_ULONG slotCount = 0;
+int cacheUpdated = 0;
+int staleEntries = 0;
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+	CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+	char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+	if(libPath==NULL)
+	{
+		printf("P11_LIB environment variable not set.\n");
+		printf("\n > On Unix/Linux :-\n");
+		printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\n > On Windows :-\n");
+		printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\nExample :-");
+		printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+		printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+		exit(1);
+	}
+
+
+	#ifdef OS_UNIX
+		libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+	#else
+		libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+	#endif
+	if(!libHandle)
+	{
+		printf("Failed to load Luna library from path : %s\n", libPath);
+		exit(1);
+	}
+
+
+	#ifdef OS_UNIX
+	    C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+	#else
+		C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+	#endif
+
+	C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+	if(p11Func==NULL)
+	{
+		printf("Failed to load P11 functions.\n");
+		exit(1);
+	}
+
+	printf ("\n> P11 library loaded.\n");
+	printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+	for(CK_ULONG ctr=0; ctr<slotCount; ctr++)
+	{
+		free(slotCaps[ctr].mechanisms);
+		free(slotCaps[ctr].hash.seeds);
+		free(slotCaps[ctr].hash.buckets);
+	}
+	free(slotCaps);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Returns the time elapsed since start in milliseconds.
+double elapsedMs(struct timespec *start)
+{
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) * 1e3 + (end.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+
+
+// Hashes a 32-bit key into a table of 2^bits buckets.
+static uint32_t bucketOf(uint32_t key, uint32_t seed, uint32_t bits)
+{
+	uint32_t h = (key ^ seed) * 0x9E3779B1u;
+	h ^= h >> 15;
+	h *= 0x85EBCA77u;
+	return h >> (32 - bits);
+}
+
+
+
+// Builds a perfect hash of distinct keys (hash and displace).
+// The keys are split in groups of about KEYS_PER_GROUP keys. Starting with the largest group, a seed is searched
+// for each group so that all its keys land in empty buckets. Returns 0 if no seed was found for a group.
+int buildPerfectHash(const uint32_t *keys, uint32_t count, PERFECT_HASH *hash)
+{
+	uint32_t groupCount = 0, bucketCount = 0, group = 0, ctr = 0, used = 0;
+	uint32_t *groupOf = (uint32_t*)malloc((count ? count : 1) * sizeof(uint32_t));
+	uint32_t *groupSize = NULL;
+	uint32_t *slots = (uint32_t*)malloc((count ? count : 1) * sizeof(uint32_t));
+	int placed = 1;
+
+	for(hash->groupBits=1; (1u << hash->groupBits)*KEYS_PER_GROUP<count; hash->groupBits++);
+	for(hash->bucketBits=1; (1u << hash->bucketBits)<count*2; hash->bucketBits++);
+	groupCount = 1u << hash->groupBits;
+	bucketCount = 1u << hash->bucketBits;
+	hash->seeds = (uint16_t*)calloc(groupCount, sizeof(uint16_t));
+	hash->buckets = (uint16_t*)malloc(bucketCount * sizeof(uint16_t));
+	groupSize = (uint32_t*)calloc(groupCount, sizeof(uint32_t));
+	memset(hash->buckets, 0xFF, bucketCount * sizeof(uint16_t));
+
+	for(ctr=0; ctr<count; ctr++)
+	{
+		groupOf[ctr] = bucketOf(keys[ctr], 0xFFFFFFFFu, hash->groupBits);
+		groupSize[groupOf[ctr]]++;
+	}
+
+	// Largest groups first, while most buckets are still empty.
+	for(uint32_t size=count; size>0 && placed; size--)
+	{
+		for(group=0; group<groupCount && placed; group++)
+		{
+			if(groupSize[group]!=size)
+				continue;
+			placed = 0;
+			for(uint32_t seed=0; seed<MAX_SEED_ATTEMPTS && !placed; seed++)
+			{
+				used = 0;
+				for(ctr=0; ctr<count; ctr++)
+				{
+					if(groupOf[ctr]!=group)
+						continue;
+					slots[used] = bucketOf(keys[ctr], seed, hash->bucketBits);
+					if(hash->buckets[slots[used]]!=EMPTY_BUCKET)
+						break;
+					hash->buckets[slots[used++]] = (uint16_t)ctr;
+				}
+				if(ctr==count)
+				{
+					hash->seeds[group] = (uint16_t)seed;
+					placed = 1;
+				}
+				else
+				{
+					while(used>0)
+						hash->buckets[slots[--used]] = EMPTY_BUCKET;
+				}
+			}
+		}
+	}
+
+	free(groupOf);
+	free(groupSize);
+	free(slots);
+	return placed;
+}
+
+
+
+// Returns the index stored for a key, or EMPTY_BUCKET. The caller compares the key at that index.
+static uint16_t perfectHashLookup(PERFECT_HASH *hash, uint32_t key)
+{
+	uint16_t seed = hash->seeds[bucketOf(key, 0xFFFFFFFFu, hash->groupBits)];
+	return hash->buckets[bucketOf(key, seed, hash->bucketBits)];
+}
+
+
+
+// Returns the code of a mechanism name, or of a hexadecimal code. Returns 0 if the name is unknown.
+int mechanismCode(const char *name, CK_MECHANISM_TYPE *code)
+{
+	if(strncmp(name, "0x", 2)==0 || strncmp(name, "0X", 2)==0)
+	{
+		*code = strtoul(name, NULL, 16);
+		return 1;
+	}
+	return mechanismCodeOf(name, code);
+}
+
+
+
+// Returns the capabilities of a mechanism in a slot, or NULL if the slot does not support it.
+MECHANISM_CAPABILITY *findCapability(SLOT_CAPABILITIES *caps, CK_MECHANISM_TYPE code)
+{
+	uint16_t index = perfectHashLookup(&caps->hash, (uint32_t)code);
+
+	if(index==EMPTY_BUCKET || caps->mechanisms[index].code!=(uint32_t)code)
+		return NULL;
+	return &caps->mechanisms[index];
+}
+
+
+
+// Queries the mechanisms of a slot and builds its hash table.
+void fetchCapabilities(SLOT_CAPABILITIES *caps)
+{
+	CK_MECHANISM_TYPE *mechList = NULL;
+	CK_MECHANISM_INFO mechInfo;
+	CK_ULONG listSize = 0;
+	uint32_t *keys = NULL;
+
+	checkOperation(p11Func->C_GetMechanismList(caps->slotId, NULL_PTR, &listSize), "C_GetMechanismList");
+	mechList = (CK_MECHANISM_TYPE*)malloc(listSize * sizeof(CK_MECHANISM_TYPE));
+	checkOperation(p11Func->C_GetMechanismList(caps->slotId, mechList, &listSize), "C_GetMechanismList");
+
+	caps->mechanismCount = (uint32_t)listSize;
+	caps->mechanisms = (MECHANISM_CAPABILITY*)malloc((listSize ? listSize : 1) * sizeof(MECHANISM_CAPABILITY));
+	keys = (uint32_t*)malloc((listSize ? listSize : 1) * sizeof(uint32_t));
+	for(CK_ULONG ctr=0; ctr<listSize; ctr++)
+	{
+		checkOperation(p11Func->C_GetMechanismInfo(caps->slotId, mechList[ctr], &mechInfo), "C_GetMechanismInfo");
+		caps->mechanisms[ctr].code = (uint32_t)mechList[ctr];
+		caps->mechanisms[ctr].flags = (uint32_t)mechInfo.flags;
+		caps->mechanisms[ctr].minKeySize = (uint32_t)mechInfo.ulMinKeySize;
+		caps->mechanisms[ctr].maxKeySize = (uint32_t)mechInfo.ulMaxKeySize;
+		keys[ctr] = (uint32_t)mechList[ctr];
+	}
+
+	if(!buildPerfectHash(keys, caps->mechanismCount, &caps->hash))
+	{
+		printf("Failed to build the mechanism table of slot %lu.\n", caps->slotId);
+		exit(1);
+	}
+	free(keys);
+	free(mechList);
+	caps->fetchedAt = (uint64_t)time(NULL);
+	cacheUpdated = 1;
+}
+
+
+
+// Reads the cache file. Slots whose token serial number and firmware version match are taken from the cache,
+// unless the entry is older than maxAge seconds.
+void loadCache(const char *cacheFile, uint64_t maxAge)
+{
+	uint64_t now = (uint64_t)time(NULL);
+	FILE *file = fopen(cacheFile, "rb");
+	uint32_t header[3];
+	SLOT_CAPABILITIES cached;
+	CK_ULONG ctr = 0;
+	int ok = 1;
+
+	if(!file)
+		return;
+	if(fread(header, sizeof(uint32_t), 3, file)!=3 || header[0]!=CACHE_MAGIC || header[1]!=CACHE_VERSION)
+	{
+		fclose(file);
+		return;
+	}
+
+	for(uint32_t entry=0; entry<header[2] && ok; entry++)
+	{
+		memset(&cached, 0, sizeof(cached));
+		ok = fread(cached.serialNumber, 1, sizeof(cached.serialNumber), file)==sizeof(cached.serialNumber) &&
+			fread(&cached.firmwareVersion, sizeof(CK_VERSION), 1, file)==1 &&
+			fread(&cached.fetchedAt, sizeof(uint64_t), 1, file)==1 &&
+			fread(&cached.mechanismCount, sizeof(uint32_t), 1, file)==1 &&
+			fread(&cached.hash.groupBits, sizeof(uint32_t), 1, file)==1 &&
+			fread(&cached.hash.bucketBits, sizeof(uint32_t), 1, file)==1 &&
+			cached.hash.groupBits<16 && cached.hash.bucketBits<16;
+		if(!ok)
+			break;
+
+		cached.mechanisms = (MECHANISM_CAPABILITY*)malloc((cached.mechanismCount ? cached.mechanismCount : 1) * sizeof(MECHANISM_CAPABILITY));
+		cached.hash.seeds = (uint16_t*)malloc((1u << cached.hash.groupBits) * sizeof(uint16_t));
+		cached.hash.buckets = (uint16_t*)malloc((1u << cached.hash.bucketBits) * sizeof(uint16_t));
+		ok = fread(cached.mechanisms, sizeof(MECHANISM_CAPABILITY), cached.mechanismCount, file)==cached.mechanismCount &&
+			fread(cached.hash.seeds, sizeof(uint16_t), 1u << cached.hash.groupBits, file)==(1u << cached.hash.groupBits) &&
+			fread(cached.hash.buckets, sizeof(uint16_t), 1u << cached.hash.bucketBits, file)==(1u << cached.hash.bucketBits);
+
+		// A bucket pointing past the mechanisms would be read on lookup, so the whole cache is rejected.
+		for(uint32_t bucket=0; ok && bucket<(1u << cached.hash.bucketBits); bucket++)
+			ok = cached.hash.buckets[bucket]==EMPTY_BUCKET || cached.hash.buckets[bucket]<cached.mechanismCount;
+
+		// Hands the entry over to the slot with the same token, if any. An expired entry (or one from the future,
+		// after a clock change) is dropped, and the slot is queried again.
+		for(ctr=0; ok && ctr<slotCount; ctr++)
+		{
+			if(slotCaps[ctr].mechanisms==NULL &&
+			   memcmp(slotCaps[ctr].serialNumber, cached.serialNumber, sizeof(cached.serialNumber))==0 &&
+			   slotCaps[ctr].firmwareVersion.major==cached.firmwareVersion.major &&
+			   slotCaps[ctr].firmwareVersion.minor==cached.firmwareVersion.minor)
+			{
+				if(cached.fetchedAt>now || now - cached.fetchedAt>maxAge)
+				{
+					staleEntries++;
+					ctr = slotCount;
+					break;
+				}
+				cached.slotId = slotCaps[ctr].slotId;
+				slotCaps[ctr] = cached;
+				break;
+			}
+		}
+		if(!ok || ctr==slotCount)
+		{
+			free(cached.mechanisms);
+			free(cached.hash.seeds);
+			free(cached.hash.buckets);
+		}
+	}
+	fclose(file);
+}
+
+
+
+// Writes the capabilities of all slots to the cache file.
+// The cache is written to a temporary file which then replaces it, so an interrupted run leaves the previous cache intact.
+void saveCache(const char *cacheFile)
+{
+	size_t tempLen = strlen(cacheFile) + 5;
+	char *tempFile = (char*)malloc(tempLen);
+	FILE *file = NULL;
+	uint32_t header[3] = {CACHE_MAGIC, CACHE_VERSION, (uint32_t)slotCount};
+	int ok = 0;
+
+	snprintf(tempFile, tempLen, "%s.tmp", cacheFile);
+	file = fopen(tempFile, "wb");
+	if(!file)
+	{
+		printf("Failed to write %s.\n", tempFile);
+		free(tempFile);
+		return;
+	}
+	fwrite(header, sizeof(uint32_t), 3, file);
+	for(CK_ULONG ctr=0; ctr<slotCount; ctr++)
+	{
+		SLOT_CAPABILITIES *caps = &slotCaps[ctr];
+		fwrite(caps->serialNumber, 1, sizeof(caps->serialNumber), file);
+		fwrite(&caps->firmwareVersion, sizeof(CK_VERSION), 1, file);
+		fwrite(&caps->fetchedAt, sizeof(uint64_t), 1, file);
+		fwrite(&caps->mechanismCount, sizeof(uint32_t), 1, file);
+		fwrite(&caps->hash.groupBits, sizeof(uint32_t), 1, file);
+		fwrite(&caps->hash.bucketBits, sizeof(uint32_t), 1, file);
+		fwrite(caps->mechanisms, sizeof(MECHANISM_CAPABILITY), caps->mechanismCount, file);
+		fwrite(caps->hash.seeds, sizeof(uint16_t), 1u << caps->hash.groupBits, file);
+		fwrite(caps->hash.buckets, sizeof(uint16_t), 1u << caps->hash.bucketBits, file);
+	}
+	ok = fflush(file)==0 && !ferror(file);
+	#ifdef OS_UNIX
+		ok = ok && fsync(fileno(file))==0;
+	#endif
+	ok = (fclose(file)==0) && ok;
+
+	#ifndef OS_UNIX
+		if(ok)
+			remove(cacheFile); // rename does not replace an existing file on Windows.
+	#endif
+	if(!ok || rename(tempFile, cacheFile)!=0)
+	{
+		printf("Failed to write %s.\n", cacheFile);
+		remove(tempFile);
+	}
+	free(tempFile);
+}
+
+
+
+// Loads the capabilities of all slots with a token, from the cache file when possible.
+// With refresh set, the cache is not read and every slot is queried.
+void loadCapabilities(const char *cacheFile, int refresh, uint64_t maxAge)
+{
+	CK_SLOT_ID *slots = NULL;
+	CK_TOKEN_INFO tokenInfo;
+	struct timespec start;
+	int fetched = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	checkOperation(p11Func->C_GetSlotList(CK_TRUE, NULL_PTR, &slotCount), "C_GetSlotList");
+	slots = (CK_SLOT_ID*)calloc(slotCount ? slotCount : 1, sizeof(CK_SLOT_ID));
+	checkOperation(p11Func->C_GetSlotList(CK_TRUE, slots, &slotCount), "C_GetSlotList");
+	slotCaps = (SLOT_CAPABILITIES*)calloc(slotCount ? slotCount : 1, sizeof(SLOT_CAPABILITIES));
+
+	for(CK_ULONG ctr=0; ctr<slotCount; ctr++)
+	{
+		checkOperation(p11Func->C_GetTokenInfo(slots[ctr], &tokenInfo), "C_GetTokenInfo");
+		slotCaps[ctr].slotId = slots[ctr];
+		memcpy(slotCaps[ctr].serialNumber, tokenInfo.serialNumber, sizeof(tokenInfo.serialNumber));
+		slotCaps[ctr].firmwareVersion = tokenInfo.firmwareVersion;
+	}
+	free(slots);
+
+	if(!refresh)
+		loadCache(cacheFile, maxAge);
+	for(CK_ULONG ctr=0; ctr<slotCount; ctr++)
+	{
+		if(slotCaps[ctr].mechanisms==NULL)
+		{
+			fetchCapabilities(&slotCaps[ctr]);
+			fetched++;
+		}
+	}
+	if(cacheUpdated)
+		saveCache(cacheFile);
+
+	printf("\n> Mechanisms of %lu slots loaded in %.2f ms.\n", slotCount, elapsedMs(&start));
+	printf("  --> From cache : %lu slots, queried from the HSM : %d slots", slotCount - fetched, fetched);
+	if(refresh)
+		printf(" (refresh requested)");
+	else if(staleEntries>0)
+		printf(" (%d expired cache entries)", staleEntries);
+	printf(".\n");
+	for(CK_ULONG ctr=0; ctr<slotCount; ctr++)
+		printf("  --> SLOT %lu [ %.16s, firmware %d.%d ] : %u mechanisms.\n", slotCaps[ctr].slotId, slotCaps[ctr].serialNumber,
+			slotCaps[ctr].firmwareVersion.major, slotCaps[ctr].firmwareVersion.minor, slotCaps[ctr].mechanismCount);
+}
+
+
+
+// Displays the capabilities of a mechanism in every slot.
+void showMechanism(const char *name)
+{
+	CK_MECHANISM_TYPE code = 0;
+	MECHANISM_CAPABILITY *cap = NULL;
+
+	if(!mechanismCode(name, &code))
+	{
+		printf("\n> %s : unknown mechanism name.\n", name);
+		return;
+	}
+	printf("\n> %s (0x%lX)\n", name, code);
+	for(CK_ULONG ctr=0; ctr<slotCount; ctr++)
+	{
+		cap = findCapability(&slotCaps[ctr], code);
+		if(cap==NULL)
+		{
+			printf("  --> SLOT %lu : not supported.\n", slotCaps[ctr].slotId);
+			continue;
+		}
+		printf("  --> SLOT %lu : keysize %u - %u,%s%s%s%s%s%s%s%s%s\n", slotCaps[ctr].slotId, cap->minKeySize, cap->maxKeySize,
+			(cap->flags & CKF_ENCRYPT) ? " ENCRYPT" : "", (cap->flags & CKF_DECRYPT) ? " DECRYPT" : "",
+			(cap->flags & CKF_DIGEST) ? " DIGEST" : "", (cap->flags & CKF_SIGN) ? " SIGN" : "",
+			(cap->flags & CKF_VERIFY) ? " VERIFY" : "", (cap->flags & (CKF_GENERATE|CKF_GENERATE_KEY_PAIR)) ? " GENERATE" : "",
+			(cap->flags & CKF_WRAP) ? " WRAP" : "", (cap->flags & CKF_UNWRAP) ? " UNWRAP" : "",
+			(cap->flags & CKF_DERIVE) ? " DERIVE" : "");
+	}
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char exeName[30])
+{
+	printf("\nUsage :-\n");
+	printf("%s <cache_file> [refresh] [maxage=<hours>] <mechanism> [mechanism ...]\n\n", exeName);
+	printf("  refresh   : ignores the cache and queries every slot.\n");
+	printf("  maxage    : cache entries older than this are queried again (default : %d hours).\n", DEFAULT_MAX_AGE_HOURS);
+	printf("  mechanism : name (e.g. CKM_AES_GCM) or code (e.g. 0x1087).\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int refresh = 0, firstMechanism = 2;
+	uint64_t maxAge = (uint64_t)DEFAULT_MAX_AGE_HOURS * 3600;
+
+	printf("\n%s\n", (char*)argv[0]);
+	for(; firstMechanism<argc; firstMechanism++)
+	{
+		if(strcmp((char*)argv[firstMechanism], "refresh")==0)
+			refresh = 1;
+		else if(strncmp((char*)argv[firstMechanism], "maxage=", 7)==0)
+			maxAge = strtoull((char*)argv[firstMechanism] + 7, NULL, 10) * 3600;
+		else
+			break;
+	}
+	if(firstMechanism>=argc) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+
+	loadLunaLibrary();
+	checkOperation(p11Func->C_Initialize(NULL_PTR), "C_Initialize"); // Initialize cryptoki.
+	loadCapabilities((const char*)argv[1], refresh, maxAge);
+	for(int ctr=firstMechanism; ctr<argc; ctr++)
+		showMechanism((const char*)argv[ctr]);
+	checkOperation(p11Func->C_Finalize(NULL_PTR), "C_Finalize"); // finalize cryptoki.
+	printf("\n");
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,273 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+
+
+        OBJECTIVE :
+	- This sample measures the cost of resolving mechanism names with the shared table in mechanism_names.h.
+	- The mechanisms of a slot are retrieved once using C_GetMechanismList.
+	- Each mechanism code is converted to its name, and each name back to its code, for a number of rounds, first
+	  with a binary search of the sorted tables and then with a linear scan of the name table for comparison.
+	- The average time per lookup is displayed for both directions.
+*/
+
+
+
+
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mechanism_names.h"
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SLOT_ID slotId = 0; // slot id
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+	CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+	char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+	if(libPath==NULL)
+	{
+		printf("P11_LIB environment variable not set.\n");
+		printf("\n > On Unix/Linux :-\n");
+		printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\n > On Windows :-\n");
+		printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\nExample :-");
+		printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+		printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+		exit(1);
+	}
+
+
+	#ifdef OS_UNIX
+		libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+	#else
+		libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+	#endif
+	if(!libHandle)
+	{
+		printf("Failed to load Luna library from path : %s\n", libPath);
+		exit(1);
+	}
+
+
+	#ifdef OS_UNIX
+	    C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+	#else
+		C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+	#endif
+
+	C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+	if(p11Func==NULL)
+	{
+		printf("Failed to load P11 functions.\n");
+		exit(1);
+	}
+
+	printf ("\n> P11 library loaded.\n");
+	printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Returns the milliseconds elapsed since start.
+double elapsedMs(struct timespec *start)
+{
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) * 1e3 + (end.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+
+
+// Linear scan of the name table by code, as a mechanism list array is usually searched.
+const char *scanNameOf(CK_MECHANISM_TYPE code)
+{
+	for(size_t ctr=0; ctr<MECHANISM_NAME_COUNT; ctr++)
+		if(mechanismNames[ctr].code==code)
+			return mechanismNames[ctr].name;
+	return NULL;
+}
+
+
+
+// Linear scan of the name table by name.
+int scanCodeOf(const char *name, CK_MECHANISM_TYPE *code)
+{
+	for(size_t ctr=0; ctr<MECHANISM_NAME_COUNT; ctr++)
+		if(strcmp(mechanismNames[ctr].name, name)==0)
+		{
+			*code = mechanismNames[ctr].code;
+			return 1;
+		}
+	return 0;
+}
+
+
+
+// Prints the average time of a lookup.
+void showResult(const char *label, double ms, unsigned long lookups)
+{
+	printf("  --> %-28s : %8.1f ns per lookup (%lu lookups in %.2f ms).\n", label, ms * 1e6 / lookups, lookups, ms);
+}
+
+
+
+// Resolves the mechanisms of the slot in both directions and measures each method.
+void runBenchmark(unsigned long rounds)
+{
+	CK_MECHANISM_TYPE *mechList = NULL;
+	const char **names = NULL;
+	CK_ULONG listSize = 0, known = 0;
+	CK_MECHANISM_TYPE code = 0;
+	volatile size_t sink = 0; // Keeps the lookups from being optimized away.
+	struct timespec start;
+	double ms = 0;
+
+	checkOperation(p11Func->C_GetMechanismList(slotId, NULL_PTR, &listSize), "C_GetMechanismList");
+	mechList = (CK_MECHANISM_TYPE_PTR)malloc(listSize * sizeof(CK_MECHANISM_TYPE));
+	checkOperation(p11Func->C_GetMechanismList(slotId, mechList, &listSize), "C_GetMechanismList");
+	names = (const char**)malloc(listSize * sizeof(char*));
+	for(CK_ULONG ctr=0; ctr<listSize; ctr++)
+	{
+		names[known] = mechanismNameOf(mechList[ctr]);
+		if(names[known]!=NULL)
+			known++;
+	}
+	printf("\n> Slot %lu supports %lu mechanisms, %lu of them are in the name table (%lu names, %lu codes).\n",
+		slotId, listSize, known, (unsigned long)MECHANISM_NAME_COUNT, (unsigned long)MECHANISM_CODE_COUNT);
+	if(listSize==0 || known==0)
+	{
+		free(mechList);
+		free(names);
+		return;
+	}
+
+	printf("\n> Code to name, %lu rounds.\n", rounds);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(unsigned long round=0; round<rounds; round++)
+		for(CK_ULONG ctr=0; ctr<listSize; ctr++)
+			sink += (size_t)mechanismNameOf(mechList[ctr]);
+	ms = elapsedMs(&start);
+	showResult("binary search", ms, rounds * listSize);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(unsigned long round=0; round<rounds; round++)
+		for(CK_ULONG ctr=0; ctr<listSize; ctr++)
+			sink += (size_t)scanNameOf(mechList[ctr]);
+	ms = elapsedMs(&start);
+	showResult("linear scan", ms, rounds * listSize);
+
+	printf("\n> Name to code, %lu rounds.\n", rounds);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(unsigned long round=0; round<rounds; round++)
+		for(CK_ULONG ctr=0; ctr<known; ctr++)
+			sink += mechanismCodeOf(names[ctr], &code) + code;
+	ms = elapsedMs(&start);
+	showResult("binary search", ms, rounds * known);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(unsigned long round=0; round<rounds; round++)
+		for(CK_ULONG ctr=0; ctr<known; ctr++)
+			sink += scanCodeOf(names[ctr], &code) + code;
+	ms = elapsedMs(&start);
+	showResult("linear scan", ms, rounds * known);
+
+	free(mechList);
+	free(names);
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char exeName[30])
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> [rounds]\n\n", exeName);
+	printf("  rounds : number of times every mechanism is resolved (default 10000).\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	unsigned long rounds = 10000;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<2) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	if(argc>2)
+		rounds = strtoul((const char*)argv[2], NULL, 10);
+	if(rounds==0)
+		rounds = 1;
+
+	loadLunaLibrary();
+	checkOperation(p11Func->C_Initialize(NULL_PTR), "C_Initialize"); // Initialize cryptoki.
+	runBenchmark(rounds);
+	checkOperation(p11Func->C_Finalize(NULL_PTR), "C_Finalize"); // finalize cryptoki.
+	printf("\n");
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,819 @@
+/*
+ * Mechanism names shared by the misc samples.
+ * Generated by Node-PKCS11_Samples/tools/gen_mechanism_names.js, do not edit.
+ *
+ * mechanismNames[] is sorted by name, and mechanismsByCode[] holds one index into it per code, sorted by code,
+ * so both lookups are a binary search over a constant table.
+ * Everything is static, so the header can be included by several files of the same program.
+ * Names without a code in the generator inputs are in mechanismNamesFromHeader[], resolved from cryptoki_v2.h.
+ */
+
+#ifndef MECHANISM_NAMES_H
+#define MECHANISM_NAMES_H
+
+#include <string.h>
+
+
+typedef struct
+{
+	CK_MECHANISM_TYPE code;
+	const char *name;
+} MECHANISM_NAME;
+
+
+static const MECHANISM_NAME mechanismNames[] = {
+	{0x000002a0, "CKM_ACTI"},
+	{0x000002a1, "CKM_ACTI_KEY_GEN"},
+	{0x00001082, "CKM_AES_CBC"},
+	{0x80000174, "CKM_AES_CBC_CMAC_WRAP"},
+	{0x00001105, "CKM_AES_CBC_ENCRYPT_DATA"},
+	{0x00001085, "CKM_AES_CBC_PAD"},
+	{0x8000012f, "CKM_AES_CBC_PAD_IPSEC"},
+	{0x00001088, "CKM_AES_CCM"},
+	{0x00002108, "CKM_AES_CFB1"},
+	{0x00002107, "CKM_AES_CFB128"},
+	{0x00002105, "CKM_AES_CFB64"},
+	{0x00002106, "CKM_AES_CFB8"},
+	{0x0000108a, "CKM_AES_CMAC"},
+	{0x0000108b, "CKM_AES_CMAC_GENERAL"},
+	{0x00001086, "CKM_AES_CTR"},
+	{0x00001089, "CKM_AES_CTS"},
+	{0x00001081, "CKM_AES_ECB"},
+	{0x00001104, "CKM_AES_ECB_ENCRYPT_DATA"},
+	{0x00001087, "CKM_AES_GCM"},
+	{0x0000108e, "CKM_AES_GMAC"},
+	{0x00001080, "CKM_AES_KEY_GEN"},
+	{0x00002109, "CKM_AES_KEY_WRAP"},
+	{0x0000210a, "CKM_AES_KEY_WRAP_PAD"},
+	{0x80000170, "CKM_AES_KW"},
+	{0x80000171, "CKM_AES_KWP"},
+	{0x00001083, "CKM_AES_MAC"},
+	{0x00001084, "CKM_AES_MAC_GENERAL"},
+	{0x00002104, "CKM_AES_OFB"},
+	{0x0000108c, "CKM_AES_XCBC_MAC"},
+	{0x0000108d, "CKM_AES_XCBC_MAC_96"},
+	{0x00001071, "CKM_AES_XTS"},
+	{0x00000562, "CKM_ARIA_CBC"},
+	{0x00000567, "CKM_ARIA_CBC_ENCRYPT_DATA"},
+	{0x00000565, "CKM_ARIA_CBC_PAD"},
+	{0x8000011e, "CKM_ARIA_CFB128"},
+	{0x8000011d, "CKM_ARIA_CFB8"},
+	{0x80000128, "CKM_ARIA_CMAC"},
+	{0x80000129, "CKM_ARIA_CMAC_GENERAL"},
+	{0x80000120, "CKM_ARIA_CTR"},
+	{0x00000561, "CKM_ARIA_ECB"},
+	{0x00000566, "CKM_ARIA_ECB_ENCRYPT_DATA"},
+	{0x00000560, "CKM_ARIA_KEY_GEN"},
+	{0x80000131, "CKM_ARIA_L_CBC"},
+	{0x80000132, "CKM_ARIA_L_CBC_PAD"},
+	{0x80000130, "CKM_ARIA_L_ECB"},
+	{0x80000133, "CKM_ARIA_L_MAC"},
+	{0x80000134, "CKM_ARIA_L_MAC_GENERAL"},
+	{0x00000563, "CKM_ARIA_MAC"},
+	{0x00000564, "CKM_ARIA_MAC_GENERAL"},
+	{0x8000011f, "CKM_ARIA_OFB"},
+	{0x00001033, "CKM_BATON_CBC128"},
+	{0x00001034, "CKM_BATON_COUNTER"},
+	{0x00001031, "CKM_BATON_ECB128"},
+	{0x00001032, "CKM_BATON_ECB96"},
+	{0x00001030, "CKM_BATON_KEY_GEN"},
+	{0x00001035, "CKM_BATON_SHUFFLE"},
+	{0x00001036, "CKM_BATON_WRAP"},
+	{0x80000e01, "CKM_BIP32_CHILD_DERIVE"},
+	{0x80000e00, "CKM_BIP32_MASTER_DERIVE"},
+	{0x00001091, "CKM_BLOWFISH_CBC"},
+	{0x00001094, "CKM_BLOWFISH_CBC_PAD"},
+	{0x00001090, "CKM_BLOWFISH_KEY_GEN"},
+	{0x00000552, "CKM_CAMELLIA_CBC"},
+	{0x00000557, "CKM_CAMELLIA_CBC_ENCRYPT_DATA"},
+	{0x00000555, "CKM_CAMELLIA_CBC_PAD"},
+	{0x00000558, "CKM_CAMELLIA_CTR"},
+	{0x00000551, "CKM_CAMELLIA_ECB"},
+	{0x00000556, "CKM_CAMELLIA_ECB_ENCRYPT_DATA"},
+	{0x00000550, "CKM_CAMELLIA_KEY_GEN"},
+	{0x00000553, "CKM_CAMELLIA_MAC"},
+	{0x00000554, "CKM_CAMELLIA_MAC_GENERAL"},
+	{0x00000322, "CKM_CAST128_CBC"},
+	{0x00000325, "CKM_CAST128_CBC_PAD"},
+	{0x00000321, "CKM_CAST128_ECB"},
+	{0x00000320, "CKM_CAST128_KEY_GEN"},
+	{0x00000323, "CKM_CAST128_MAC"},
+	{0x00000324, "CKM_CAST128_MAC_GENERAL"},
+	{0x00000312, "CKM_CAST3_CBC"},
+	{0x00000315, "CKM_CAST3_CBC_PAD"},
+	{0x00000311, "CKM_CAST3_ECB"},
+	{0x00000310, "CKM_CAST3_KEY_GEN"},
+	{0x00000313, "CKM_CAST3_MAC"},
+	{0x00000314, "CKM_CAST3_MAC_GENERAL"},
+	{0x00000322, "CKM_CAST5_CBC"},
+	{0x00000325, "CKM_CAST5_CBC_PAD"},
+	{0x00000321, "CKM_CAST5_ECB"},
+	{0x00000320, "CKM_CAST5_KEY_GEN"},
+	{0x00000323, "CKM_CAST5_MAC"},
+	{0x00000324, "CKM_CAST5_MAC_GENERAL"},
+	{0x00000302, "CKM_CAST_CBC"},
+	{0x00000305, "CKM_CAST_CBC_PAD"},
+	{0x00000301, "CKM_CAST_ECB"},
+	{0x00000300, "CKM_CAST_KEY_GEN"},
+	{0x00000303, "CKM_CAST_MAC"},
+	{0x00000304, "CKM_CAST_MAC_GENERAL"},
+	{0x00000142, "CKM_CDMF_CBC"},
+	{0x00000145, "CKM_CDMF_CBC_PAD"},
+	{0x00000141, "CKM_CDMF_ECB"},
+	{0x00000140, "CKM_CDMF_KEY_GEN"},
+	{0x00000143, "CKM_CDMF_MAC"},
+	{0x00000144, "CKM_CDMF_MAC_GENERAL"},
+	{0x00000500, "CKM_CMS_SIG"},
+	{0x80000e27, "CKM_COMP128"},
+	{0x00000362, "CKM_CONCATENATE_BASE_AND_DATA"},
+	{0x00000360, "CKM_CONCATENATE_BASE_AND_KEY"},
+	{0x00000363, "CKM_CONCATENATE_DATA_AND_BASE"},
+	{0x80000614, "CKM_DES2_DUKPT_DATA"},
+	{0x80000615, "CKM_DES2_DUKPT_DATA_RESP"},
+	{0x80000610, "CKM_DES2_DUKPT_IPEK"},
+	{0x80000612, "CKM_DES2_DUKPT_MAC"},
+	{0x80000613, "CKM_DES2_DUKPT_MAC_RESP"},
+	{0x80000611, "CKM_DES2_DUKPT_PIN"},
+	{0x00000130, "CKM_DES2_KEY_GEN"},
+	{0x00000133, "CKM_DES3_CBC"},
+	{0x00001103, "CKM_DES3_CBC_ENCRYPT_DATA"},
+	{0x00000136, "CKM_DES3_CBC_PAD"},
+	{0x8000012e, "CKM_DES3_CBC_PAD_IPSEC"},
+	{0x00000138, "CKM_DES3_CMAC"},
+	{0x00000137, "CKM_DES3_CMAC_GENERAL"},
+	{0x80000116, "CKM_DES3_CTR"},
+	{0x00000132, "CKM_DES3_ECB"},
+	{0x00001102, "CKM_DES3_ECB_ENCRYPT_DATA"},
+	{0x00000131, "CKM_DES3_KEY_GEN"},
+	{0x00000134, "CKM_DES3_MAC"},
+	{0x00000135, "CKM_DES3_MAC_GENERAL"},
+	{0x80000150, "CKM_DES3_X919_MAC"},
+	{0x00000122, "CKM_DES_CBC"},
+	{0x00001101, "CKM_DES_CBC_ENCRYPT_DATA"},
+	{0x00000125, "CKM_DES_CBC_PAD"},
+	{0x00000152, "CKM_DES_CFB64"},
+	{0x00000153, "CKM_DES_CFB8"},
+	{0x00000121, "CKM_DES_ECB"},
+	{0x00001100, "CKM_DES_ECB_ENCRYPT_DATA"},
+	{0x00000120, "CKM_DES_KEY_GEN"},
+	{0x00000123, "CKM_DES_MAC"},
+	{0x00000124, "CKM_DES_MAC_GENERAL"},
+	{0x00000150, "CKM_DES_OFB64"},
+	{0x00000151, "CKM_DES_OFB8"},
+	{0x00000021, "CKM_DH_PKCS_DERIVE"},
+	{0x00000020, "CKM_DH_PKCS_KEY_PAIR_GEN"},
+	{0x00002001, "CKM_DH_PKCS_PARAMETER_GEN"},
+	{0x00000011, "CKM_DSA"},
+	{0x00000010, "CKM_DSA_KEY_PAIR_GEN"},
+	{0x00002000, "CKM_DSA_PARAMETER_GEN"},
+	{0x00002003, "CKM_DSA_PROBABLISTIC_PARAMETER_GEN"},
+	{0x00000012, "CKM_DSA_SHA1"},
+	{0x00000013, "CKM_DSA_SHA224"},
+	{0x00000014, "CKM_DSA_SHA256"},
+	{0x00000015, "CKM_DSA_SHA384"},
+	{0x00000018, "CKM_DSA_SHA3_224"},
+	{0x00000019, "CKM_DSA_SHA3_256"},
+	{0x0000001a, "CKM_DSA_SHA3_384"},
+	{0x0000001b, "CKM_DSA_SHA3_512"},
+	{0x00000016, "CKM_DSA_SHA512"},
+	{0x00002004, "CKM_DSA_SHAWE_TAYLOR_PARAMETER_GEN"},
+	{0x00001051, "CKM_ECDH1_COFACTOR_DERIVE"},
+	{0x00001050, "CKM_ECDH1_DERIVE"},
+	{0x00001053, "CKM_ECDH_AES_KEY_WRAP"},
+	{0x00001041, "CKM_ECDSA"},
+	{0x80000161, "CKM_ECDSA_GBCS_SHA256"},
+	{0x00001040, "CKM_ECDSA_KEY_PAIR_GEN"},
+	{0x00001042, "CKM_ECDSA_SHA1"},
+	{0x00001043, "CKM_ECDSA_SHA224"},
+	{0x00001044, "CKM_ECDSA_SHA256"},
+	{0x00001045, "CKM_ECDSA_SHA384"},
+	{0x00001047, "CKM_ECDSA_SHA3_224"},
+	{0x00001048, "CKM_ECDSA_SHA3_256"},
+	{0x00001049, "CKM_ECDSA_SHA3_384"},
+	{0x0000104a, "CKM_ECDSA_SHA3_512"},
+	{0x00001046, "CKM_ECDSA_SHA512"},
+	{0x80000a00, "CKM_ECIES"},
+	{0x00001052, "CKM_ECMQV_DERIVE"},
+	{0x00001055, "CKM_EC_EDWARDS_KEY_PAIR_GEN"},
+	{0x00001040, "CKM_EC_KEY_PAIR_GEN"},
+	{0x80000160, "CKM_EC_KEY_PAIR_GEN_W_EXTRA_BITS"},
+	{0x00001056, "CKM_EC_MONTGOMERY_KEY_PAIR_GEN"},
+	{0x00001057, "CKM_EDDSA"},
+	{0x80000c02, "CKM_EDDSA_NACL"},
+	{0x80000175, "CKM_EXTMU_ML_DSA"},
+	{0x00000365, "CKM_EXTRACT_KEY_FROM_KEY"},
+	{0x00001070, "CKM_FASTHASH"},
+	{0x00001020, "CKM_FORTEZZA_TIMESTAMP"},
+	{0x00000350, "CKM_GENERIC_SECRET_KEY_GEN"},
+	{0x00001222, "CKM_GOST28147"},
+	{0x00001221, "CKM_GOST28147_ECB"},
+	{0x00001220, "CKM_GOST28147_KEY_GEN"},
+	{0x00001224, "CKM_GOST28147_KEY_WRAP"},
+	{0x00001223, "CKM_GOST28147_MAC"},
+	{0x00001201, "CKM_GOSTR3410"},
+	{0x00001204, "CKM_GOSTR3410_DERIVE"},
+	{0x00001200, "CKM_GOSTR3410_KEY_PAIR_GEN"},
+	{0x00001203, "CKM_GOSTR3410_KEY_WRAP"},
+	{0x00001202, "CKM_GOSTR3410_WITH_GOSTR3411"},
+	{0x00001210, "CKM_GOSTR3411"},
+	{0x00001211, "CKM_GOSTR3411_HMAC"},
+	{0x0000001f, "CKM_HASH_ML_DSA"},
+	{0x00000023, "CKM_HASH_ML_DSA_SHA224"},
+	{0x00000024, "CKM_HASH_ML_DSA_SHA256"},
+	{0x00000025, "CKM_HASH_ML_DSA_SHA384"},
+	{0x00000027, "CKM_HASH_ML_DSA_SHA3_224"},
+	{0x00000028, "CKM_HASH_ML_DSA_SHA3_256"},
+	{0x00000029, "CKM_HASH_ML_DSA_SHA3_384"},
+	{0x0000002a, "CKM_HASH_ML_DSA_SHA3_512"},
+	{0x00000026, "CKM_HASH_ML_DSA_SHA512"},
+	{0x0000002b, "CKM_HASH_ML_DSA_SHAKE128"},
+	{0x0000002c, "CKM_HASH_ML_DSA_SHAKE256"},
+	{0x00000291, "CKM_HOTP"},
+	{0x00000290, "CKM_HOTP_KEY_GEN"},
+	{0x00004033, "CKM_HSS"},
+	{0x00004032, "CKM_HSS_KEY_PAIR_GEN"},
+	{0x00000342, "CKM_IDEA_CBC"},
+	{0x00000345, "CKM_IDEA_CBC_PAD"},
+	{0x00000341, "CKM_IDEA_ECB"},
+	{0x00000340, "CKM_IDEA_KEY_GEN"},
+	{0x00000343, "CKM_IDEA_MAC"},
+	{0x00000344, "CKM_IDEA_MAC_GENERAL"},
+	{0x00001062, "CKM_JUNIPER_CBC128"},
+	{0x00001063, "CKM_JUNIPER_COUNTER"},
+	{0x00001061, "CKM_JUNIPER_ECB128"},
+	{0x00001060, "CKM_JUNIPER_KEY_GEN"},
+	{0x00001064, "CKM_JUNIPER_SHUFFLE"},
+	{0x00001065, "CKM_JUNIPER_WRAP"},
+	{0x00001011, "CKM_KEA_KEY_DERIVE"},
+	{0x00001010, "CKM_KEA_KEY_PAIR_GEN"},
+	{0x80000f08, "CKM_KECCAK_224"},
+	{0x80000f09, "CKM_KECCAK_256"},
+	{0x80000f0a, "CKM_KECCAK_384"},
+	{0x80000f0b, "CKM_KECCAK_512"},
+	{0x80000e10, "CKM_KEY_TRANSLATE"},
+	{0x00000400, "CKM_KEY_WRAP_LYNKS"},
+	{0x00000401, "CKM_KEY_WRAP_SET_OAEP"},
+	{0x00000510, "CKM_KIP_DERIVE"},
+	{0x00000512, "CKM_KIP_MAC"},
+	{0x00000511, "CKM_KIP_WRAP"},
+	{0x00000200, "CKM_MD2"},
+	{0x00000201, "CKM_MD2_HMAC"},
+	{0x00000202, "CKM_MD2_HMAC_GENERAL"},
+	{0x00000391, "CKM_MD2_KEY_DERIVATION"},
+	{0x00000004, "CKM_MD2_RSA_PKCS"},
+	{0x00000210, "CKM_MD5"},
+	{0x00000211, "CKM_MD5_HMAC"},
+	{0x00000212, "CKM_MD5_HMAC_GENERAL"},
+	{0x00000390, "CKM_MD5_KEY_DERIVATION"},
+	{0x00000005, "CKM_MD5_RSA_PKCS"},
+	{0x80000e21, "CKM_MILENAGE"},
+	{0x80000e23, "CKM_MILENAGE_AUTS"},
+	{0x80000e22, "CKM_MILENAGE_RESYNC"},
+	{0x0000001d, "CKM_ML_DSA"},
+	{0x0000001c, "CKM_ML_DSA_KEY_PAIR_GEN"},
+	{0x00000017, "CKM_ML_KEM"},
+	{0x0000000f, "CKM_ML_KEM_KEY_PAIR_GEN"},
+	{0x80000a02, "CKM_NIST_PRF_KDF"},
+	{0x000003c0, "CKM_PBA_SHA1_WITH_SHA1_HMAC"},
+	{0x000003a0, "CKM_PBE_MD2_DES_CBC"},
+	{0x000003a4, "CKM_PBE_MD5_CAST128_CBC"},
+	{0x000003a3, "CKM_PBE_MD5_CAST3_CBC"},
+	{0x000003a4, "CKM_PBE_MD5_CAST5_CBC"},
+	{0x000003a2, "CKM_PBE_MD5_CAST_CBC"},
+	{0x000003a1, "CKM_PBE_MD5_DES_CBC"},
+	{0x000003a5, "CKM_PBE_SHA1_CAST128_CBC"},
+	{0x000003a5, "CKM_PBE_SHA1_CAST5_CBC"},
+	{0x000003a9, "CKM_PBE_SHA1_DES2_EDE_CBC"},
+	{0x0000801f, "CKM_PBE_SHA1_DES2_EDE_CBC_OLD"},
+	{0x000003a8, "CKM_PBE_SHA1_DES3_EDE_CBC"},
+	{0x0000801e, "CKM_PBE_SHA1_DES3_EDE_CBC_OLD"},
+	{0x000003aa, "CKM_PBE_SHA1_RC2_128_CBC"},
+	{0x000003ab, "CKM_PBE_SHA1_RC2_40_CBC"},
+	{0x000003a6, "CKM_PBE_SHA1_RC4_128"},
+	{0x000003a7, "CKM_PBE_SHA1_RC4_40"},
+	{0x000003b0, "CKM_PKCS5_PBKD2"},
+	{0x80000a03, "CKM_PRF_KDF"},
+	{0x00000102, "CKM_RC2_CBC"},
+	{0x00000105, "CKM_RC2_CBC_PAD"},
+	{0x00000101, "CKM_RC2_ECB"},
+	{0x00000100, "CKM_RC2_KEY_GEN"},
+	{0x00000103, "CKM_RC2_MAC"},
+	{0x00000104, "CKM_RC2_MAC_GENERAL"},
+	{0x00000111, "CKM_RC4"},
+	{0x00000110, "CKM_RC4_KEY_GEN"},
+	{0x00000332, "CKM_RC5_CBC"},
+	{0x00000335, "CKM_RC5_CBC_PAD"},
+	{0x00000331, "CKM_RC5_ECB"},
+	{0x00000330, "CKM_RC5_KEY_GEN"},
+	{0x00000333, "CKM_RC5_MAC"},
+	{0x00000334, "CKM_RC5_MAC_GENERAL"},
+	{0x00000230, "CKM_RIPEMD128"},
+	{0x00000231, "CKM_RIPEMD128_HMAC"},
+	{0x00000232, "CKM_RIPEMD128_HMAC_GENERAL"},
+	{0x00000007, "CKM_RIPEMD128_RSA_PKCS"},
+	{0x00000240, "CKM_RIPEMD160"},
+	{0x00000241, "CKM_RIPEMD160_HMAC"},
+	{0x00000242, "CKM_RIPEMD160_HMAC_GENERAL"},
+	{0x00000008, "CKM_RIPEMD160_RSA_PKCS"},
+	{0x00000002, "CKM_RSA_9796"},
+	{0x00001054, "CKM_RSA_AES_KEY_WRAP"},
+	{0x80000142, "CKM_RSA_FIPS_186_3_AUX_PRIME_KEY_PAIR_GEN"},
+	{0x80000143, "CKM_RSA_FIPS_186_3_PRIME_KEY_PAIR_GEN"},
+	{0x00000001, "CKM_RSA_PKCS"},
+	{0x00000000, "CKM_RSA_PKCS_KEY_PAIR_GEN"},
+	{0x00000009, "CKM_RSA_PKCS_OAEP"},
+	{0x00004002, "CKM_RSA_PKCS_OAEP_TPM_1_1"},
+	{0x0000000d, "CKM_RSA_PKCS_PSS"},
+	{0x00004001, "CKM_RSA_PKCS_TPM_1_1"},
+	{0x0000000b, "CKM_RSA_X9_31"},
+	{0x0000000a, "CKM_RSA_X9_31_KEY_PAIR_GEN"},
+	{0x8000013e, "CKM_RSA_X9_31_NON_FIPS"},
+	{0x00000003, "CKM_RSA_X_509"},
+	{0x00000282, "CKM_SECURID"},
+	{0x00000280, "CKM_SECURID_KEY_GEN"},
+	{0x00000652, "CKM_SEED_CBC"},
+	{0x00000657, "CKM_SEED_CBC_ENCRYPT_DATA"},
+	{0x00000655, "CKM_SEED_CBC_PAD"},
+	{0x00000651, "CKM_SEED_ECB"},
+	{0x00000656, "CKM_SEED_ECB_ENCRYPT_DATA"},
+	{0x00000650, "CKM_SEED_KEY_GEN"},
+	{0x00000653, "CKM_SEED_MAC"},
+	{0x00000654, "CKM_SEED_MAC_GENERAL"},
+	{0x80000c09, "CKM_SHA1_EDDSA"},
+	{0x80000c04, "CKM_SHA1_EDDSA_NACL"},
+	{0x00000392, "CKM_SHA1_KEY_DERIVATION"},
+	{0x00000006, "CKM_SHA1_RSA_PKCS"},
+	{0x0000000e, "CKM_SHA1_RSA_PKCS_PSS"},
+	{0x0000000c, "CKM_SHA1_RSA_X9_31"},
+	{0x80000139, "CKM_SHA1_RSA_X9_31_NON_FIPS"},
+	{0x80000b23, "CKM_SHA1_SM2DSA"},
+	{0x00000255, "CKM_SHA224"},
+	{0x80000c0a, "CKM_SHA224_EDDSA"},
+	{0x80000c05, "CKM_SHA224_EDDSA_NACL"},
+	{0x00000256, "CKM_SHA224_HMAC"},
+	{0x00000257, "CKM_SHA224_HMAC_GENERAL"},
+	{0x00000396, "CKM_SHA224_KEY_DERIVATION"},
+	{0x00000046, "CKM_SHA224_RSA_PKCS"},
+	{0x00000047, "CKM_SHA224_RSA_PKCS_PSS"},
+	{0x80000135, "CKM_SHA224_RSA_X9_31"},
+	{0x8000013a, "CKM_SHA224_RSA_X9_31_NON_FIPS"},
+	{0x80000b24, "CKM_SHA224_SM2DSA"},
+	{0x00000250, "CKM_SHA256"},
+	{0x80000c0b, "CKM_SHA256_EDDSA"},
+	{0x80000c06, "CKM_SHA256_EDDSA_NACL"},
+	{0x00000251, "CKM_SHA256_HMAC"},
+	{0x00000252, "CKM_SHA256_HMAC_GENERAL"},
+	{0x00000393, "CKM_SHA256_KEY_DERIVATION"},
+	{0x00000040, "CKM_SHA256_RSA_PKCS"},
+	{0x00000043, "CKM_SHA256_RSA_PKCS_PSS"},
+	{0x80000136, "CKM_SHA256_RSA_X9_31"},
+	{0x8000013b, "CKM_SHA256_RSA_X9_31_NON_FIPS"},
+	{0x80000b25, "CKM_SHA256_SM2DSA"},
+	{0x00000260, "CKM_SHA384"},
+	{0x80000c0c, "CKM_SHA384_EDDSA"},
+	{0x80000c07, "CKM_SHA384_EDDSA_NACL"},
+	{0x00000261, "CKM_SHA384_HMAC"},
+	{0x00000262, "CKM_SHA384_HMAC_GENERAL"},
+	{0x00000394, "CKM_SHA384_KEY_DERIVATION"},
+	{0x00000041, "CKM_SHA384_RSA_PKCS"},
+	{0x00000044, "CKM_SHA384_RSA_PKCS_PSS"},
+	{0x80000137, "CKM_SHA384_RSA_X9_31"},
+	{0x8000013c, "CKM_SHA384_RSA_X9_31_NON_FIPS"},
+	{0x80000b26, "CKM_SHA384_SM2DSA"},
+	{0x000002b5, "CKM_SHA3_224"},
+	{0x80000f20, "CKM_SHA3_224_EDDSA"},
+	{0x000002b6, "CKM_SHA3_224_HMAC"},
+	{0x000002b7, "CKM_SHA3_224_HMAC_GENERAL"},
+	{0x00000398, "CKM_SHA3_224_KEY_DERIVE"},
+	{0x00000066, "CKM_SHA3_224_RSA_PKCS"},
+	{0x00000067, "CKM_SHA3_224_RSA_PKCS_PSS"},
+	{0x000002b0, "CKM_SHA3_256"},
+	{0x80000f21, "CKM_SHA3_256_EDDSA"},
+	{0x000002b1, "CKM_SHA3_256_HMAC"},
+	{0x000002b2, "CKM_SHA3_256_HMAC_GENERAL"},
+	{0x00000397, "CKM_SHA3_256_KEY_DERIVE"},
+	{0x00000060, "CKM_SHA3_256_RSA_PKCS"},
+	{0x00000063, "CKM_SHA3_256_RSA_PKCS_PSS"},
+	{0x000002c0, "CKM_SHA3_384"},
+	{0x80000f22, "CKM_SHA3_384_EDDSA"},
+	{0x000002c1, "CKM_SHA3_384_HMAC"},
+	{0x000002c2, "CKM_SHA3_384_HMAC_GENERAL"},
+	{0x00000399, "CKM_SHA3_384_KEY_DERIVE"},
+	{0x00000061, "CKM_SHA3_384_RSA_PKCS"},
+	{0x00000064, "CKM_SHA3_384_RSA_PKCS_PSS"},
+	{0x000002d0, "CKM_SHA3_512"},
+	{0x80000f23, "CKM_SHA3_512_EDDSA"},
+	{0x000002d1, "CKM_SHA3_512_HMAC"},
+	{0x000002d2, "CKM_SHA3_512_HMAC_GENERAL"},
+	{0x0000039a, "CKM_SHA3_512_KEY_DERIVE"},
+	{0x00000062, "CKM_SHA3_512_RSA_PKCS"},
+	{0x00000065, "CKM_SHA3_512_RSA_PKCS_PSS"},
+	{0x00000270, "CKM_SHA512"},
+	{0x00000048, "CKM_SHA512_224"},
+	{0x00000049, "CKM_SHA512_224_HMAC"},
+	{0x0000004a, "CKM_SHA512_224_HMAC_GENERAL"},
+	{0x0000004b, "CKM_SHA512_224_KEY_DERIVATION"},
+	{0x0000004c, "CKM_SHA512_256"},
+	{0x0000004d, "CKM_SHA512_256_HMAC"},
+	{0x0000004e, "CKM_SHA512_256_HMAC_GENERAL"},
+	{0x0000004f, "CKM_SHA512_256_KEY_DERIVATION"},
+	{0x80000c0d, "CKM_SHA512_EDDSA"},
+	{0x80000c08, "CKM_SHA512_EDDSA_NACL"},
+	{0x00000271, "CKM_SHA512_HMAC"},
+	{0x00000272, "CKM_SHA512_HMAC_GENERAL"},
+	{0x00000395, "CKM_SHA512_KEY_DERIVATION"},
+	{0x00000042, "CKM_SHA512_RSA_PKCS"},
+	{0x00000045, "CKM_SHA512_RSA_PKCS_PSS"},
+	{0x80000138, "CKM_SHA512_RSA_X9_31"},
+	{0x8000013d, "CKM_SHA512_RSA_X9_31_NON_FIPS"},
+	{0x80000b27, "CKM_SHA512_SM2DSA"},
+	{0x00000050, "CKM_SHA512_T"},
+	{0x00000051, "CKM_SHA512_T_HMAC"},
+	{0x00000052, "CKM_SHA512_T_HMAC_GENERAL"},
+	{0x00000053, "CKM_SHA512_T_KEY_DERIVATION"},
+	{0x80000f00, "CKM_SHAKE_128"},
+	{0x0000039b, "CKM_SHAKE_128_KEY_DERIVE"},
+	{0x80000f01, "CKM_SHAKE_256"},
+	{0x0000039c, "CKM_SHAKE_256_KEY_DERIVE"},
+	{0x00000220, "CKM_SHA_1"},
+	{0x00000221, "CKM_SHA_1_HMAC"},
+	{0x00000222, "CKM_SHA_1_HMAC_GENERAL"},
+	{0x00001002, "CKM_SKIPJACK_CBC64"},
+	{0x00001006, "CKM_SKIPJACK_CFB16"},
+	{0x00001005, "CKM_SKIPJACK_CFB32"},
+	{0x00001004, "CKM_SKIPJACK_CFB64"},
+	{0x00001007, "CKM_SKIPJACK_CFB8"},
+	{0x00001001, "CKM_SKIPJACK_ECB64"},
+	{0x00001000, "CKM_SKIPJACK_KEY_GEN"},
+	{0x00001003, "CKM_SKIPJACK_OFB64"},
+	{0x00001009, "CKM_SKIPJACK_PRIVATE_WRAP"},
+	{0x0000100a, "CKM_SKIPJACK_RELAYX"},
+	{0x00001008, "CKM_SKIPJACK_WRAP"},
+	{0x80000b21, "CKM_SM2DSA"},
+	{0x80000b20, "CKM_SM2_KEY_PAIR_GEN"},
+	{0x80000b01, "CKM_SM3"},
+	{0x80000b02, "CKM_SM3_HMAC"},
+	{0x80000b03, "CKM_SM3_HMAC_GENERAL"},
+	{0x80000b04, "CKM_SM3_KEY_DERIVATION"},
+	{0x80000b22, "CKM_SM3_SM2DSA"},
+	{0x80000b12, "CKM_SM4_CBC"},
+	{0x80000b13, "CKM_SM4_CBC_PAD"},
+	{0x80000b11, "CKM_SM4_ECB"},
+	{0x80000b10, "CKM_SM4_KEY_GEN"},
+	{0x00000372, "CKM_SSL3_KEY_AND_MAC_DERIVE"},
+	{0x00000371, "CKM_SSL3_MASTER_KEY_DERIVE"},
+	{0x00000373, "CKM_SSL3_MASTER_KEY_DERIVE_DH"},
+	{0x00000380, "CKM_SSL3_MD5_MAC"},
+	{0x00000370, "CKM_SSL3_PRE_MASTER_KEY_GEN"},
+	{0x00000381, "CKM_SSL3_SHA1_MAC"},
+	{0x000003d7, "CKM_TLS10_MAC_CLIENT"},
+	{0x000003d6, "CKM_TLS10_MAC_SERVER"},
+	{0x000003d9, "CKM_TLS12_KDF"},
+	{0x000003e1, "CKM_TLS12_KEY_AND_MAC_DERIVE"},
+	{0x000003e3, "CKM_TLS12_KEY_SAFE_DERIVE"},
+	{0x000003d8, "CKM_TLS12_MAC"},
+	{0x000003e0, "CKM_TLS12_MASTER_KEY_DERIVE"},
+	{0x000003e2, "CKM_TLS12_MASTER_KEY_DERIVE_DH"},
+	{0x000003e5, "CKM_TLS_KDF"},
+	{0x00000376, "CKM_TLS_KEY_AND_MAC_DERIVE"},
+	{0x000003e4, "CKM_TLS_MAC"},
+	{0x00000375, "CKM_TLS_MASTER_KEY_DERIVE"},
+	{0x00000377, "CKM_TLS_MASTER_KEY_DERIVE_DH"},
+	{0x00000374, "CKM_TLS_PRE_MASTER_KEY_GEN"},
+	{0x00000378, "CKM_TLS_PRF"},
+	{0x80000e24, "CKM_TUAK"},
+	{0x80000e26, "CKM_TUAK_AUTS"},
+	{0x80000e25, "CKM_TUAK_RESYNC"},
+	{0x00001093, "CKM_TWOFISH_CBC"},
+	{0x00001095, "CKM_TWOFISH_CBC_PAD"},
+	{0x00001092, "CKM_TWOFISH_KEY_GEN"},
+	{0x000003d5, "CKM_WTLS_CLIENT_KEY_AND_MAC_DERIVE"},
+	{0x000003d1, "CKM_WTLS_MASTER_KEY_DERIVE"},
+	{0x000003d2, "CKM_WTLS_MASTER_KEY_DERIVE_DH_ECC"},
+	{0x000003d0, "CKM_WTLS_PRE_MASTER_KEY_GEN"},
+	{0x000003d3, "CKM_WTLS_PRF"},
+	{0x000003d4, "CKM_WTLS_SERVER_KEY_AND_MAC_DERIVE"},
+	{0x00000031, "CKM_X9_42_DH_DERIVE"},
+	{0x00000032, "CKM_X9_42_DH_HYBRID_DERIVE"},
+	{0x00000030, "CKM_X9_42_DH_KEY_PAIR_GEN"},
+	{0x00002002, "CKM_X9_42_DH_PARAMETER_GEN"},
+	{0x00000033, "CKM_X9_42_MQV_DERIVE"},
+	{0x00000364, "CKM_XOR_BASE_AND_DATA"}
+};
+
+static const unsigned short mechanismsByCode[] = {
+	298, 297, 293, 306, 238, 243, 320, 288, 292, 299, 304, 303,
+	322, 301, 321, 250, 142, 141, 145, 146, 147, 148, 153, 249,
+	149, 150, 151, 152, 248, 247, 195, 139, 138, 196, 197, 198,
+	203, 199, 200, 201, 202, 204, 205, 473, 471, 472, 475, 342,
+	353, 400, 343, 354, 401, 331, 332, 387, 388, 389, 390, 391,
+	392, 393, 394, 405, 406, 407, 408, 370, 377, 384, 371, 378,
+	385, 363, 364, 274, 273, 271, 275, 276, 272, 278, 277, 133,
+	131, 126, 134, 135, 128, 112, 122, 120, 113, 123, 124, 115,
+	118, 117, 98, 97, 95, 99, 100, 96, 136, 137, 129, 130,
+	234, 235, 236, 239, 240, 241, 413, 414, 415, 285, 286, 287,
+	289, 290, 291, 336, 339, 340, 325, 328, 329, 347, 350, 351,
+	386, 397, 398, 308, 307, 207, 206, 0, 1, 365, 367, 368,
+	358, 360, 361, 372, 374, 375, 379, 381, 382, 92, 91, 89,
+	93, 94, 90, 80, 79, 77, 81, 82, 78, 86, 85, 83,
+	87, 88, 84, 282, 281, 279, 283, 284, 280, 213, 212, 210,
+	214, 215, 211, 182, 104, 103, 105, 476, 179, 442, 439, 438,
+	440, 457, 455, 453, 456, 458, 441, 443, 242, 237, 319, 341,
+	352, 399, 330, 369, 362, 376, 383, 410, 412, 253, 258, 257,
+	255, 256, 260, 267, 268, 263, 261, 265, 266, 269, 252, 468,
+	466, 467, 469, 470, 465, 445, 444, 449, 446, 450, 447, 451,
+	448, 454, 452, 229, 230, 101, 231, 233, 232, 68, 66, 62,
+	69, 70, 64, 67, 63, 65, 41, 39, 31, 47, 48, 33,
+	40, 32, 314, 312, 309, 315, 316, 311, 313, 310, 422, 421,
+	416, 423, 419, 418, 417, 420, 426, 424, 425, 223, 222, 181,
+	54, 52, 53, 50, 51, 55, 56, 160, 158, 161, 162, 163,
+	164, 169, 165, 166, 167, 168, 156, 155, 171, 157, 294, 172,
+	175, 176, 219, 218, 216, 217, 220, 221, 180, 30, 20, 16,
+	2, 25, 26, 5, 14, 18, 7, 15, 12, 13, 28, 29,
+	19, 61, 59, 464, 462, 60, 463, 132, 127, 121, 114, 17,
+	4, 190, 188, 192, 191, 189, 193, 194, 185, 184, 183, 187,
+	186, 143, 140, 474, 144, 154, 27, 10, 11, 9, 8, 21,
+	22, 302, 300, 209, 208, 264, 262, 119, 35, 34, 49, 38,
+	36, 37, 116, 6, 44, 42, 43, 45, 46, 333, 344, 355,
+	402, 323, 334, 345, 356, 403, 305, 295, 296, 125, 174, 159,
+	23, 24, 3, 178, 108, 111, 109, 110, 106, 107, 170, 251,
+	270, 429, 430, 431, 432, 437, 436, 434, 435, 428, 427, 433,
+	324, 335, 346, 357, 404, 177, 318, 327, 338, 349, 396, 317,
+	326, 337, 348, 395, 58, 57, 228, 244, 246, 245, 459, 461,
+	460, 102, 409, 411, 224, 225, 226, 227, 359, 366, 373, 380
+};
+
+#define MECHANISM_NAME_COUNT (sizeof(mechanismNames)/sizeof(*mechanismNames))
+#define MECHANISM_CODE_COUNT (sizeof(mechanismsByCode)/sizeof(*mechanismsByCode))
+
+
+// Luna mechanisms with no code in the generator inputs. Their codes come from cryptoki_v2.h at compile time,
+// so they are searched linearly after the tables above. The list ends with a NULL name.
+static const MECHANISM_NAME mechanismNamesFromHeader[] = {
+#ifdef CKM_2DES_KEY_DERIVATION
+	{CKM_2DES_KEY_DERIVATION, "CKM_2DES_KEY_DERIVATION"},
+#endif
+#ifdef CKM_AES_CBC_PAD_EXTRACT
+	{CKM_AES_CBC_PAD_EXTRACT, "CKM_AES_CBC_PAD_EXTRACT"},
+#endif
+#ifdef CKM_AES_CBC_PAD_EXTRACT_DOMAIN_CTRL
+	{CKM_AES_CBC_PAD_EXTRACT_DOMAIN_CTRL, "CKM_AES_CBC_PAD_EXTRACT_DOMAIN_CTRL"},
+#endif
+#ifdef CKM_AES_CBC_PAD_EXTRACT_FLATTENED
+	{CKM_AES_CBC_PAD_EXTRACT_FLATTENED, "CKM_AES_CBC_PAD_EXTRACT_FLATTENED"},
+#endif
+#ifdef CKM_AES_CBC_PAD_INSERT
+	{CKM_AES_CBC_PAD_INSERT, "CKM_AES_CBC_PAD_INSERT"},
+#endif
+#ifdef CKM_AES_CBC_PAD_INSERT_DOMAIN_CTRL
+	{CKM_AES_CBC_PAD_INSERT_DOMAIN_CTRL, "CKM_AES_CBC_PAD_INSERT_DOMAIN_CTRL"},
+#endif
+#ifdef CKM_AES_CBC_PAD_INSERT_FLATTENED
+	{CKM_AES_CBC_PAD_INSERT_FLATTENED, "CKM_AES_CBC_PAD_INSERT_FLATTENED"},
+#endif
+#ifdef CKM_AES_GCM_2_20a5d1
+	{CKM_AES_GCM_2_20a5d1, "CKM_AES_GCM_2_20a5d1"},
+#endif
+#ifdef CKM_ARIA_GCM
+	{CKM_ARIA_GCM, "CKM_ARIA_GCM"},
+#endif
+#ifdef CKM_CAST3_CBC_OLD_XXX
+	{CKM_CAST3_CBC_OLD_XXX, "CKM_CAST3_CBC_OLD_XXX"},
+#endif
+#ifdef CKM_CAST3_ECB_OLD_XXX
+	{CKM_CAST3_ECB_OLD_XXX, "CKM_CAST3_ECB_OLD_XXX"},
+#endif
+#ifdef CKM_CAST3_KEY_GEN_OLD_XXX
+	{CKM_CAST3_KEY_GEN_OLD_XXX, "CKM_CAST3_KEY_GEN_OLD_XXX"},
+#endif
+#ifdef CKM_CAST3_MAC_OLD_XXX
+	{CKM_CAST3_MAC_OLD_XXX, "CKM_CAST3_MAC_OLD_XXX"},
+#endif
+#ifdef CKM_CAST5_CBC_OLD_XXX
+	{CKM_CAST5_CBC_OLD_XXX, "CKM_CAST5_CBC_OLD_XXX"},
+#endif
+#ifdef CKM_CAST5_ECB_OLD_XXX
+	{CKM_CAST5_ECB_OLD_XXX, "CKM_CAST5_ECB_OLD_XXX"},
+#endif
+#ifdef CKM_CAST5_KEY_GEN_OLD_XXX
+	{CKM_CAST5_KEY_GEN_OLD_XXX, "CKM_CAST5_KEY_GEN_OLD_XXX"},
+#endif
+#ifdef CKM_CAST5_MAC_OLD_XXX
+	{CKM_CAST5_MAC_OLD_XXX, "CKM_CAST5_MAC_OLD_XXX"},
+#endif
+#ifdef CKM_CAST_CBC_OLD_XXX
+	{CKM_CAST_CBC_OLD_XXX, "CKM_CAST_CBC_OLD_XXX"},
+#endif
+#ifdef CKM_CAST_ECB_OLD_XXX
+	{CKM_CAST_ECB_OLD_XXX, "CKM_CAST_ECB_OLD_XXX"},
+#endif
+#ifdef CKM_CAST_KEY_GEN_OLD_XXX
+	{CKM_CAST_KEY_GEN_OLD_XXX, "CKM_CAST_KEY_GEN_OLD_XXX"},
+#endif
+#ifdef CKM_CAST_MAC_OLD_XXX
+	{CKM_CAST_MAC_OLD_XXX, "CKM_CAST_MAC_OLD_XXX"},
+#endif
+#ifdef CKM_CONCATENATE_BASE_AND_DATA_OLD_XXX
+	{CKM_CONCATENATE_BASE_AND_DATA_OLD_XXX, "CKM_CONCATENATE_BASE_AND_DATA_OLD_XXX"},
+#endif
+#ifdef CKM_CONCATENATE_BASE_AND_KEY_OLD_XXX
+	{CKM_CONCATENATE_BASE_AND_KEY_OLD_XXX, "CKM_CONCATENATE_BASE_AND_KEY_OLD_XXX"},
+#endif
+#ifdef CKM_CONCATENATE_DATA_AND_BASE_OLD_XXX
+	{CKM_CONCATENATE_DATA_AND_BASE_OLD_XXX, "CKM_CONCATENATE_DATA_AND_BASE_OLD_XXX"},
+#endif
+#ifdef CKM_CONCATENATE_KEY_AND_BASE_OLD_XXX
+	{CKM_CONCATENATE_KEY_AND_BASE_OLD_XXX, "CKM_CONCATENATE_KEY_AND_BASE_OLD_XXX"},
+#endif
+#ifdef CKM_DES3_CBC_PAD_IPSEC_OLD
+	{CKM_DES3_CBC_PAD_IPSEC_OLD, "CKM_DES3_CBC_PAD_IPSEC_OLD"},
+#endif
+#ifdef CKM_ECDSA_KEY_PAIR_GEN_W_EXTRA_BITS
+	{CKM_ECDSA_KEY_PAIR_GEN_W_EXTRA_BITS, "CKM_ECDSA_KEY_PAIR_GEN_W_EXTRA_BITS"},
+#endif
+#ifdef CKM_EXTRACT_KEY_FROM_KEY_OLD_XXX
+	{CKM_EXTRACT_KEY_FROM_KEY_OLD_XXX, "CKM_EXTRACT_KEY_FROM_KEY_OLD_XXX"},
+#endif
+#ifdef CKM_GENERIC_SECRET_KEY_GEN_OLD_XXX
+	{CKM_GENERIC_SECRET_KEY_GEN_OLD_XXX, "CKM_GENERIC_SECRET_KEY_GEN_OLD_XXX"},
+#endif
+#ifdef CKM_HAS160
+	{CKM_HAS160, "CKM_HAS160"},
+#endif
+#ifdef CKM_INDIRECT_LOGIN_REENCRYPT
+	{CKM_INDIRECT_LOGIN_REENCRYPT, "CKM_INDIRECT_LOGIN_REENCRYPT"},
+#endif
+#ifdef CKM_KCDSA_HAS160
+	{CKM_KCDSA_HAS160, "CKM_KCDSA_HAS160"},
+#endif
+#ifdef CKM_KCDSA_HAS160_NO_PAD
+	{CKM_KCDSA_HAS160_NO_PAD, "CKM_KCDSA_HAS160_NO_PAD"},
+#endif
+#ifdef CKM_KCDSA_KEY_PAIR_GEN
+	{CKM_KCDSA_KEY_PAIR_GEN, "CKM_KCDSA_KEY_PAIR_GEN"},
+#endif
+#ifdef CKM_KCDSA_PARAMETER_GEN
+	{CKM_KCDSA_PARAMETER_GEN, "CKM_KCDSA_PARAMETER_GEN"},
+#endif
+#ifdef CKM_KCDSA_SHA1
+	{CKM_KCDSA_SHA1, "CKM_KCDSA_SHA1"},
+#endif
+#ifdef CKM_KCDSA_SHA1_NO_PAD
+	{CKM_KCDSA_SHA1_NO_PAD, "CKM_KCDSA_SHA1_NO_PAD"},
+#endif
+#ifdef CKM_KCDSA_SHA224
+	{CKM_KCDSA_SHA224, "CKM_KCDSA_SHA224"},
+#endif
+#ifdef CKM_KCDSA_SHA224_NO_PAD
+	{CKM_KCDSA_SHA224_NO_PAD, "CKM_KCDSA_SHA224_NO_PAD"},
+#endif
+#ifdef CKM_KCDSA_SHA256
+	{CKM_KCDSA_SHA256, "CKM_KCDSA_SHA256"},
+#endif
+#ifdef CKM_KCDSA_SHA256_NO_PAD
+	{CKM_KCDSA_SHA256_NO_PAD, "CKM_KCDSA_SHA256_NO_PAD"},
+#endif
+#ifdef CKM_KCDSA_SHA384
+	{CKM_KCDSA_SHA384, "CKM_KCDSA_SHA384"},
+#endif
+#ifdef CKM_KCDSA_SHA384_NO_PAD
+	{CKM_KCDSA_SHA384_NO_PAD, "CKM_KCDSA_SHA384_NO_PAD"},
+#endif
+#ifdef CKM_KCDSA_SHA512
+	{CKM_KCDSA_SHA512, "CKM_KCDSA_SHA512"},
+#endif
+#ifdef CKM_KCDSA_SHA512_NO_PAD
+	{CKM_KCDSA_SHA512_NO_PAD, "CKM_KCDSA_SHA512_NO_PAD"},
+#endif
+#ifdef CKM_KEY_TRANSLATION
+	{CKM_KEY_TRANSLATION, "CKM_KEY_TRANSLATION"},
+#endif
+#ifdef CKM_MD2_KEY_DERIVATION_OLD_XXX
+	{CKM_MD2_KEY_DERIVATION_OLD_XXX, "CKM_MD2_KEY_DERIVATION_OLD_XXX"},
+#endif
+#ifdef CKM_MD5_KEY_DERIVATION_OLD_XXX
+	{CKM_MD5_KEY_DERIVATION_OLD_XXX, "CKM_MD5_KEY_DERIVATION_OLD_XXX"},
+#endif
+#ifdef CKM_PBE_MD2_DES_CBC_OLD_XXX
+	{CKM_PBE_MD2_DES_CBC_OLD_XXX, "CKM_PBE_MD2_DES_CBC_OLD_XXX"},
+#endif
+#ifdef CKM_PBE_MD5_CAST3_CBC_OLD_XXX
+	{CKM_PBE_MD5_CAST3_CBC_OLD_XXX, "CKM_PBE_MD5_CAST3_CBC_OLD_XXX"},
+#endif
+#ifdef CKM_PBE_MD5_CAST_CBC_OLD_XXX
+	{CKM_PBE_MD5_CAST_CBC_OLD_XXX, "CKM_PBE_MD5_CAST_CBC_OLD_XXX"},
+#endif
+#ifdef CKM_PBE_MD5_DES_CBC_OLD_XXX
+	{CKM_PBE_MD5_DES_CBC_OLD_XXX, "CKM_PBE_MD5_DES_CBC_OLD_XXX"},
+#endif
+#ifdef CKM_PBE_SHA1_CAST5_CBC_OLD_XXX
+	{CKM_PBE_SHA1_CAST5_CBC_OLD_XXX, "CKM_PBE_SHA1_CAST5_CBC_OLD_XXX"},
+#endif
+#ifdef CKM_PLACE_HOLDER_FOR_ERACOME_DEF_IN_SHIM
+	{CKM_PLACE_HOLDER_FOR_ERACOME_DEF_IN_SHIM, "CKM_PLACE_HOLDER_FOR_ERACOME_DEF_IN_SHIM"},
+#endif
+#ifdef CKM_SEED_CMAC
+	{CKM_SEED_CMAC, "CKM_SEED_CMAC"},
+#endif
+#ifdef CKM_SEED_CMAC_GENERAL
+	{CKM_SEED_CMAC_GENERAL, "CKM_SEED_CMAC_GENERAL"},
+#endif
+#ifdef CKM_SEED_CTR
+	{CKM_SEED_CTR, "CKM_SEED_CTR"},
+#endif
+#ifdef CKM_SHA1_KEY_DERIVATION_OLD_XXX
+	{CKM_SHA1_KEY_DERIVATION_OLD_XXX, "CKM_SHA1_KEY_DERIVATION_OLD_XXX"},
+#endif
+#ifdef CKM_SHA224_HMAC_GENERAL_OLD
+	{CKM_SHA224_HMAC_GENERAL_OLD, "CKM_SHA224_HMAC_GENERAL_OLD"},
+#endif
+#ifdef CKM_SHA224_HMAC_OLD
+	{CKM_SHA224_HMAC_OLD, "CKM_SHA224_HMAC_OLD"},
+#endif
+#ifdef CKM_SHA224_KEY_DERIVATION_OLD
+	{CKM_SHA224_KEY_DERIVATION_OLD, "CKM_SHA224_KEY_DERIVATION_OLD"},
+#endif
+#ifdef CKM_SHA224_OLD
+	{CKM_SHA224_OLD, "CKM_SHA224_OLD"},
+#endif
+#ifdef CKM_SHA224_RSA_PKCS_OLD
+	{CKM_SHA224_RSA_PKCS_OLD, "CKM_SHA224_RSA_PKCS_OLD"},
+#endif
+#ifdef CKM_SHA224_RSA_PKCS_PSS_OLD
+	{CKM_SHA224_RSA_PKCS_PSS_OLD, "CKM_SHA224_RSA_PKCS_PSS_OLD"},
+#endif
+#ifdef CKM_TDEA_KW
+	{CKM_TDEA_KW, "CKM_TDEA_KW"},
+#endif
+#ifdef CKM_TDEA_KWP
+	{CKM_TDEA_KWP, "CKM_TDEA_KWP"},
+#endif
+#ifdef CKM_XOR_BASE_AND_DATA_OLD_XXX
+	{CKM_XOR_BASE_AND_DATA_OLD_XXX, "CKM_XOR_BASE_AND_DATA_OLD_XXX"},
+#endif
+#ifdef CKM_XOR_BASE_AND_DATA_W_KDF
+	{CKM_XOR_BASE_AND_DATA_W_KDF, "CKM_XOR_BASE_AND_DATA_W_KDF"},
+#endif
+#ifdef CKM_XOR_BASE_AND_KEY
+	{CKM_XOR_BASE_AND_KEY, "CKM_XOR_BASE_AND_KEY"},
+#endif
+	{0, NULL}
+};
+
+
+
+// Returns the name of a mechanism code, or NULL if the code is unknown.
+static inline const char *mechanismNameOf(CK_MECHANISM_TYPE code)
+{
+	size_t low = 0, high = MECHANISM_CODE_COUNT;
+
+	while(low<high)
+	{
+		size_t mid = (low + high) / 2;
+		const MECHANISM_NAME *entry = &mechanismNames[mechanismsByCode[mid]];
+		if(entry->code==code)
+			return entry->name;
+		if(entry->code<code)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	for(const MECHANISM_NAME *entry=mechanismNamesFromHeader; entry->name!=NULL; entry++)
+		if(entry->code==code)
+			return entry->name;
+	return NULL;
+}
+
+
+
+// Finds the code of a mechanism name. Returns 0 if the name is unknown.
+static inline int mechanismCodeOf(const char *name, CK_MECHANISM_TYPE *code)
+{
+	size_t low = 0, high = MECHANISM_NAME_COUNT;
+
+	while(low<high)
+	{
+		size_t mid = (low + high) / 2;
+		int cmp = strcmp(mechanismNames[mid].name, name);
+		if(cmp==0)
+		{
+			*code = mechanismNames[mid].code;
+			return 1;
+		}
+		if(cmp<0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	for(const MECHANISM_NAME *entry=mechanismNamesFromHeader; entry->name!=NULL; entry++)
+	{
+		if(strcmp(entry->name, name)==0)
+		{
+			*code = entry->code;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+#endif
@@ -0,0 +1,630 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to apply one attribute change to many token objects with C_SetAttributeValue.
+	- Objects are selected by class with C_FindObjects, then by a regular expression on CKA_LABEL.
+	- Each selected object can be given a new label (the part of the label matched by the expression is replaced,
+	  \1 to \9 insert the matched groups), a new CKA_ID, and a new CKA_USAGE_LIMIT. All changes to an object are
+	  made with a single C_SetAttributeValue.
+	- The objects are updated in batches by a pool of threads, each with its own session, optionally at a limited
+	  rate of HSM calls per second. The throughput is reported at the end.
+	- In dry-run mode the changes are printed and nothing is modified.
+	- At least one of class= and label= must be given, or the all option to change every object of the token.
+	- Options are given as name=value arguments, e.g. :
+		class=secret "label=^app-(.*)-v1$" "rename=app-\1-v2" usage_limit=100000 dry-run
+*/
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <regex.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+#define FIND_BATCH 1024
+#define WORK_BATCH 64 // Number of handles a thread takes from the list at a time.
+#define MAX_LABEL_LEN 256
+#define MAX_ID_LEN 64
+#define MAX_GROUPS 10 // The whole match and \1 to \9.
+#define PROGRESS_INTERVAL 1000
+
+
+// Objects to update and the changes to make.
+typedef struct
+{
+	CK_OBJECT_CLASS objClass;
+	int anyClass;
+	regex_t labelRegex;
+	int hasLabelRegex;
+	const char *replacement; // New text for the matched part of the label, or NULL.
+	CK_BYTE newId[MAX_ID_LEN];
+	CK_ULONG newIdLen;
+	int setId;
+	CK_ULONG usageLimit;
+	int setUsageLimit;
+	int all; // Confirms that every object of the token may be changed.
+} UPDATE;
+
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+
+UPDATE update;
+int dryRun = 0;
+
+CK_OBJECT_HANDLE *handles = NULL; // Objects of the selected class.
+CK_ULONG handleCount = 0;
+CK_ULONG nextHandle = 0;
+unsigned long objectsSelected = 0;
+unsigned long objectsUpdated = 0;
+unsigned long objectsFailed = 0;
+pthread_mutex_t progressLock = PTHREAD_MUTEX_INITIALIZER;
+
+double callsPerSecond = 0; // 0 : no limit.
+double nextCallTime = 0;
+pthread_mutex_t rateLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+        free(slotPin);
+	free(handles);
+	if(update.hasLabelRegex)
+		regfree(&update.labelRegex);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the seconds elapsed since start.
+double secondsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+// Returns the monotonic clock in seconds.
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+
+// Waits for the next call slot. Calls of all threads are spaced 1/callsPerSecond seconds apart.
+void waitForRate()
+{
+	double wait = 0, current = 0;
+	struct timespec ts;
+
+	if(callsPerSecond<=0)
+		return;
+	pthread_mutex_lock(&rateLock);
+	current = now();
+	if(nextCallTime<current)
+		nextCallTime = current;
+	wait = nextCallTime - current;
+	nextCallTime += 1.0 / callsPerSecond;
+	pthread_mutex_unlock(&rateLock);
+	if(wait>0)
+	{
+		ts.tv_sec = (time_t)wait;
+		ts.tv_nsec = (long)((wait - ts.tv_sec) * 1e9);
+		nanosleep(&ts, NULL);
+	}
+}
+
+
+
+// Finds all token objects of the selected class, in batches of FIND_BATCH handles.
+void findObjects()
+{
+	CK_BBOOL yes = CK_TRUE;
+	CK_ULONG objectCount = 0;
+	CK_ULONG capacity = 0;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_TOKEN,	&yes,			sizeof(CK_BBOOL)},
+		{CKA_CLASS,	&update.objClass,	sizeof(CK_OBJECT_CLASS)}
+	};
+
+	checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, update.anyClass ? 1 : 2), "C_FindObjectsInit");
+	do
+	{
+		if(handleCount + FIND_BATCH>capacity)
+		{
+			capacity = (capacity + FIND_BATCH) * 2;
+			handles = (CK_OBJECT_HANDLE*)realloc(handles, capacity * sizeof(CK_OBJECT_HANDLE));
+		}
+		checkOperation(p11Func->C_FindObjects(hSession, handles + handleCount, FIND_BATCH, &objectCount), "C_FindObjects");
+		handleCount += objectCount;
+	} while(objectCount==FIND_BATCH);
+	checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+}
+
+
+
+// Builds the new label : the label with its matched part replaced by the replacement text, where \0 to \9 insert
+// the matched groups. Returns 0 if the new label does not fit in MAX_LABEL_LEN bytes.
+int rewriteLabel(const char *label, regmatch_t *groups, char *newLabel, CK_ULONG *newLabelLen)
+{
+	const char *rep = update.replacement;
+	size_t len = 0, part = 0, labelLen = strlen(label);
+	int group = 0;
+
+	for(const char *text=label; text<label + groups[0].rm_so; text++) // Text before the match.
+		newLabel[len++] = *text;
+	while(*rep!='\0')
+	{
+		if(rep[0]=='\\' && rep[1]>='0' && rep[1]<='9')
+		{
+			group = rep[1] - '0';
+			rep += 2;
+			if(group>=MAX_GROUPS || groups[group].rm_so<0)
+				continue; // Group did not take part in the match.
+			part = groups[group].rm_eo - groups[group].rm_so;
+			if(len + part>MAX_LABEL_LEN)
+				return 0;
+			memcpy(newLabel + len, label + groups[group].rm_so, part);
+			len += part;
+			continue;
+		}
+		if(rep[0]=='\\' && rep[1]!='\0')
+			rep++;
+		if(len + 1>MAX_LABEL_LEN)
+			return 0;
+		newLabel[len++] = *rep++;
+	}
+	part = labelLen - groups[0].rm_eo; // Text after the match.
+	if(len + part>MAX_LABEL_LEN)
+		return 0;
+	memcpy(newLabel + len, label + groups[0].rm_eo, part);
+	*newLabelLen = len + part;
+	return 1;
+}
+
+
+
+// Prints a hex string.
+void printHex(const CK_BYTE *data, CK_ULONG len)
+{
+	for(CK_ULONG ctr=0; ctr<len; ctr++)
+		printf("%02X", data[ctr]);
+}
+
+
+
+// Reads the label of an object, checks it against the expression and applies the changes.
+// Returns 0 if the object is not selected, 1 if it was updated (or would be, in dry-run mode), -1 if the update failed.
+int updateObject(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE handle)
+{
+	char label[MAX_LABEL_LEN + 1];
+	char newLabel[MAX_LABEL_LEN];
+	CK_ULONG newLabelLen = 0;
+	CK_ULONG count = 0;
+	regmatch_t groups[MAX_GROUPS];
+	CK_RV rv = CKR_OK;
+
+	CK_ATTRIBUTE labelAttrib[] =
+	{
+		{CKA_LABEL,	label,	MAX_LABEL_LEN}
+	};
+	CK_ATTRIBUTE changes[3];
+
+	waitForRate();
+	rv = p11Func->C_GetAttributeValue(session, handle, labelAttrib, 1);
+	if(rv==CKR_BUFFER_TOO_SMALL)
+	{
+		printf("  --> Object handle %lu : label longer than %d bytes, skipped.\n", handle, MAX_LABEL_LEN);
+		return -1;
+	}
+	if(rv!=CKR_OK)
+		return 0; // Destroyed since it was found.
+	label[labelAttrib[0].ulValueLen] = '\0';
+
+	if(update.hasLabelRegex && regexec(&update.labelRegex, label, MAX_GROUPS, groups, 0)!=0)
+		return 0;
+	if(update.replacement!=NULL)
+	{
+		if(!rewriteLabel(label, groups, newLabel, &newLabelLen))
+		{
+			pthread_mutex_lock(&progressLock);
+			printf("  --> Object handle %lu : new label longer than %d bytes.\n", handle, MAX_LABEL_LEN);
+			pthread_mutex_unlock(&progressLock);
+			return -1;
+		}
+		changes[count].type = CKA_LABEL;
+		changes[count].pValue = newLabel;
+		changes[count++].ulValueLen = newLabelLen;
+	}
+	if(update.setId)
+	{
+		changes[count].type = CKA_ID;
+		changes[count].pValue = update.newId;
+		changes[count++].ulValueLen = update.newIdLen;
+	}
+	if(update.setUsageLimit)
+	{
+		changes[count].type = CKA_USAGE_LIMIT;
+		changes[count].pValue = &update.usageLimit;
+		changes[count++].ulValueLen = sizeof(CK_ULONG);
+	}
+
+	if(dryRun)
+	{
+		pthread_mutex_lock(&progressLock);
+		printf("  --> %lu : %s", handle, label);
+		if(update.replacement!=NULL)
+			printf(" -> label %.*s", (int)newLabelLen, newLabel);
+		if(update.setId)
+		{
+			printf(", id ");
+			printHex(update.newId, update.newIdLen);
+		}
+		if(update.setUsageLimit)
+			printf(", usage limit %lu", update.usageLimit);
+		printf("\n");
+		pthread_mutex_unlock(&progressLock);
+		return 1;
+	}
+
+	waitForRate();
+	rv = p11Func->C_SetAttributeValue(session, handle, changes, count);
+	if(rv!=CKR_OK)
+	{
+		pthread_mutex_lock(&progressLock);
+		printf("  --> Object handle %lu (%s) : C_SetAttributeValue failed with Ox%lX.\n", handle, label, rv);
+		pthread_mutex_unlock(&progressLock);
+		return -1;
+	}
+	return 1;
+}
+
+
+
+// Update thread; takes WORK_BATCH handles at a time until none are left.
+void *updater(void *arg)
+{
+	CK_SESSION_HANDLE session = 0;
+	CK_ULONG first = 0, last = 0;
+	int result = 0;
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &session), "C_OpenSession");
+	while(1)
+	{
+		pthread_mutex_lock(&progressLock);
+		first = nextHandle;
+		nextHandle = (nextHandle + WORK_BATCH<handleCount) ? nextHandle + WORK_BATCH : handleCount;
+		last = nextHandle;
+		pthread_mutex_unlock(&progressLock);
+		if(first>=last)
+			break;
+
+		for(CK_ULONG ctr=first; ctr<last; ctr++)
+		{
+			result = updateObject(session, handles[ctr]);
+			if(result==0)
+				continue;
+			pthread_mutex_lock(&progressLock);
+			objectsSelected++;
+			if(result>0)
+				objectsUpdated++;
+			else
+				objectsFailed++;
+			if(!dryRun && objectsSelected % PROGRESS_INTERVAL==0)
+				printf("  --> %lu objects processed.\n", objectsSelected);
+			pthread_mutex_unlock(&progressLock);
+		}
+	}
+	checkOperation(p11Func->C_CloseSession(session), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Updates the objects found using nThreads sessions.
+void runUpdate(int nThreads)
+{
+	pthread_t *threads = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	struct timespec start;
+	double seconds = 0;
+
+	printf("\n> %lu objects to check using %d threads", handleCount, nThreads);
+	if(callsPerSecond>0)
+		printf(", at most %.0f calls per second", callsPerSecond);
+	printf("%s.\n", dryRun ? " (dry run)" : "");
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&threads[ctr], NULL, &updater, NULL);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(threads[ctr], NULL);
+	seconds = secondsSince(&start);
+	free(threads);
+
+	printf("\n> %lu of %lu objects selected in %.2f seconds.\n", objectsSelected, handleCount, seconds);
+	printf("  --> %lu objects %s, %lu failed.\n", objectsUpdated, dryRun ? "would be updated" : "updated", objectsFailed);
+	if(!dryRun)
+		printf("  --> %.1f objects per second.\n", seconds>0 ? objectsUpdated / seconds : 0);
+}
+
+
+
+// Converts a hex string to bytes. Returns 0 if the string is not valid hex or too long.
+int parseHex(const char *hex, CK_BYTE *data, CK_ULONG maxLen, CK_ULONG *len)
+{
+	size_t hexLen = strlen(hex);
+	unsigned int byte = 0;
+
+	if(hexLen==0 || hexLen % 2 || hexLen / 2>maxLen || strspn(hex, "0123456789abcdefABCDEF")!=hexLen)
+		return 0;
+	for(*len=0; *len<hexLen / 2; (*len)++)
+	{
+		sscanf(hex + 2 * *len, "%2x", &byte);
+		data[*len] = (CK_BYTE)byte;
+	}
+	return 1;
+}
+
+
+
+// Parses a name=value option. Returns 0 if the option is unknown or invalid.
+int parseOption(const char *option, int *nThreads)
+{
+	const char *value = strchr(option, '=');
+	value = value ? value + 1 : "";
+
+	if(strncmp(option, "class=", 6)==0)
+	{
+		update.anyClass = 0;
+		if(strcmp(value, "secret")==0)
+			update.objClass = CKO_SECRET_KEY;
+		else if(strcmp(value, "private")==0)
+			update.objClass = CKO_PRIVATE_KEY;
+		else if(strcmp(value, "public")==0)
+			update.objClass = CKO_PUBLIC_KEY;
+		else if(strcmp(value, "data")==0)
+			update.objClass = CKO_DATA;
+		else if(strcmp(value, "certificate")==0)
+			update.objClass = CKO_CERTIFICATE;
+		else
+			return 0;
+	}
+	else if(strncmp(option, "label=", 6)==0)
+	{
+		if(update.hasLabelRegex || regcomp(&update.labelRegex, value, REG_EXTENDED)!=0)
+			return 0;
+		update.hasLabelRegex = 1;
+	}
+	else if(strncmp(option, "rename=", 7)==0)
+		update.replacement = value;
+	else if(strncmp(option, "id=", 3)==0)
+	{
+		if(!parseHex(value, update.newId, MAX_ID_LEN, &update.newIdLen))
+			return 0;
+		update.setId = 1;
+	}
+	else if(strncmp(option, "usage_limit=", 12)==0)
+	{
+		update.usageLimit = strtoul(value, NULL, 10);
+		update.setUsageLimit = 1;
+	}
+	else if(strcmp(option, "all")==0)
+		update.all = 1;
+	else if(strcmp(option, "dry-run")==0)
+		dryRun = 1;
+	else if(strncmp(option, "threads=", 8)==0)
+		*nThreads = atoi(value);
+	else if(strncmp(option, "rate=", 5)==0)
+		callsPerSecond = atof(value);
+	else
+		return 0;
+	return 1;
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <option ...>\n\n", exeName);
+	printf("Selection :-\n");
+	printf("  class=<secret|private|public|data|certificate>  : class of the objects (default : all).\n");
+	printf("  label=<regex>                                   : extended regular expression the label must match.\n");
+	printf("  all                                             : selects every object when neither class nor label is given.\n\n");
+	printf("Changes (at least one) :-\n");
+	printf("  rename=<text>                                   : replaces the matched part of the label, \\1 to \\9 insert groups.\n");
+	printf("  id=<hex>                                        : sets CKA_ID (the same value on every selected object).\n");
+	printf("  usage_limit=<n>                                 : sets CKA_USAGE_LIMIT.\n\n");
+	printf("Execution :-\n");
+	printf("  dry-run                                         : prints the changes without making them.\n");
+	printf("  threads=<n>                                     : number of threads (default : 4).\n");
+	printf("  rate=<n>                                        : maximum HSM calls per second (default : no limit).\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int nThreads = 4;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<4) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	memset(&update, 0, sizeof(update));
+	update.anyClass = 1;
+	for(int ctr=3; ctr<argc; ctr++)
+	{
+		if(!parseOption((const char*)argv[ctr], &nThreads))
+		{
+			printf("\nInvalid option : %s\n", (const char*)argv[ctr]);
+			usage((char*)argv[0]);
+			exit(1);
+		}
+	}
+	if(update.replacement==NULL && !update.setId && !update.setUsageLimit)
+	{
+		printf("\nNo change given.\n");
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	if(update.anyClass && !update.hasLabelRegex && !update.all)
+	{
+		printf("\nNo class or label given; this would change every object of the token. Add the all option to confirm.\n");
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	if(update.replacement!=NULL && !update.hasLabelRegex)
+	{
+		printf("\nrename requires a label expression.\n");
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	if(nThreads<1)
+		nThreads = 1;
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+	findObjects();
+	runUpdate(nThreads);
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,530 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to import a large number of objects into a partition.
+	- The objects are read from a text file (or stdin), one object per line :
+		data    <label> <value_hex>
+		aes     <label> <id_hex> <key_hex>
+		generic <label> <id_hex> <key_hex>
+	  '-' can be used for an empty CKA_ID. Lines starting with '#' are ignored.
+	- Data objects are created with C_CreateObject. Plain secret keys (AES and generic secret) are imported as in
+	  CreateKnownKeys.c : they are encrypted with an ephemeral AES key using CKM_AES_KWP, then unwrapped into the partition.
+	- The file is read by one thread and the objects are created by a pool of threads, each with its own session.
+	  Each thread builds its attribute templates once; only the label, CKA_ID and value change for each object.
+	- Progress and objects per second are displayed while importing, and failed lines are reported.
+*/
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+#define MAX_LABEL_LEN 256
+#define MAX_ID_LEN 128
+#define MAX_VALUE_LEN 8192
+#define LINE_LEN (2 * MAX_VALUE_LEN + 2 * MAX_ID_LEN + MAX_LABEL_LEN + 64)
+#define QUEUE_SIZE 512
+#define PROGRESS_INTERVAL 5000
+
+typedef enum { OBJECT_DATA, OBJECT_AES, OBJECT_GENERIC } OBJECT_KIND;
+
+
+// One object of the input file.
+typedef struct
+{
+	unsigned long line;
+	OBJECT_KIND kind;
+	CK_ULONG labelLen;
+	CK_ULONG idLen;
+	CK_ULONG valueLen;
+	CK_BYTE label[MAX_LABEL_LEN];
+	CK_BYTE id[MAX_ID_LEN];
+	CK_BYTE value[MAX_VALUE_LEN];
+} IMPORT_RECORD;
+
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+CK_OBJECT_HANDLE importKey = 0; // Ephemeral AES key used to import plain secret keys.
+CK_BYTE iv[4]; // CKM_AES_KWP IV.
+
+// Records read from the file, waiting for a thread.
+IMPORT_RECORD *queue = NULL;
+int queueHead = 0;
+int queueCount = 0;
+int inputDone = 0;
+pthread_mutex_t queueLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t queueNotEmpty = PTHREAD_COND_INITIALIZER;
+pthread_cond_t queueNotFull = PTHREAD_COND_INITIALIZER;
+
+unsigned long objectsCreated = 0;
+unsigned long objectsFailed = 0;
+struct timespec importStart;
+pthread_mutex_t progressLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+        free(slotPin);
+	free(queue);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the seconds elapsed since start.
+double secondsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+// Generates the ephemeral AES-256 key used to import plain secret keys, and the IV.
+void generateImportKey()
+{
+	CK_MECHANISM mech = {CKM_AES_KEY_GEN};
+	CK_BBOOL yes = CK_TRUE;
+	CK_BBOOL no = CK_FALSE;
+	CK_ULONG keyLen = 32;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_TOKEN,		&no,		sizeof(CK_BBOOL)},
+		{CKA_PRIVATE,		&yes,		sizeof(CK_BBOOL)},
+		{CKA_SENSITIVE,		&yes,		sizeof(CK_BBOOL)},
+		{CKA_EXTRACTABLE,	&no,		sizeof(CK_BBOOL)},
+		{CKA_MODIFIABLE,	&no,		sizeof(CK_BBOOL)},
+		{CKA_ENCRYPT,		&yes,		sizeof(CK_BBOOL)},
+		{CKA_DECRYPT,		&no,		sizeof(CK_BBOOL)},
+		{CKA_WRAP,		&no,		sizeof(CK_BBOOL)},
+		{CKA_UNWRAP,		&yes,		sizeof(CK_BBOOL)},
+		{CKA_VALUE_LEN,		&keyLen,	sizeof(CK_ULONG)}
+	};
+	CK_ULONG attribLen = sizeof(attrib) / sizeof(*attrib);
+	checkOperation(p11Func->C_GenerateKey(hSession, &mech, attrib, attribLen, &importKey), "C_GenerateKey");
+	checkOperation(p11Func->C_GenerateRandom(hSession, iv, sizeof(iv)), "C_GenerateRandom");
+	printf("\n> Ephemeral import key generated. Handle : %lu.\n", importKey);
+}
+
+
+
+// Converts a hexadecimal string to bytes. "-" is an empty value. Returns 0 if the string is not valid.
+int hexToBytes(const char *hex, CK_BYTE *out, CK_ULONG maxLen, CK_ULONG *len)
+{
+	size_t hexLen = strlen(hex);
+	unsigned int byte = 0;
+
+	*len = 0;
+	if(strcmp(hex, "-")==0)
+		return 1;
+	if(hexLen % 2 || hexLen / 2>maxLen)
+		return 0;
+	for(size_t ctr=0; ctr<hexLen; ctr+=2)
+	{
+		if(sscanf(hex + ctr, "%2x", &byte)!=1)
+			return 0;
+		out[(*len)++] = (CK_BYTE)byte;
+	}
+	return 1;
+}
+
+
+
+// Parses a line of the input file. Returns 0 if the line is not valid.
+int parseLine(char *line, IMPORT_RECORD *record)
+{
+	char *kind = strtok(line, " \t\r\n");
+	char *label = strtok(NULL, " \t\r\n");
+	char *first = strtok(NULL, " \t\r\n");
+	char *second = strtok(NULL, " \t\r\n");
+
+	if(kind==NULL || label==NULL || first==NULL || strlen(label)>MAX_LABEL_LEN)
+		return 0;
+	record->labelLen = strlen(label);
+	memcpy(record->label, label, record->labelLen);
+	record->idLen = 0;
+
+	if(strcmp(kind, "data")==0)
+	{
+		record->kind = OBJECT_DATA;
+		return hexToBytes(first, record->value, MAX_VALUE_LEN, &record->valueLen);
+	}
+	if(strcmp(kind, "aes")==0)
+		record->kind = OBJECT_AES;
+	else if(strcmp(kind, "generic")==0)
+		record->kind = OBJECT_GENERIC;
+	else
+		return 0;
+	if(second==NULL || !hexToBytes(first, record->id, MAX_ID_LEN, &record->idLen) ||
+	   !hexToBytes(second, record->value, MAX_VALUE_LEN, &record->valueLen) || record->valueLen==0)
+		return 0;
+	if(record->kind==OBJECT_AES && record->valueLen!=16 && record->valueLen!=24 && record->valueLen!=32)
+		return 0;
+	return 1;
+}
+
+
+
+// Counts an object as created or failed, and displays the progress.
+void countObject(int created, unsigned long line, CK_RV rv)
+{
+	double seconds = 0;
+
+	pthread_mutex_lock(&progressLock);
+	if(created)
+		objectsCreated++;
+	else
+	{
+		objectsFailed++;
+		printf("  --> Line %lu : failed with Ox%lX.\n", line, rv);
+	}
+	if((objectsCreated + objectsFailed) % PROGRESS_INTERVAL==0)
+	{
+		seconds = secondsSince(&importStart);
+		printf("  --> %lu objects imported, %.1f objects per second.\n", objectsCreated + objectsFailed,
+			seconds>0 ? (objectsCreated + objectsFailed) / seconds : 0);
+	}
+	pthread_mutex_unlock(&progressLock);
+}
+
+
+
+// Importing thread; takes records from the queue until the file is read and the queue is empty.
+void *importer(void *arg)
+{
+	CK_SESSION_HANDLE session = 0;
+	IMPORT_RECORD *record = (IMPORT_RECORD*)malloc(sizeof(IMPORT_RECORD));
+	CK_BYTE *encrypted = (CK_BYTE*)malloc(MAX_VALUE_LEN + 16);
+	CK_ULONG encryptedLen = 0;
+	CK_OBJECT_HANDLE handle = 0;
+	CK_MECHANISM mech = {CKM_AES_KWP, iv, sizeof(iv)};
+	CK_RV rv = CKR_OK;
+
+	// Templates are built once; only the label, CKA_ID, value and usage change for each object.
+	CK_BBOOL yes = CK_TRUE;
+	CK_BBOOL no = CK_FALSE;
+	CK_BBOOL canEncrypt = CK_FALSE;
+	CK_BBOOL canSign = CK_FALSE;
+	CK_OBJECT_CLASS dataClass = CKO_DATA;
+	CK_OBJECT_CLASS keyClass = CKO_SECRET_KEY;
+	CK_KEY_TYPE keyType = CKK_AES;
+	CK_ULONG valueLen = 0;
+
+	CK_ATTRIBUTE dataTemplate[] =
+	{
+		{CKA_CLASS,		&dataClass,	sizeof(CK_OBJECT_CLASS)},
+		{CKA_TOKEN,		&yes,		sizeof(CK_BBOOL)},
+		{CKA_PRIVATE,		&yes,		sizeof(CK_BBOOL)},
+		{CKA_LABEL,		record->label,	0},
+		{CKA_VALUE,		record->value,	0}
+	};
+	CK_ATTRIBUTE keyTemplate[] =
+	{
+		{CKA_CLASS,		&keyClass,	sizeof(CK_OBJECT_CLASS)},
+		{CKA_KEY_TYPE,		&keyType,	sizeof(CK_KEY_TYPE)},
+		{CKA_TOKEN,		&yes,		sizeof(CK_BBOOL)},
+		{CKA_PRIVATE,		&yes,		sizeof(CK_BBOOL)},
+		{CKA_SENSITIVE,		&yes,		sizeof(CK_BBOOL)},
+		{CKA_EXTRACTABLE,	&no,		sizeof(CK_BBOOL)},
+		{CKA_MODIFIABLE,	&no,		sizeof(CK_BBOOL)},
+		{CKA_ENCRYPT,		&canEncrypt,	sizeof(CK_BBOOL)},
+		{CKA_DECRYPT,		&canEncrypt,	sizeof(CK_BBOOL)},
+		{CKA_SIGN,		&canSign,	sizeof(CK_BBOOL)},
+		{CKA_VERIFY,		&canSign,	sizeof(CK_BBOOL)},
+		{CKA_VALUE_LEN,		&valueLen,	sizeof(CK_ULONG)},
+		{CKA_LABEL,		record->label,	0},
+		{CKA_ID,		record->id,	0}
+	};
+	CK_ULONG dataTemplateLen = sizeof(dataTemplate) / sizeof(*dataTemplate);
+	CK_ULONG keyTemplateLen = sizeof(keyTemplate) / sizeof(*keyTemplate);
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &session), "C_OpenSession");
+	while(1)
+	{
+		pthread_mutex_lock(&queueLock);
+		while(queueCount==0 && !inputDone)
+			pthread_cond_wait(&queueNotEmpty, &queueLock);
+		if(queueCount==0)
+		{
+			pthread_mutex_unlock(&queueLock);
+			break;
+		}
+		memcpy(record, &queue[queueHead], sizeof(IMPORT_RECORD));
+		queueHead = (queueHead + 1) % QUEUE_SIZE;
+		queueCount--;
+		pthread_cond_signal(&queueNotFull);
+		pthread_mutex_unlock(&queueLock);
+
+		if(record->kind==OBJECT_DATA)
+		{
+			dataTemplate[3].ulValueLen = record->labelLen;
+			dataTemplate[4].ulValueLen = record->valueLen;
+			rv = p11Func->C_CreateObject(session, dataTemplate, dataTemplateLen, &handle);
+		}
+		else
+		{
+			keyType = (record->kind==OBJECT_AES) ? CKK_AES : CKK_GENERIC_SECRET;
+			canEncrypt = (record->kind==OBJECT_AES) ? CK_TRUE : CK_FALSE;
+			canSign = (record->kind==OBJECT_GENERIC) ? CK_TRUE : CK_FALSE;
+			valueLen = record->valueLen;
+			keyTemplate[12].ulValueLen = record->labelLen;
+			keyTemplate[13].ulValueLen = record->idLen;
+			encryptedLen = MAX_VALUE_LEN + 16;
+			rv = p11Func->C_EncryptInit(session, &mech, importKey);
+			if(rv==CKR_OK)
+				rv = p11Func->C_Encrypt(session, record->value, record->valueLen, encrypted, &encryptedLen);
+			if(rv==CKR_OK)
+				rv = p11Func->C_UnwrapKey(session, &mech, importKey, encrypted, encryptedLen, keyTemplate, keyTemplateLen, &handle);
+		}
+		countObject(rv==CKR_OK, record->line, rv);
+	}
+	free(record);
+	free(encrypted);
+	checkOperation(p11Func->C_CloseSession(session), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Reads the input file and adds its records to the queue.
+void readInput(FILE *input)
+{
+	char *line = (char*)malloc(LINE_LEN);
+	IMPORT_RECORD *record = (IMPORT_RECORD*)malloc(sizeof(IMPORT_RECORD));
+	unsigned long lineNumber = 0;
+
+	while(fgets(line, LINE_LEN, input)!=NULL)
+	{
+		lineNumber++;
+		if(line[0]=='#' || line[strspn(line, " \t\r\n")]=='\0')
+			continue;
+		if(!parseLine(line, record))
+		{
+			printf("  --> Line %lu : invalid.\n", lineNumber);
+			pthread_mutex_lock(&progressLock);
+			objectsFailed++;
+			pthread_mutex_unlock(&progressLock);
+			continue;
+		}
+		record->line = lineNumber;
+
+		pthread_mutex_lock(&queueLock);
+		while(queueCount==QUEUE_SIZE)
+			pthread_cond_wait(&queueNotFull, &queueLock);
+		memcpy(&queue[(queueHead + queueCount) % QUEUE_SIZE], record, sizeof(IMPORT_RECORD));
+		queueCount++;
+		pthread_cond_signal(&queueNotEmpty);
+		pthread_mutex_unlock(&queueLock);
+	}
+
+	pthread_mutex_lock(&queueLock);
+	inputDone = 1;
+	pthread_cond_broadcast(&queueNotEmpty);
+	pthread_mutex_unlock(&queueLock);
+	free(record);
+	free(line);
+}
+
+
+
+// Imports all objects of the input file using nThreads sessions.
+void importObjects(FILE *input, int nThreads)
+{
+	pthread_t *threads = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	double seconds = 0;
+
+	queue = (IMPORT_RECORD*)malloc(QUEUE_SIZE * sizeof(IMPORT_RECORD));
+	printf("\n> Importing objects using %d threads.\n", nThreads);
+	clock_gettime(CLOCK_MONOTONIC, &importStart);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&threads[ctr], NULL, &importer, NULL);
+	readInput(input);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(threads[ctr], NULL);
+	seconds = secondsSince(&importStart);
+	free(threads);
+
+	printf("\n> %lu objects imported in %.2f seconds, %lu failed.\n", objectsCreated, seconds, objectsFailed);
+	printf("  --> %.1f objects per second.\n", seconds>0 ? objectsCreated / seconds : 0);
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <number_of_threads> <input_file|->\n\n", exeName);
+	printf("Input lines :-\n");
+	printf("  data    <label> <value_hex>\n");
+	printf("  aes     <label> <id_hex|-> <key_hex>\n");
+	printf("  generic <label> <id_hex|-> <key_hex>\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int nThreads = 0;
+	FILE *input = stdin;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<5) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+	nThreads = atoi((const char*)argv[3]);
+	if(nThreads<1)
+		nThreads = 1;
+	if(strcmp((const char*)argv[4], "-")!=0)
+	{
+		input = fopen((const char*)argv[4], "r");
+		if(input==NULL)
+		{
+			printf("Failed to open %s.\n", (const char*)argv[4]);
+			free(slotPin);
+			exit(1);
+		}
+	}
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+	generateImportKey();
+	importObjects(input, nThreads);
+	if(input!=stdin)
+		fclose(input);
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
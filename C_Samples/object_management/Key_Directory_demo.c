@@ -0,0 +1,642 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to resolve keys by label or CKA_ID without calling C_FindObjects for every request.
+	- A key directory is built once: all token keys are found, and their class, label and CKA_ID are indexed in two
+	  hash tables (label to handles, CKA_ID to handles).
+	- A lookup is answered from the index. On a miss, the directory falls back to C_FindObjects, and a key found
+	  that way is added to the index.
+	- A refresh finds the handles of all keys again, but only reads the attributes of handles that are new, and drops
+	  the handles that no longer exist. A handle can also be dropped when an operation reports it as invalid.
+	- Lookups take a read lock, so many threads can resolve keys at the same time.
+	- The directory assumes labels and CKA_IDs of existing keys are not changed by other applications; a key whose
+	  label changed is only re-indexed when its handle is dropped.
+*/
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+#define FIND_BATCH 1024
+#define MAX_LABEL_LEN 256
+#define MAX_ID_LEN 128
+#define INITIAL_BUCKETS 1024
+#define NO_ENTRY 0xFFFFFFFFu
+#define ANY_CLASS ((CK_OBJECT_CLASS)CK_UNAVAILABLE_INFORMATION)
+#define LOOKUP_ROUNDS 100000
+
+
+// One key of the directory. Entries sharing a bucket are chained by index.
+typedef struct
+{
+	CK_OBJECT_HANDLE handle;
+	CK_OBJECT_CLASS objClass;
+	CK_BYTE label[MAX_LABEL_LEN];
+	uint32_t labelLen;
+	CK_BYTE id[MAX_ID_LEN];
+	uint32_t idLen;
+	uint32_t nextByLabel;
+	uint32_t nextById;
+	int live;
+} KEY_ENTRY;
+
+
+// Label and CKA_ID indexes of the keys of a partition.
+typedef struct
+{
+	KEY_ENTRY *entries;
+	uint32_t entryCount;
+	uint32_t entryCapacity;
+	uint32_t liveCount;
+	uint32_t *labelBuckets; // First entry of each chain, or NO_ENTRY.
+	uint32_t *idBuckets;
+	uint32_t bucketCount; // Power of two.
+	unsigned long hits;
+	unsigned long searches; // Lookups that needed C_FindObjects.
+	pthread_rwlock_t lock;
+} KEY_DIRECTORY;
+
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+
+KEY_DIRECTORY directory;
+
+
+
+// Frees the key directory.
+void freeDirectory()
+{
+	free(directory.entries);
+	free(directory.labelBuckets);
+	free(directory.idBuckets);
+	pthread_rwlock_destroy(&directory.lock);
+}
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+        free(slotPin);
+	freeDirectory();
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the seconds elapsed since start.
+double secondsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+// FNV-1a hash of a label or CKA_ID.
+uint32_t hashBytes(const CK_BYTE *bytes, uint32_t len)
+{
+	uint32_t h = 0x811C9DC5u;
+	for(uint32_t ctr=0; ctr<len; ctr++)
+		h = (h ^ bytes[ctr]) * 0x01000193u;
+	return h;
+}
+
+
+
+// Links an entry at the head of its label and CKA_ID chains.
+void linkEntry(KEY_DIRECTORY *dir, uint32_t index)
+{
+	KEY_ENTRY *entry = &dir->entries[index];
+	uint32_t labelBucket = hashBytes(entry->label, entry->labelLen) & (dir->bucketCount - 1);
+	uint32_t idBucket = hashBytes(entry->id, entry->idLen) & (dir->bucketCount - 1);
+
+	entry->nextByLabel = dir->labelBuckets[labelBucket];
+	dir->labelBuckets[labelBucket] = index;
+	entry->nextById = dir->idBuckets[idBucket];
+	dir->idBuckets[idBucket] = index;
+}
+
+
+
+// Allocates the buckets and links all live entries again.
+void rehash(KEY_DIRECTORY *dir, uint32_t bucketCount)
+{
+	free(dir->labelBuckets);
+	free(dir->idBuckets);
+	dir->bucketCount = bucketCount;
+	dir->labelBuckets = (uint32_t*)malloc(bucketCount * sizeof(uint32_t));
+	dir->idBuckets = (uint32_t*)malloc(bucketCount * sizeof(uint32_t));
+	memset(dir->labelBuckets, 0xFF, bucketCount * sizeof(uint32_t));
+	memset(dir->idBuckets, 0xFF, bucketCount * sizeof(uint32_t));
+	for(uint32_t index=0; index<dir->entryCount; index++)
+		if(dir->entries[index].live)
+			linkEntry(dir, index);
+}
+
+
+
+// Returns 1 if a handle is already in the directory. The caller holds the lock.
+int hasHandle(KEY_DIRECTORY *dir, KEY_ENTRY *key)
+{
+	uint32_t index = dir->labelBuckets[hashBytes(key->label, key->labelLen) & (dir->bucketCount - 1)];
+
+	for(; index!=NO_ENTRY; index = dir->entries[index].nextByLabel)
+		if(dir->entries[index].handle==key->handle)
+			return 1;
+	return 0;
+}
+
+
+
+// Adds a key to the directory. The caller holds the write lock.
+void insertEntry(KEY_DIRECTORY *dir, KEY_ENTRY *key)
+{
+	if(hasHandle(dir, key))
+		return;
+	if(dir->entryCount==dir->entryCapacity)
+	{
+		dir->entryCapacity = dir->entryCapacity ? dir->entryCapacity * 2 : INITIAL_BUCKETS;
+		dir->entries = (KEY_ENTRY*)realloc(dir->entries, dir->entryCapacity * sizeof(KEY_ENTRY));
+	}
+	dir->entries[dir->entryCount] = *key;
+	dir->entries[dir->entryCount].live = 1;
+	dir->liveCount++;
+	if(dir->liveCount>dir->bucketCount)
+	{
+		dir->entryCount++;
+		rehash(dir, dir->bucketCount * 2);
+	}
+	else
+		linkEntry(dir, dir->entryCount++);
+}
+
+
+
+// Removes an entry from its chains. The caller holds the write lock.
+void removeEntry(KEY_DIRECTORY *dir, uint32_t index)
+{
+	KEY_ENTRY *entry = &dir->entries[index];
+	uint32_t *link = &dir->labelBuckets[hashBytes(entry->label, entry->labelLen) & (dir->bucketCount - 1)];
+
+	while(*link!=index)
+		link = &dir->entries[*link].nextByLabel;
+	*link = entry->nextByLabel;
+	link = &dir->idBuckets[hashBytes(entry->id, entry->idLen) & (dir->bucketCount - 1)];
+	while(*link!=index)
+		link = &dir->entries[*link].nextById;
+	*link = entry->nextById;
+	entry->live = 0;
+	dir->liveCount--;
+}
+
+
+
+// Reads the class, label and CKA_ID of a key with one C_GetAttributeValue call.
+CK_RV readKey(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE handle, KEY_ENTRY *key)
+{
+	CK_RV rv = CKR_OK;
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_CLASS,	&key->objClass,	sizeof(CK_OBJECT_CLASS)},
+		{CKA_LABEL,	key->label,	MAX_LABEL_LEN},
+		{CKA_ID,	key->id,	MAX_ID_LEN}
+	};
+
+	rv = p11Func->C_GetAttributeValue(session, handle, attrib, 3);
+	if(rv!=CKR_OK && rv!=CKR_ATTRIBUTE_TYPE_INVALID && rv!=CKR_BUFFER_TOO_SMALL)
+		return rv;
+	key->handle = handle;
+	key->labelLen = (attrib[1].ulValueLen==CK_UNAVAILABLE_INFORMATION) ? 0 : (uint32_t)attrib[1].ulValueLen;
+	key->idLen = (attrib[2].ulValueLen==CK_UNAVAILABLE_INFORMATION) ? 0 : (uint32_t)attrib[2].ulValueLen;
+	return CKR_OK;
+}
+
+
+
+// Finds the handles of all token keys, in batches of FIND_BATCH handles.
+CK_OBJECT_HANDLE *findAllKeys(CK_SESSION_HANDLE session, CK_ULONG *count)
+{
+	CK_OBJECT_CLASS classes[] = {CKO_SECRET_KEY, CKO_PRIVATE_KEY, CKO_PUBLIC_KEY};
+	CK_OBJECT_HANDLE *handles = NULL;
+	CK_ULONG capacity = 0, objectCount = 0;
+	CK_BBOOL yes = CK_TRUE;
+
+	*count = 0;
+	for(int ctr=0; ctr<3; ctr++)
+	{
+		CK_ATTRIBUTE attrib[] =
+		{
+			{CKA_TOKEN,	&yes,		sizeof(CK_BBOOL)},
+			{CKA_CLASS,	&classes[ctr],	sizeof(CK_OBJECT_CLASS)}
+		};
+		checkOperation(p11Func->C_FindObjectsInit(session, attrib, 2), "C_FindObjectsInit");
+		do
+		{
+			if(*count + FIND_BATCH>capacity)
+			{
+				capacity = (capacity + FIND_BATCH) * 2;
+				handles = (CK_OBJECT_HANDLE*)realloc(handles, capacity * sizeof(CK_OBJECT_HANDLE));
+			}
+			checkOperation(p11Func->C_FindObjects(session, handles + *count, FIND_BATCH, &objectCount), "C_FindObjects");
+			*count += objectCount;
+		} while(objectCount==FIND_BATCH);
+		checkOperation(p11Func->C_FindObjectsFinal(session), "C_FindObjectsFinal");
+	}
+	return handles;
+}
+
+
+
+// Builds the directory from all token keys.
+void buildDirectory(KEY_DIRECTORY *dir, CK_SESSION_HANDLE session)
+{
+	CK_OBJECT_HANDLE *handles = NULL;
+	CK_ULONG count = 0;
+	KEY_ENTRY key;
+
+	memset(dir, 0, sizeof(KEY_DIRECTORY));
+	pthread_rwlock_init(&dir->lock, NULL);
+	rehash(dir, INITIAL_BUCKETS);
+	handles = findAllKeys(session, &count);
+	for(CK_ULONG ctr=0; ctr<count; ctr++)
+		if(readKey(session, handles[ctr], &key)==CKR_OK)
+			insertEntry(dir, &key);
+	free(handles);
+}
+
+
+
+// Searches a key with C_FindObjects and adds it to the directory.
+CK_OBJECT_HANDLE searchKey(KEY_DIRECTORY *dir, CK_SESSION_HANDLE session, CK_ATTRIBUTE_TYPE type, const CK_BYTE *value, uint32_t len, CK_OBJECT_CLASS objClass)
+{
+	CK_BBOOL yes = CK_TRUE;
+	CK_OBJECT_HANDLE handle = 0;
+	CK_ULONG objectCount = 0;
+	KEY_ENTRY key;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_TOKEN,	&yes,			sizeof(CK_BBOOL)},
+		{type,		(CK_VOID_PTR)value,	len},
+		{CKA_CLASS,	&objClass,		sizeof(CK_OBJECT_CLASS)}
+	};
+
+	__sync_fetch_and_add(&dir->searches, 1);
+	checkOperation(p11Func->C_FindObjectsInit(session, attrib, objClass==ANY_CLASS ? 2 : 3), "C_FindObjectsInit");
+	checkOperation(p11Func->C_FindObjects(session, &handle, 1, &objectCount), "C_FindObjects");
+	checkOperation(p11Func->C_FindObjectsFinal(session), "C_FindObjectsFinal");
+	if(objectCount==0)
+		return 0;
+	if(readKey(session, handle, &key)==CKR_OK)
+	{
+		pthread_rwlock_wrlock(&dir->lock);
+		insertEntry(dir, &key);
+		pthread_rwlock_unlock(&dir->lock);
+	}
+	return handle;
+}
+
+
+
+// Returns the handle of a key by label (CKA_LABEL) or by CKA_ID, optionally of a given class.
+// Returns 0 if no such key exists, even after a search.
+CK_OBJECT_HANDLE lookupKey(KEY_DIRECTORY *dir, CK_SESSION_HANDLE session, CK_ATTRIBUTE_TYPE type, const CK_BYTE *value, uint32_t len, CK_OBJECT_CLASS objClass)
+{
+	uint32_t bucket = 0, index = 0;
+	CK_OBJECT_HANDLE handle = 0;
+
+	pthread_rwlock_rdlock(&dir->lock);
+	bucket = hashBytes(value, len) & (dir->bucketCount - 1);
+	index = (type==CKA_LABEL) ? dir->labelBuckets[bucket] : dir->idBuckets[bucket];
+	while(index!=NO_ENTRY)
+	{
+		KEY_ENTRY *entry = &dir->entries[index];
+		const CK_BYTE *key = (type==CKA_LABEL) ? entry->label : entry->id;
+		uint32_t keyLen = (type==CKA_LABEL) ? entry->labelLen : entry->idLen;
+		if(keyLen==len && memcmp(key, value, len)==0 && (objClass==ANY_CLASS || entry->objClass==objClass))
+		{
+			handle = entry->handle;
+			break;
+		}
+		index = (type==CKA_LABEL) ? entry->nextByLabel : entry->nextById;
+	}
+	pthread_rwlock_unlock(&dir->lock);
+
+	if(handle!=0)
+	{
+		__sync_fetch_and_add(&dir->hits, 1);
+		return handle;
+	}
+	return searchKey(dir, session, type, value, len, objClass);
+}
+
+
+
+// Drops a handle, e.g. when an operation failed with CKR_KEY_HANDLE_INVALID. The next lookup of the key searches it again.
+void forgetKey(KEY_DIRECTORY *dir, CK_OBJECT_HANDLE handle)
+{
+	pthread_rwlock_wrlock(&dir->lock);
+	for(uint32_t index=0; index<dir->entryCount; index++)
+		if(dir->entries[index].live && dir->entries[index].handle==handle)
+			removeEntry(dir, index);
+	pthread_rwlock_unlock(&dir->lock);
+}
+
+
+
+int compareHandles(const void *a, const void *b)
+{
+	CK_OBJECT_HANDLE x = *(const CK_OBJECT_HANDLE*)a, y = *(const CK_OBJECT_HANDLE*)b;
+	return (x>y) - (x<y);
+}
+
+
+
+// Finds the handles of all keys again. Only new handles are read; handles that no longer exist are dropped.
+void refreshDirectory(KEY_DIRECTORY *dir, CK_SESSION_HANDLE session, uint32_t *added, uint32_t *removed)
+{
+	CK_ULONG count = 0, knownCount = 0;
+	CK_OBJECT_HANDLE *handles = findAllKeys(session, &count);
+	CK_OBJECT_HANDLE *known = NULL;
+	KEY_ENTRY key;
+
+	*added = 0;
+	*removed = 0;
+	qsort(handles, count, sizeof(CK_OBJECT_HANDLE), compareHandles);
+
+	pthread_rwlock_wrlock(&dir->lock);
+	known = (CK_OBJECT_HANDLE*)malloc((dir->liveCount + 1) * sizeof(CK_OBJECT_HANDLE));
+	for(uint32_t index=0; index<dir->entryCount; index++)
+	{
+		if(!dir->entries[index].live)
+			continue;
+		if(bsearch(&dir->entries[index].handle, handles, count, sizeof(CK_OBJECT_HANDLE), compareHandles)==NULL)
+		{
+			removeEntry(dir, index);
+			(*removed)++;
+		}
+		else
+			known[knownCount++] = dir->entries[index].handle;
+	}
+	pthread_rwlock_unlock(&dir->lock);
+
+	qsort(known, knownCount, sizeof(CK_OBJECT_HANDLE), compareHandles);
+	for(CK_ULONG ctr=0; ctr<count; ctr++)
+	{
+		if(bsearch(&handles[ctr], known, knownCount, sizeof(CK_OBJECT_HANDLE), compareHandles)!=NULL)
+			continue;
+		if(readKey(session, handles[ctr], &key)!=CKR_OK)
+			continue;
+		pthread_rwlock_wrlock(&dir->lock);
+		insertEntry(dir, &key);
+		pthread_rwlock_unlock(&dir->lock);
+		(*added)++;
+	}
+	free(known);
+	free(handles);
+}
+
+
+
+// Converts a hexadecimal string to bytes. Returns the number of bytes, or -1 if the string is not valid.
+int hexToBytes(const char *hex, CK_BYTE *out, int maxLen)
+{
+	int len = (int)strlen(hex) / 2;
+	unsigned int byte = 0;
+
+	if(strlen(hex) % 2 || len>maxLen)
+		return -1;
+	for(int ctr=0; ctr<len; ctr++)
+	{
+		if(sscanf(hex + ctr * 2, "%2x", &byte)!=1)
+			return -1;
+		out[ctr] = (CK_BYTE)byte;
+	}
+	return len;
+}
+
+
+
+// Resolves a key from the directory and with C_FindObjects, and compares the time taken by each.
+void resolveKey(const char *name)
+{
+	CK_ATTRIBUTE_TYPE type = CKA_LABEL;
+	CK_BYTE value[MAX_LABEL_LEN];
+	int len = 0;
+	CK_OBJECT_HANDLE handle = 0;
+	struct timespec start;
+	double lookupSeconds = 0, searchSeconds = 0;
+
+	if(strncmp(name, "id:", 3)==0)
+	{
+		type = CKA_ID;
+		len = hexToBytes(name + 3, value, MAX_ID_LEN);
+	}
+	else
+	{
+		len = (int)strlen(name);
+		if(len>MAX_LABEL_LEN)
+			len = -1;
+		else
+			memcpy(value, name, len);
+	}
+	if(len<0)
+	{
+		printf("\n> %s : invalid key name.\n", name);
+		return;
+	}
+
+	handle = lookupKey(&directory, hSession, type, value, (uint32_t)len, ANY_CLASS);
+	printf("\n> %s\n", name);
+	if(handle==0)
+	{
+		printf("  --> not found.\n");
+		return;
+	}
+	printf("  --> handle : %lu\n", handle);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<LOOKUP_ROUNDS; ctr++)
+		handle = lookupKey(&directory, hSession, type, value, (uint32_t)len, ANY_CLASS);
+	lookupSeconds = secondsSince(&start) / LOOKUP_ROUNDS;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	handle = searchKey(&directory, hSession, type, value, (uint32_t)len, ANY_CLASS);
+	searchSeconds = secondsSince(&start);
+	printf("  --> directory lookup : %.3f us, C_FindObjects : %.3f us.\n", lookupSeconds * 1e6, searchSeconds * 1e6);
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <key> [key ...]\n\n", exeName);
+	printf("  key : a label, or id:<hex> for a CKA_ID.\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	struct timespec start;
+	uint32_t added = 0, removed = 0;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<4) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	buildDirectory(&directory, hSession);
+	printf("\n> Key directory built in %.2f seconds.\n", secondsSince(&start));
+	printf("  --> %u keys indexed by label and CKA_ID.\n", directory.liveCount);
+
+	for(int ctr=3; ctr<argc; ctr++)
+		resolveKey((const char*)argv[ctr]);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	refreshDirectory(&directory, hSession, &added, &removed);
+	printf("\n> Key directory refreshed in %.2f seconds.\n", secondsSince(&start));
+	printf("  --> %u keys added, %u keys removed, %u keys indexed.\n", added, removed, directory.liveCount);
+	printf("  --> %lu lookups answered from the index, %lu searches.\n", directory.hits, directory.searches);
+
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,602 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to read a list of attributes of every object of a partition as fast as possible.
+	- All token objects are found with C_FindObjects, in batches of FIND_BATCH handles.
+	- The handles are shared by a pool of threads, each with its own session. Every attribute of an object is read
+	  with a single C_GetAttributeValue call, using buffers that grow to the largest value seen so far; the two-call
+	  size-then-fetch pattern is only used for an attribute whose buffer was too small.
+	- The result is a columnar table: one array of values per attribute, so a column can be scanned without touching
+	  the others. Attributes an object does not have (e.g. CKA_KEY_TYPE of a data object) are marked unavailable.
+	- The number of objects per class and the first rows are displayed, and the table can be written to a CSV file.
+	- The attributes read are listed in inventoryColumns[].
+*/
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+#define FIND_BATCH 1024
+#define ROWS_PER_CLAIM 64 // Number of handles a thread takes from the list at a time.
+#define INITIAL_VALUE_LEN 64
+#define MAX_THREADS 256
+#define MAX_COLUMNS 16
+#define ROWS_TO_DISPLAY 10
+#define UNAVAILABLE_LEN 0xFFFFFFFFu
+
+
+typedef enum { SHOW_ULONG, SHOW_TEXT, SHOW_HEX } COLUMN_FORMAT;
+
+
+// One attribute of every object.
+// The value of row r is data[offsets[r]] to data[offsets[r] + lengths[r]], or lengths[r] is UNAVAILABLE_LEN.
+typedef struct
+{
+	CK_ATTRIBUTE_TYPE type;
+	const char *name;
+	COLUMN_FORMAT format;
+	uint32_t *offsets;
+	uint32_t *lengths;
+	CK_BYTE *data;
+	size_t dataLen;
+} INVENTORY_COLUMN;
+
+
+// Values read by one thread, moved to the columns once all threads are done.
+typedef struct
+{
+	CK_BYTE *data[MAX_COLUMNS];
+	size_t dataLen[MAX_COLUMNS];
+	size_t dataCapacity[MAX_COLUMNS];
+	CK_BYTE *buffer[MAX_COLUMNS]; // C_GetAttributeValue buffers.
+	CK_ULONG bufferLen[MAX_COLUMNS];
+	unsigned long calls;
+	unsigned long missing;
+	unsigned long failed;
+} WORKER_STATE;
+
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+
+// Attributes to read. Add entries here to read more columns.
+INVENTORY_COLUMN inventoryColumns[] =
+{
+	{CKA_CLASS,	"CKA_CLASS",	SHOW_ULONG},
+	{CKA_KEY_TYPE,	"CKA_KEY_TYPE",	SHOW_ULONG},
+	{CKA_LABEL,	"CKA_LABEL",	SHOW_TEXT},
+	{CKA_ID,	"CKA_ID",	SHOW_HEX}
+};
+int columnCount = sizeof(inventoryColumns)/sizeof(*inventoryColumns);
+
+CK_OBJECT_HANDLE *handles = NULL; // One row per handle.
+CK_ULONG rowCount = 0;
+CK_ULONG nextRow = 0;
+uint16_t *rowOwner = NULL; // Thread that read each row.
+WORKER_STATE *workers = NULL;
+pthread_mutex_t rowLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// Frees the inventory table.
+void freeInventory()
+{
+	for(int col=0; col<columnCount; col++)
+	{
+		free(inventoryColumns[col].offsets);
+		free(inventoryColumns[col].lengths);
+		free(inventoryColumns[col].data);
+	}
+	free(handles);
+	free(rowOwner);
+}
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+        free(slotPin);
+	freeInventory();
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the seconds elapsed since start.
+double secondsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+// Finds all token objects, in batches of FIND_BATCH handles.
+void findAllObjects()
+{
+	CK_BBOOL yes = CK_TRUE;
+	CK_ULONG objectCount = 0;
+	CK_ULONG capacity = 0;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_TOKEN,	&yes,	sizeof(CK_BBOOL)}
+	};
+
+	checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, 1), "C_FindObjectsInit");
+	do
+	{
+		if(rowCount + FIND_BATCH>capacity)
+		{
+			capacity = (capacity + FIND_BATCH) * 2;
+			handles = (CK_OBJECT_HANDLE*)realloc(handles, capacity * sizeof(CK_OBJECT_HANDLE));
+		}
+		checkOperation(p11Func->C_FindObjects(hSession, handles + rowCount, FIND_BATCH, &objectCount), "C_FindObjects");
+		rowCount += objectCount;
+	} while(objectCount==FIND_BATCH);
+	checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+}
+
+
+
+// Appends the value of an attribute to the data of a thread, and records where it is.
+void storeValue(WORKER_STATE *worker, int col, CK_ULONG row, CK_ATTRIBUTE *attrib)
+{
+	INVENTORY_COLUMN *column = &inventoryColumns[col];
+
+	if(attrib==NULL || attrib->ulValueLen==CK_UNAVAILABLE_INFORMATION)
+	{
+		column->lengths[row] = UNAVAILABLE_LEN;
+		column->offsets[row] = 0;
+		return;
+	}
+	if(worker->dataLen[col] + attrib->ulValueLen>worker->dataCapacity[col])
+	{
+		worker->dataCapacity[col] = (worker->dataCapacity[col] + attrib->ulValueLen) * 2;
+		worker->data[col] = (CK_BYTE*)realloc(worker->data[col], worker->dataCapacity[col]);
+	}
+	memcpy(worker->data[col] + worker->dataLen[col], attrib->pValue, attrib->ulValueLen);
+	column->offsets[row] = (uint32_t)worker->dataLen[col];
+	column->lengths[row] = (uint32_t)attrib->ulValueLen;
+	worker->dataLen[col] += attrib->ulValueLen;
+}
+
+
+
+// Reads all attributes of one object with a single C_GetAttributeValue call.
+// When the call does not return all of them, each unavailable attribute is read again on its own, once its size
+// is known. C_GetAttributeValue returns only one of CKR_ATTRIBUTE_SENSITIVE, CKR_ATTRIBUTE_TYPE_INVALID and
+// CKR_BUFFER_TOO_SMALL when several apply, so a buffer too small may be hidden behind another code.
+void readRow(WORKER_STATE *worker, CK_SESSION_HANDLE session, CK_ULONG row)
+{
+	CK_ATTRIBUTE attrib[MAX_COLUMNS];
+	CK_RV rv = CKR_OK;
+
+	for(int col=0; col<columnCount; col++)
+	{
+		attrib[col].type = inventoryColumns[col].type;
+		attrib[col].pValue = worker->buffer[col];
+		attrib[col].ulValueLen = worker->bufferLen[col];
+	}
+	rv = p11Func->C_GetAttributeValue(session, handles[row], attrib, columnCount);
+	worker->calls++;
+	if(rv==CKR_OBJECT_HANDLE_INVALID) // Destroyed since it was found.
+	{
+		worker->missing++;
+		for(int col=0; col<columnCount; col++)
+			storeValue(worker, col, row, NULL);
+		return;
+	}
+	if(rv!=CKR_OK && rv!=CKR_ATTRIBUTE_SENSITIVE && rv!=CKR_ATTRIBUTE_TYPE_INVALID && rv!=CKR_BUFFER_TOO_SMALL)
+	{
+		worker->failed++;
+		printf("  --> Object handle %lu : C_GetAttributeValue failed with Ox%lX.\n", handles[row], rv);
+		for(int col=0; col<columnCount; col++)
+			storeValue(worker, col, row, NULL);
+		return;
+	}
+
+	for(int col=0; col<columnCount && rv!=CKR_OK; col++)
+	{
+		CK_ATTRIBUTE size = {inventoryColumns[col].type, NULL, 0};
+		if(attrib[col].ulValueLen!=CK_UNAVAILABLE_INFORMATION)
+			continue;
+		worker->calls++;
+		if(p11Func->C_GetAttributeValue(session, handles[row], &size, 1)!=CKR_OK || size.ulValueLen==CK_UNAVAILABLE_INFORMATION)
+			continue; // Not defined or sensitive.
+		worker->bufferLen[col] = size.ulValueLen;
+		worker->buffer[col] = (CK_BYTE*)realloc(worker->buffer[col], worker->bufferLen[col]);
+		attrib[col].pValue = worker->buffer[col];
+		attrib[col].ulValueLen = worker->bufferLen[col];
+		worker->calls++;
+		if(p11Func->C_GetAttributeValue(session, handles[row], &attrib[col], 1)!=CKR_OK)
+			attrib[col].ulValueLen = CK_UNAVAILABLE_INFORMATION;
+	}
+
+	for(int col=0; col<columnCount; col++)
+		storeValue(worker, col, row, &attrib[col]);
+}
+
+
+
+// Reading thread; takes ROWS_PER_CLAIM handles at a time until none are left.
+void *reader(void *arg)
+{
+	WORKER_STATE *worker = (WORKER_STATE*)arg;
+	uint16_t owner = (uint16_t)(worker - workers);
+	CK_SESSION_HANDLE session = 0;
+	CK_ULONG first = 0, last = 0;
+
+	for(int col=0; col<columnCount; col++)
+	{
+		worker->bufferLen[col] = INITIAL_VALUE_LEN;
+		worker->buffer[col] = (CK_BYTE*)malloc(INITIAL_VALUE_LEN);
+	}
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION, NULL, NULL, &session), "C_OpenSession");
+	while(1)
+	{
+		pthread_mutex_lock(&rowLock);
+		first = nextRow;
+		nextRow = (nextRow + ROWS_PER_CLAIM<rowCount) ? nextRow + ROWS_PER_CLAIM : rowCount;
+		last = nextRow;
+		pthread_mutex_unlock(&rowLock);
+		if(first>=last)
+			break;
+		for(CK_ULONG row=first; row<last; row++)
+		{
+			rowOwner[row] = owner;
+			readRow(worker, session, row);
+		}
+	}
+	checkOperation(p11Func->C_CloseSession(session), "C_CloseSession");
+	for(int col=0; col<columnCount; col++)
+		free(worker->buffer[col]);
+	return 0;
+}
+
+
+
+// Moves the values read by every thread to the columns, in row order.
+void buildColumns(int nThreads)
+{
+	for(int col=0; col<columnCount; col++)
+	{
+		INVENTORY_COLUMN *column = &inventoryColumns[col];
+		size_t total = 0;
+
+		for(int ctr=0; ctr<nThreads; ctr++)
+			total += workers[ctr].dataLen[col];
+		column->data = (CK_BYTE*)malloc(total ? total : 1);
+		column->dataLen = 0;
+		for(CK_ULONG row=0; row<rowCount; row++)
+		{
+			if(column->lengths[row]==UNAVAILABLE_LEN)
+				continue;
+			memcpy(column->data + column->dataLen, workers[rowOwner[row]].data[col] + column->offsets[row], column->lengths[row]);
+			column->offsets[row] = (uint32_t)column->dataLen;
+			column->dataLen += column->lengths[row];
+		}
+		for(int ctr=0; ctr<nThreads; ctr++)
+			free(workers[ctr].data[col]);
+	}
+}
+
+
+
+// Reads the attributes of all rows using nThreads sessions.
+void readInventory(int nThreads)
+{
+	pthread_t *threads = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	unsigned long calls = 0, missing = 0, failed = 0;
+	struct timespec start;
+	double seconds = 0;
+
+	workers = (WORKER_STATE*)calloc(nThreads, sizeof(WORKER_STATE));
+	rowOwner = (uint16_t*)calloc(rowCount ? rowCount : 1, sizeof(uint16_t));
+	for(int col=0; col<columnCount; col++)
+	{
+		inventoryColumns[col].offsets = (uint32_t*)malloc((rowCount ? rowCount : 1) * sizeof(uint32_t));
+		inventoryColumns[col].lengths = (uint32_t*)malloc((rowCount ? rowCount : 1) * sizeof(uint32_t));
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&threads[ctr], NULL, &reader, &workers[ctr]);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(threads[ctr], NULL);
+	seconds = secondsSince(&start);
+	buildColumns(nThreads);
+
+	for(int ctr=0; ctr<nThreads; ctr++)
+	{
+		calls += workers[ctr].calls;
+		missing += workers[ctr].missing;
+		failed += workers[ctr].failed;
+	}
+	printf("\n> Attributes of %lu objects read by %d threads in %.2f seconds.\n", rowCount, nThreads, seconds);
+	printf("  --> %.1f objects per second.\n", seconds>0 ? rowCount / seconds : 0);
+	printf("  --> %lu C_GetAttributeValue calls (%.2f per object).\n", calls, rowCount ? (double)calls / rowCount : 0);
+	if(missing || failed)
+		printf("  --> %lu objects destroyed while reading, %lu failed.\n", missing, failed);
+	free(workers);
+	free(threads);
+}
+
+
+
+// Returns the column of an attribute, or NULL if it is not read.
+INVENTORY_COLUMN *findColumn(CK_ATTRIBUTE_TYPE type)
+{
+	for(int col=0; col<columnCount; col++)
+		if(inventoryColumns[col].type==type)
+			return &inventoryColumns[col];
+	return NULL;
+}
+
+
+
+// Returns a CK_ULONG value of a column.
+int ulongValue(INVENTORY_COLUMN *column, CK_ULONG row, CK_ULONG *value)
+{
+	if(column->lengths[row]!=sizeof(CK_ULONG))
+		return 0;
+	memcpy(value, column->data + column->offsets[row], sizeof(CK_ULONG));
+	return 1;
+}
+
+
+
+// Writes a value of a column; text is quoted for CSV, other formats are written as hex.
+void printValue(FILE *out, INVENTORY_COLUMN *column, CK_ULONG row)
+{
+	CK_BYTE *value = column->data + column->offsets[row];
+	CK_ULONG number = 0;
+
+	if(column->lengths[row]==UNAVAILABLE_LEN)
+		return;
+	if(column->format==SHOW_ULONG && ulongValue(column, row, &number))
+		fprintf(out, "0x%lX", number);
+	else if(column->format==SHOW_TEXT)
+	{
+		fputc('"', out);
+		for(uint32_t ctr=0; ctr<column->lengths[row]; ctr++)
+		{
+			if(value[ctr]=='"')
+				fputc('"', out);
+			fputc(value[ctr], out);
+		}
+		fputc('"', out);
+	}
+	else
+	{
+		for(uint32_t ctr=0; ctr<column->lengths[row]; ctr++)
+			fprintf(out, "%02X", value[ctr]);
+	}
+}
+
+
+
+// Writes rows of the table, starting with a line of column names.
+void writeRows(FILE *out, CK_ULONG count, const char *indent)
+{
+	fprintf(out, "%sHANDLE", indent);
+	for(int col=0; col<columnCount; col++)
+		fprintf(out, ",%s", inventoryColumns[col].name);
+	fprintf(out, "\n");
+	for(CK_ULONG row=0; row<count; row++)
+	{
+		fprintf(out, "%s%lu", indent, handles[row]);
+		for(int col=0; col<columnCount; col++)
+		{
+			fputc(',', out);
+			printValue(out, &inventoryColumns[col], row);
+		}
+		fprintf(out, "\n");
+	}
+}
+
+
+
+// Displays the number of objects of each class, using only the CKA_CLASS column.
+void showClassCount()
+{
+	INVENTORY_COLUMN *column = findColumn(CKA_CLASS);
+	CK_ULONG counts[5] = {0};
+	CK_ULONG others = 0, objClass = 0;
+	const char *names[5] = {"CKO_DATA", "CKO_CERTIFICATE", "CKO_PUBLIC_KEY", "CKO_PRIVATE_KEY", "CKO_SECRET_KEY"};
+
+	if(column==NULL)
+		return;
+	for(CK_ULONG row=0; row<rowCount; row++)
+	{
+		if(ulongValue(column, row, &objClass) && objClass<=CKO_SECRET_KEY)
+			counts[objClass]++;
+		else
+			others++;
+	}
+	printf("\n> Objects per class.\n");
+	for(int ctr=0; ctr<5; ctr++)
+		printf("  --> %-16s : %lu\n", names[ctr], counts[ctr]);
+	printf("  --> %-16s : %lu\n", "OTHER", others);
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <number_of_threads> [csv_file]\n\n", exeName);
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int nThreads = 0;
+	FILE *csv = NULL;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<4) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+	nThreads = atoi((const char*)argv[3]);
+	if(nThreads<1)
+		nThreads = 1;
+	if(nThreads>MAX_THREADS)
+		nThreads = MAX_THREADS;
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+	findAllObjects();
+	printf("\n> %lu token objects found.\n", rowCount);
+	readInventory(nThreads);
+	showClassCount();
+	printf("\n> First rows.\n");
+	writeRows(stdout, rowCount<ROWS_TO_DISPLAY ? rowCount : ROWS_TO_DISPLAY, "  --> ");
+	if(argc>4)
+	{
+		csv = fopen((const char*)argv[4], "w");
+		if(csv)
+		{
+			writeRows(csv, rowCount, "");
+			fclose(csv);
+			printf("\n> Inventory written to %s.\n", (const char*)argv[4]);
+		}
+		else
+			printf("\n> Failed to create %s.\n", (const char*)argv[4]);
+	}
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
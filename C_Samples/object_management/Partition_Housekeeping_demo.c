@@ -0,0 +1,604 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to destroy or copy many token objects in parallel without saturating the HSM.
+	- Objects are selected by class with C_FindObjects, then filtered by label pattern (* and ?), by CKA_END_DATE
+	  (expired objects), by CKA_START_DATE (objects older than a number of days) and by CKA_USAGE_COUNT.
+	- The selected objects are listed, destroyed with C_DestroyObject, or copied with C_CopyObject under a new label.
+	- The handles are processed in batches by a pool of threads, each with its own session. All threads share a rate
+	  limit (HSM calls per second), so the housekeeping can run next to production traffic.
+	- Options are given as name=value arguments, e.g. :
+		class=secret label=tmp-* expired threads=8 rate=200
+	- destroy refuses to run without a selection criterion, unless the all option is given, so a mistyped command
+	  cannot wipe the partition.
+*/
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+#define FIND_BATCH 1024
+#define WORK_BATCH 64 // Number of handles a thread takes from the list at a time.
+#define MAX_LABEL_LEN 256
+#define PROGRESS_INTERVAL 1000
+
+typedef enum { ACTION_LIST, ACTION_DESTROY, ACTION_COPY } HOUSEKEEPING_ACTION;
+
+
+// Objects to select. A criterion that is not set selects every object.
+typedef struct
+{
+	CK_OBJECT_CLASS objClass;
+	int anyClass;
+	const char *labelPattern;
+	int expired; // CKA_END_DATE before today.
+	long startedBefore; // CKA_START_DATE before this date (YYYYMMDD), or 0.
+	CK_ULONG minUsageCount;
+	int hasMinUsageCount;
+	const char *copyPrefix; // Label prefix of the copies.
+	int all; // Confirms that destroy may select every object.
+} SELECTION;
+
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+
+SELECTION selection;
+HOUSEKEEPING_ACTION action = ACTION_LIST;
+long today = 0; // YYYYMMDD
+
+CK_OBJECT_HANDLE *handles = NULL; // Objects of the selected class.
+CK_ULONG handleCount = 0;
+CK_ULONG nextHandle = 0;
+unsigned long objectsSelected = 0;
+unsigned long objectsDone = 0;
+unsigned long objectsFailed = 0;
+pthread_mutex_t progressLock = PTHREAD_MUTEX_INITIALIZER;
+
+double callsPerSecond = 0; // 0 : no limit.
+double nextCallTime = 0;
+pthread_mutex_t rateLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+        free(slotPin);
+	free(handles);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the seconds elapsed since start.
+double secondsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+// Returns the monotonic clock in seconds.
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+
+// Waits for the next call slot. Calls of all threads are spaced 1/callsPerSecond seconds apart.
+void waitForRate()
+{
+	double wait = 0, current = 0;
+	struct timespec ts;
+
+	if(callsPerSecond<=0)
+		return;
+	pthread_mutex_lock(&rateLock);
+	current = now();
+	if(nextCallTime<current)
+		nextCallTime = current;
+	wait = nextCallTime - current;
+	nextCallTime += 1.0 / callsPerSecond;
+	pthread_mutex_unlock(&rateLock);
+	if(wait>0)
+	{
+		ts.tv_sec = (time_t)wait;
+		ts.tv_nsec = (long)((wait - ts.tv_sec) * 1e9);
+		nanosleep(&ts, NULL);
+	}
+}
+
+
+
+// Returns a date as YYYYMMDD, days before today.
+long dateBefore(int days)
+{
+	time_t t = time(NULL) - (time_t)days * 86400;
+	struct tm *tm = localtime(&t);
+	return (tm->tm_year + 1900) * 10000L + (tm->tm_mon + 1) * 100L + tm->tm_mday;
+}
+
+
+
+// Converts a CK_DATE to YYYYMMDD. Returns 0 if the date is not set.
+long dateValue(CK_DATE *date, CK_ULONG len)
+{
+	char text[9];
+
+	if(len!=sizeof(CK_DATE))
+		return 0;
+	memcpy(text, date->year, 4);
+	memcpy(text + 4, date->month, 2);
+	memcpy(text + 6, date->day, 2);
+	text[8] = '\0';
+	return atol(text);
+}
+
+
+
+// Matches a label against a pattern where * is any sequence of characters and ? is any character.
+int matchPattern(const char *pattern, const CK_BYTE *label, CK_ULONG len)
+{
+	const char *star = NULL;
+	CK_ULONG pos = 0, starPos = 0;
+
+	while(pos<len)
+	{
+		if(*pattern=='*')
+		{
+			star = pattern++;
+			starPos = pos;
+		}
+		else if(*pattern!='\0' && (*pattern=='?' || *pattern==(char)label[pos]))
+		{
+			pattern++;
+			pos++;
+		}
+		else if(star!=NULL) // Let the last * match one more character.
+		{
+			pattern = star + 1;
+			pos = ++starPos;
+		}
+		else
+			return 0;
+	}
+	while(*pattern=='*')
+		pattern++;
+	return *pattern=='\0';
+}
+
+
+
+// Finds all token objects of the selected class, in batches of FIND_BATCH handles.
+void findObjects()
+{
+	CK_BBOOL yes = CK_TRUE;
+	CK_ULONG objectCount = 0;
+	CK_ULONG capacity = 0;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_TOKEN,	&yes,			sizeof(CK_BBOOL)},
+		{CKA_CLASS,	&selection.objClass,	sizeof(CK_OBJECT_CLASS)}
+	};
+
+	checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, selection.anyClass ? 1 : 2), "C_FindObjectsInit");
+	do
+	{
+		if(handleCount + FIND_BATCH>capacity)
+		{
+			capacity = (capacity + FIND_BATCH) * 2;
+			handles = (CK_OBJECT_HANDLE*)realloc(handles, capacity * sizeof(CK_OBJECT_HANDLE));
+		}
+		checkOperation(p11Func->C_FindObjects(hSession, handles + handleCount, FIND_BATCH, &objectCount), "C_FindObjects");
+		handleCount += objectCount;
+	} while(objectCount==FIND_BATCH);
+	checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+}
+
+
+
+// Reads the label, dates and usage count of an object and checks them against the selection.
+int isSelected(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE handle, CK_BYTE *label, CK_ULONG *labelLen)
+{
+	CK_DATE startDate, endDate;
+	CK_ULONG usageCount = 0;
+	long date = 0;
+	CK_RV rv = CKR_OK;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_LABEL,		label,		MAX_LABEL_LEN},
+		{CKA_START_DATE,	&startDate,	sizeof(CK_DATE)},
+		{CKA_END_DATE,		&endDate,	sizeof(CK_DATE)},
+		{CKA_USAGE_COUNT,	&usageCount,	sizeof(CK_ULONG)}
+	};
+
+	waitForRate();
+	rv = p11Func->C_GetAttributeValue(session, handle, attrib, 4);
+	if(rv!=CKR_OK && rv!=CKR_ATTRIBUTE_TYPE_INVALID && rv!=CKR_BUFFER_TOO_SMALL)
+		return 0; // Destroyed since it was found.
+	*labelLen = (attrib[0].ulValueLen==CK_UNAVAILABLE_INFORMATION) ? 0 : attrib[0].ulValueLen;
+
+	if(selection.labelPattern!=NULL && (attrib[0].ulValueLen==CK_UNAVAILABLE_INFORMATION ||
+	   !matchPattern(selection.labelPattern, label, *labelLen)))
+		return 0;
+	if(selection.expired)
+	{
+		date = dateValue(&endDate, attrib[2].ulValueLen);
+		if(date==0 || date>=today)
+			return 0;
+	}
+	if(selection.startedBefore)
+	{
+		date = dateValue(&startDate, attrib[1].ulValueLen);
+		if(date==0 || date>=selection.startedBefore)
+			return 0;
+	}
+	if(selection.hasMinUsageCount && (attrib[3].ulValueLen!=sizeof(CK_ULONG) || usageCount<selection.minUsageCount))
+		return 0;
+	return 1;
+}
+
+
+
+// Destroys or copies a selected object.
+CK_RV processObject(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE handle, CK_BYTE *label, CK_ULONG labelLen)
+{
+	CK_BYTE newLabel[2 * MAX_LABEL_LEN];
+	CK_OBJECT_HANDLE copy = 0;
+	size_t prefixLen = 0;
+
+	if(action==ACTION_LIST)
+	{
+		pthread_mutex_lock(&progressLock);
+		printf("  --> %lu : %.*s\n", handle, (int)labelLen, label);
+		pthread_mutex_unlock(&progressLock);
+		return CKR_OK;
+	}
+	waitForRate();
+	if(action==ACTION_DESTROY)
+		return p11Func->C_DestroyObject(session, handle);
+
+	prefixLen = strlen(selection.copyPrefix);
+	memcpy(newLabel, selection.copyPrefix, prefixLen);
+	memcpy(newLabel + prefixLen, label, labelLen);
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_LABEL,	newLabel,	prefixLen + labelLen}
+	};
+	return p11Func->C_CopyObject(session, handle, attrib, 1, &copy);
+}
+
+
+
+// Housekeeping thread; takes WORK_BATCH handles at a time until none are left.
+void *housekeeper(void *arg)
+{
+	CK_SESSION_HANDLE session = 0;
+	CK_BYTE label[MAX_LABEL_LEN];
+	CK_ULONG labelLen = 0;
+	CK_ULONG first = 0, last = 0;
+	CK_RV rv = CKR_OK;
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &session), "C_OpenSession");
+	while(1)
+	{
+		pthread_mutex_lock(&progressLock);
+		first = nextHandle;
+		nextHandle = (nextHandle + WORK_BATCH<handleCount) ? nextHandle + WORK_BATCH : handleCount;
+		last = nextHandle;
+		pthread_mutex_unlock(&progressLock);
+		if(first>=last)
+			break;
+
+		for(CK_ULONG ctr=first; ctr<last; ctr++)
+		{
+			if(!isSelected(session, handles[ctr], label, &labelLen))
+				continue;
+			rv = processObject(session, handles[ctr], label, labelLen);
+			pthread_mutex_lock(&progressLock);
+			objectsSelected++;
+			if(rv==CKR_OK)
+				objectsDone++;
+			else
+			{
+				objectsFailed++;
+				printf("  --> Object handle %lu : failed with Ox%lX.\n", handles[ctr], rv);
+			}
+			if(action!=ACTION_LIST && objectsSelected % PROGRESS_INTERVAL==0)
+				printf("  --> %lu objects processed.\n", objectsSelected);
+			pthread_mutex_unlock(&progressLock);
+		}
+	}
+	checkOperation(p11Func->C_CloseSession(session), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Processes the objects found using nThreads sessions.
+void runHousekeeping(int nThreads)
+{
+	pthread_t *threads = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	const char *verbs[] = {"listed", "destroyed", "copied"};
+	struct timespec start;
+	double seconds = 0;
+
+	printf("\n> %lu objects to check using %d threads", handleCount, nThreads);
+	if(callsPerSecond>0)
+		printf(", at most %.0f calls per second", callsPerSecond);
+	printf(".\n");
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&threads[ctr], NULL, &housekeeper, NULL);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(threads[ctr], NULL);
+	seconds = secondsSince(&start);
+	free(threads);
+
+	printf("\n> %lu of %lu objects selected in %.2f seconds.\n", objectsSelected, handleCount, seconds);
+	printf("  --> %lu objects %s, %lu failed.\n", objectsDone, verbs[action], objectsFailed);
+	if(action!=ACTION_LIST)
+		printf("  --> %.1f objects per second.\n", seconds>0 ? objectsDone / seconds : 0);
+}
+
+
+
+// Returns 1 if at least one selection criterion was given.
+int hasCriterion()
+{
+	return !selection.anyClass || selection.labelPattern!=NULL || selection.expired
+	       || selection.startedBefore!=0 || selection.hasMinUsageCount;
+}
+
+
+
+// Parses a name=value option. Returns 0 if the option is unknown.
+int parseOption(const char *option, int *nThreads)
+{
+	const char *value = strchr(option, '=');
+	value = value ? value + 1 : "";
+
+	if(strncmp(option, "class=", 6)==0)
+	{
+		selection.anyClass = 0;
+		if(strcmp(value, "secret")==0)
+			selection.objClass = CKO_SECRET_KEY;
+		else if(strcmp(value, "private")==0)
+			selection.objClass = CKO_PRIVATE_KEY;
+		else if(strcmp(value, "public")==0)
+			selection.objClass = CKO_PUBLIC_KEY;
+		else if(strcmp(value, "data")==0)
+			selection.objClass = CKO_DATA;
+		else if(strcmp(value, "certificate")==0)
+			selection.objClass = CKO_CERTIFICATE;
+		else
+			return 0;
+	}
+	else if(strncmp(option, "label=", 6)==0)
+		selection.labelPattern = value;
+	else if(strcmp(option, "expired")==0)
+		selection.expired = 1;
+	else if(strncmp(option, "older_than=", 11)==0)
+		selection.startedBefore = dateBefore(atoi(value));
+	else if(strncmp(option, "min_usage=", 10)==0)
+	{
+		selection.minUsageCount = strtoul(value, NULL, 10);
+		selection.hasMinUsageCount = 1;
+	}
+	else if(strncmp(option, "prefix=", 7)==0)
+		selection.copyPrefix = value;
+	else if(strcmp(option, "all")==0)
+		selection.all = 1;
+	else if(strncmp(option, "threads=", 8)==0)
+		*nThreads = atoi(value);
+	else if(strncmp(option, "rate=", 5)==0)
+		callsPerSecond = atof(value);
+	else
+		return 0;
+	return 1;
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <list|destroy|copy> [option ...]\n\n", exeName);
+	printf("Options :-\n");
+	printf("  class=<secret|private|public|data|certificate>  : class of the objects (default : all).\n");
+	printf("  label=<pattern>                                 : label pattern, * and ? are wildcards.\n");
+	printf("  expired                                         : CKA_END_DATE is before today.\n");
+	printf("  older_than=<days>                               : CKA_START_DATE is more than <days> days ago.\n");
+	printf("  min_usage=<count>                               : CKA_USAGE_COUNT is at least <count>.\n");
+	printf("  prefix=<text>                                   : label prefix of the copies (copy only).\n");
+	printf("  all                                             : lets destroy run without any of the criteria above.\n");
+	printf("  threads=<n>                                     : number of threads (default : 4).\n");
+	printf("  rate=<n>                                        : maximum HSM calls per second (default : no limit).\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int nThreads = 4;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<4) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	memset(&selection, 0, sizeof(selection));
+	selection.anyClass = 1;
+	selection.copyPrefix = "copy-";
+	today = dateBefore(0);
+	if(strcmp((const char*)argv[3], "destroy")==0)
+		action = ACTION_DESTROY;
+	else if(strcmp((const char*)argv[3], "copy")==0)
+		action = ACTION_COPY;
+	else if(strcmp((const char*)argv[3], "list")!=0)
+	{
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	for(int ctr=4; ctr<argc; ctr++)
+	{
+		if(!parseOption((const char*)argv[ctr], &nThreads))
+		{
+			printf("\nUnknown option : %s\n", (const char*)argv[ctr]);
+			usage((char*)argv[0]);
+			exit(1);
+		}
+	}
+	if(action==ACTION_DESTROY && !hasCriterion() && !selection.all)
+	{
+		printf("\ndestroy without a selection criterion would destroy every object. Add the all option to confirm.\n");
+		exit(1);
+	}
+	if(nThreads<1)
+		nThreads = 1;
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+	findObjects();
+	runHousekeeping(nThreads);
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,548 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2024 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+        OBJECTIVE :
+	- This sample demonstrates how to sign files of any size with ML-DSA while sending only 64 bytes to the HSM per file.
+	- The message representative mu is computed on the host, as defined in FIPS 204 :-
+		> tr = SHAKE256(public_key, 64)
+		> mu = SHAKE256(tr || 0x00 || 0x00 || message, 64)  (pure ML-DSA with an empty context)
+	- Files are read and absorbed into SHAKE256 in 1 MB chunks, so memory usage does not depend on file size.
+	- mu is then signed using the CKM_EXTMU_ML_DSA mechanism. The signature is written to <file>.sig.
+	- The resulting signature is a regular ML-DSA signature and can be verified using CKM_ML_DSA with an empty context.
+	- Multiple files are processed in parallel. Each thread hashes one file at a time and signs with its own session.
+	- The ML-DSA keypair must exist on the partition as <LABEL>-prvkey and <LABEL>-pubkey (see CKM_ML_DSA_KEY_PAIR_GEN_demo.c).
+*/
+
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+#define SHAKE256_RATE 136 // Bytes absorbed per Keccak permutation.
+#define MU_LEN 64
+#define READ_CHUNK_SIZE (1024*1024)
+
+
+// SHAKE256 state.
+typedef struct
+{
+	uint64_t state[25];
+	unsigned int pos; // Number of bytes absorbed into the current block.
+} SHAKE256_CTX;
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+char *privKeyLabel = NULL;
+char *pubKeyLabel = NULL;
+CK_OBJECT_HANDLE objPubkey = 0; // Handle number of the public key.
+CK_OBJECT_HANDLE objPrikey = 0; // Handle number of the private key.
+CK_BYTE tr[MU_LEN]; // SHAKE256 of the public key, computed once.
+
+char **fileNames = NULL;
+int fileCount = 0;
+int nextFile = 0; // Index of the next file to be signed.
+int nThreads = 0;
+int signedCount = 0;
+unsigned long long bytesHashed = 0;
+pthread_mutex_t fileLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// Keccak-f[1600] round constants.
+static const uint64_t keccakRoundConstants[24] =
+{
+	0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+	0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+	0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+	0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+	0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+	0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+static const int keccakRotations[24] = {1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44};
+static const int keccakPiLanes[24] = {10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1};
+
+#define ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+
+
+// Keccak-f[1600] permutation.
+static void keccakF1600(uint64_t st[25])
+{
+	uint64_t bc[5], t;
+
+	for(int round=0; round<24; round++)
+	{
+		// Theta
+		for(int i=0; i<5; i++)
+			bc[i] = st[i] ^ st[i+5] ^ st[i+10] ^ st[i+15] ^ st[i+20];
+		for(int i=0; i<5; i++)
+		{
+			t = bc[(i+4)%5] ^ ROTL64(bc[(i+1)%5], 1);
+			for(int j=0; j<25; j+=5)
+				st[j+i] ^= t;
+		}
+
+		// Rho and Pi
+		t = st[1];
+		for(int i=0; i<24; i++)
+		{
+			int j = keccakPiLanes[i];
+			bc[0] = st[j];
+			st[j] = ROTL64(t, keccakRotations[i]);
+			t = bc[0];
+		}
+
+		// Chi
+		for(int j=0; j<25; j+=5)
+		{
+			for(int i=0; i<5; i++)
+				bc[i] = st[j+i];
+			for(int i=0; i<5; i++)
+				st[j+i] ^= (~bc[(i+1)%5]) & bc[(i+2)%5];
+		}
+
+		// Iota
+		st[0] ^= keccakRoundConstants[round];
+	}
+}
+
+
+
+// Reads a 64-bit little-endian lane.
+static uint64_t loadLane(const CK_BYTE *in)
+{
+	uint64_t lane = 0;
+	for(int i=7; i>=0; i--)
+		lane = (lane << 8) | in[i];
+	return lane;
+}
+
+
+
+void shake256Init(SHAKE256_CTX *ctx)
+{
+	memset(ctx, 0, sizeof(SHAKE256_CTX));
+}
+
+
+
+// Absorbs data into the SHAKE256 state. Full blocks are absorbed a lane at a time.
+void shake256Update(SHAKE256_CTX *ctx, const CK_BYTE *data, size_t len)
+{
+	while(len>0)
+	{
+		if(ctx->pos==0 && len>=SHAKE256_RATE)
+		{
+			for(int i=0; i<SHAKE256_RATE/8; i++)
+				ctx->state[i] ^= loadLane(data + (i*8));
+			keccakF1600(ctx->state);
+			data += SHAKE256_RATE;
+			len -= SHAKE256_RATE;
+			continue;
+		}
+
+		ctx->state[ctx->pos/8] ^= (uint64_t)(*data) << (8 * (ctx->pos%8));
+		ctx->pos++;
+		data++;
+		len--;
+		if(ctx->pos==SHAKE256_RATE)
+		{
+			keccakF1600(ctx->state);
+			ctx->pos = 0;
+		}
+	}
+}
+
+
+
+// Pads the input and squeezes outLen bytes (outLen must not exceed SHAKE256_RATE).
+void shake256Final(SHAKE256_CTX *ctx, CK_BYTE *out, size_t outLen)
+{
+	ctx->state[ctx->pos/8] ^= (uint64_t)0x1F << (8 * (ctx->pos%8));
+	ctx->state[(SHAKE256_RATE-1)/8] ^= (uint64_t)0x80 << (8 * ((SHAKE256_RATE-1)%8));
+	keccakF1600(ctx->state);
+	for(size_t i=0; i<outLen; i++)
+		out[i] = (CK_BYTE)(ctx->state[i/8] >> (8 * (i%8)));
+}
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+	CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+	char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+	if(libPath==NULL)
+	{
+		printf("P11_LIB environment variable not set.\n");
+		printf("\n > On Unix/Linux :-\n");
+		printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\n > On Windows :-\n");
+		printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\nExample :-");
+		printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+		printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+		exit(1);
+	}
+
+
+	#ifdef OS_UNIX
+		libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+	#else
+		libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+	#endif
+	if(!libHandle)
+	{
+		printf("Failed to load Luna library from path : %s\n", libPath);
+		exit(1);
+	}
+
+
+	#ifdef OS_UNIX
+	    C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+	#else
+		C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+	#endif
+
+	C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+	if(p11Func==NULL)
+	{
+		printf("Failed to load P11 functions.\n");
+		exit(1);
+	}
+
+	printf ("\n> P11 library loaded.\n");
+	printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+	free(slotPin);
+	free(privKeyLabel);
+	free(pubKeyLabel);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char exeName[30])
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <ML-DSA_keypair_label> <number_of_threads> <file> [file ...]\n\n", exeName);
+}
+
+
+
+// Finds a key by its class and label.
+CK_OBJECT_HANDLE findKey(CK_OBJECT_CLASS objClass, const char *label)
+{
+	CK_OBJECT_HANDLE handle = 0;
+	CK_ULONG objCount = 0;
+	CK_KEY_TYPE keyType = CKK_ML_DSA;
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_CLASS,	&objClass,	sizeof(CK_OBJECT_CLASS)},
+		{CKA_KEY_TYPE,	&keyType,	sizeof(CK_KEY_TYPE)},
+		{CKA_LABEL,	(CK_VOID_PTR)label,	strlen(label)}
+	};
+
+	checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, 3), "C_FindObjectsInit");
+	checkOperation(p11Func->C_FindObjects(hSession, &handle, 1, &objCount), "C_FindObjects");
+	checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+	if(objCount==0)
+	{
+		printf("\nKey [ %s ] not found.\n", label);
+		disconnectFromLunaSlot();
+		freeMem();
+		exit(1);
+	}
+	return handle;
+}
+
+
+
+// Finds the ML-DSA keypair and computes tr from the public key.
+void loadSigningKey()
+{
+	SHAKE256_CTX ctx;
+	CK_BYTE *pubKey = NULL;
+	CK_ATTRIBUTE attrib[] = {{CKA_VALUE, NULL, 0}};
+
+	objPrikey = findKey(CKO_PRIVATE_KEY, privKeyLabel);
+	objPubkey = findKey(CKO_PUBLIC_KEY, pubKeyLabel);
+
+	checkOperation(p11Func->C_GetAttributeValue(hSession, objPubkey, attrib, 1), "C_GetAttributeValue");
+	pubKey = (CK_BYTE*)malloc(attrib[0].ulValueLen);
+	attrib[0].pValue = pubKey;
+	checkOperation(p11Func->C_GetAttributeValue(hSession, objPubkey, attrib, 1), "C_GetAttributeValue");
+
+	shake256Init(&ctx);
+	shake256Update(&ctx, pubKey, attrib[0].ulValueLen);
+	shake256Final(&ctx, tr, sizeof(tr));
+	free(pubKey);
+
+	printf("\n> ML-DSA keypair found.\n");
+	printf("  --> Private key handle : %lu\n", objPrikey);
+	printf("  --> Public key handle : %lu\n", objPubkey);
+	printf("  --> Public key size : %lu bytes.\n", attrib[0].ulValueLen);
+}
+
+
+
+// Computes mu for a file. Returns the number of bytes read or -1 if the file can't be read.
+// fread also stops on a read error, so ferror is checked; a partly read file must not be signed.
+long long computeMu(const char *fileName, CK_BYTE *buffer, CK_BYTE *mu)
+{
+	SHAKE256_CTX ctx;
+	CK_BYTE domain[2] = {0x00, 0x00}; // Pure ML-DSA, context length 0.
+	long long total = 0;
+	size_t readLen = 0;
+	FILE *fp = fopen(fileName, "rb");
+
+	if(fp==NULL)
+		return -1;
+
+	shake256Init(&ctx);
+	shake256Update(&ctx, tr, sizeof(tr));
+	shake256Update(&ctx, domain, sizeof(domain));
+	while((readLen = fread(buffer, 1, READ_CHUNK_SIZE, fp))>0)
+	{
+		shake256Update(&ctx, buffer, readLen);
+		total += readLen;
+	}
+	if(ferror(fp))
+	{
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+	shake256Final(&ctx, mu, MU_LEN);
+	return total;
+}
+
+
+
+// Writes a signature to <file>.sig
+int writeSignature(const char *fileName, CK_BYTE *signature, CK_ULONG signatureLen)
+{
+	char *sigFileName = (char*)malloc(strlen(fileName)+5);
+	FILE *fp = NULL;
+	int ok = 0;
+
+	sprintf(sigFileName, "%s.sig", fileName);
+	fp = fopen(sigFileName, "wb");
+	if(fp!=NULL)
+	{
+		ok = (fwrite(signature, 1, signatureLen, fp)==signatureLen);
+		fclose(fp);
+	}
+	free(sigFileName);
+	return ok;
+}
+
+
+
+// Thread function; hashes and signs files until none are left.
+void *signFiles(void *arg)
+{
+	CK_SESSION_HANDLE hChildSession = 0;
+	CK_HASH_SIGN_ADDITIONAL_CONTEXT additionalContext;
+	CK_MECHANISM mech = {CKM_EXTMU_ML_DSA, &additionalContext, sizeof(additionalContext)};
+	CK_BYTE *buffer = (CK_BYTE*)malloc(READ_CHUNK_SIZE);
+	CK_BYTE mu[MU_LEN];
+	CK_BYTE signature[8192];
+	CK_ULONG signatureLen = 0;
+	CK_RV rv = CKR_OK;
+	long long fileSize = 0;
+	int index = 0;
+
+	additionalContext.hedgeVariant = CKH_HEDGE_PREFERRED;
+	additionalContext.pContext = NULL;
+	additionalContext.ulContextLen = 0;
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hChildSession), "C_OpenSession");
+	while(1)
+	{
+		pthread_mutex_lock(&fileLock);
+		index = nextFile++;
+		pthread_mutex_unlock(&fileLock);
+		if(index>=fileCount)
+			break;
+
+		fileSize = computeMu(fileNames[index], buffer, mu);
+		if(fileSize<0)
+		{
+			printf("  --> %s : cannot be read.\n", fileNames[index]);
+			continue;
+		}
+
+		signatureLen = sizeof(signature);
+		rv = p11Func->C_SignInit(hChildSession, &mech, objPrikey);
+		if(rv==CKR_OK)
+			rv = p11Func->C_Sign(hChildSession, mu, sizeof(mu), signature, &signatureLen);
+		if(rv!=CKR_OK)
+		{
+			printf("  --> %s : C_Sign failed with Ox%lX\n", fileNames[index], rv);
+			continue;
+		}
+
+		if(!writeSignature(fileNames[index], signature, signatureLen))
+		{
+			printf("  --> %s : failed to write signature.\n", fileNames[index]);
+			continue;
+		}
+
+		pthread_mutex_lock(&fileLock);
+		signedCount++;
+		bytesHashed += fileSize;
+		pthread_mutex_unlock(&fileLock);
+	}
+
+	checkOperation(p11Func->C_CloseSession(hChildSession), "C_CloseSession");
+	free(buffer);
+	return 0;
+}
+
+
+
+// Starts the signing threads and reports the throughput.
+void signAllFiles()
+{
+	pthread_t *workers = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	struct timespec start, end;
+	double elapsed = 0;
+
+	printf("\n> Signing %d files using %d threads.\n", fileCount, nThreads);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&workers[ctr], NULL, &signFiles, NULL);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(workers[ctr], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	free(workers);
+
+	elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("\n> %d of %d files signed.\n", signedCount, fileCount);
+	printf("  --> Bytes hashed on host : %llu\n", bytesHashed);
+	printf("  --> Bytes sent to HSM : %d\n", signedCount * MU_LEN);
+	printf("  --> Time taken : %.3f seconds.\n", elapsed);
+	if(elapsed>0)
+	{
+		printf("  --> Signatures per second : %.1f\n", signedCount / elapsed);
+		printf("  --> Hashing throughput : %.1f MB/s\n", (bytesHashed / (1024.0*1024.0)) / elapsed);
+	}
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int labelLen = 0;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<6) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+
+	labelLen = strlen((const char*)argv[3]) + 8;
+	privKeyLabel = (char*)malloc(labelLen);
+	snprintf(privKeyLabel, labelLen, "%s-prvkey", (char*)argv[3]);
+	pubKeyLabel = (char*)malloc(labelLen);
+	snprintf(pubKeyLabel, labelLen, "%s-pubkey", (char*)argv[3]);
+
+	nThreads = atoi((const char*)argv[4]);
+	if(nThreads<1)
+		nThreads = 1;
+	fileNames = (char**)&argv[5];
+	fileCount = argc - 5;
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+	loadSigningKey();
+	signAllFiles();
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
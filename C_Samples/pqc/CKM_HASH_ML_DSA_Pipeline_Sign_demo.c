@@ -0,0 +1,792 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2024 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+        OBJECTIVE :
+	- This sample demonstrates how to sign a batch of large files with HashML-DSA (CKM_HASH_ML_DSA).
+	- The files to sign are listed in a manifest file, one path per line.
+	- Files are pre-hashed on the host in 1 MB chunks using SHA-256, SHA-384, SHA-512, SHA3-256 or SHA3-512.
+	- Hashing and signing run as a pipeline :-
+		> Hasher threads read and hash files, and place the digests in a bounded queue.
+		> Signer threads, each with its own session, take digests from the queue and sign them on the HSM.
+		> While one file is being signed on the HSM, the next files are already being hashed on the host.
+	- The signature of each file is written to <file>.sig.
+	- The ML-DSA keypair must exist on the partition as <LABEL>-prvkey and <LABEL>-pubkey (see CKM_ML_DSA_KEY_PAIR_GEN_demo.c).
+*/
+
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+#define READ_CHUNK_SIZE (1024*1024)
+#define MAX_DIGEST_LEN 64
+#define MAX_PATH_LEN 1024
+
+#define HASH_SHA2_256 0
+#define HASH_SHA2_512 1
+#define HASH_SHA3 2
+
+
+// Hash algorithms supported by this sample.
+typedef struct
+{
+	const char *name;
+	CK_MECHANISM_TYPE mechanism; // Value of the hash field of CK_HASH_SIGN_ADDITIONAL_CONTEXT.
+	int family;
+	CK_ULONG digestLen;
+} HASH_ALGORITHM;
+
+HASH_ALGORITHM hashAlgorithms[] =
+{
+	{"sha256",	CKM_SHA256,	HASH_SHA2_256,	32},
+	{"sha384",	CKM_SHA384,	HASH_SHA2_512,	48},
+	{"sha512",	CKM_SHA512,	HASH_SHA2_512,	64},
+	{"sha3-256",	CKM_SHA3_256,	HASH_SHA3,	32},
+	{"sha3-512",	CKM_SHA3_512,	HASH_SHA3,	64}
+};
+#define HASH_ALGORITHM_COUNT (sizeof(hashAlgorithms)/sizeof(*hashAlgorithms))
+
+
+// Host-side hash state.
+typedef struct
+{
+	HASH_ALGORITHM *alg;
+	union
+	{
+		uint32_t h32[8]; // SHA-256
+		uint64_t h64[8]; // SHA-384 and SHA-512
+		uint64_t keccak[25]; // SHA3
+	} state;
+	CK_BYTE block[144]; // Partially filled input block.
+	unsigned int blockSize;
+	unsigned int pos; // Number of bytes in block.
+	uint64_t totalLen; // Number of bytes hashed so far.
+} HOST_HASH_CTX;
+
+
+// A hashed file waiting to be signed.
+typedef struct
+{
+	char *fileName;
+	CK_BYTE digest[MAX_DIGEST_LEN];
+} SIGN_JOB;
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+char *privKeyLabel = NULL;
+CK_OBJECT_HANDLE objPrikey = 0; // Handle number of the private key.
+HASH_ALGORITHM *hashAlg = NULL;
+
+char **fileNames = NULL; // Files listed in the manifest.
+int fileCount = 0;
+int nextFile = 0; // Index of the next file to hash.
+int hashThreads = 0;
+int signThreads = 0;
+int signedCount = 0;
+unsigned long long bytesHashed = 0;
+pthread_mutex_t manifestLock = PTHREAD_MUTEX_INITIALIZER;
+
+// Bounded queue between the hasher threads and the signer threads.
+SIGN_JOB *queue = NULL;
+int queueCapacity = 0;
+int queueHead = 0;
+int queueCount = 0;
+int activeHashers = 0;
+pthread_mutex_t queueLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t queueNotEmpty = PTHREAD_COND_INITIALIZER;
+pthread_cond_t queueNotFull = PTHREAD_COND_INITIALIZER;
+
+
+
+// SHA-256 round constants.
+static const uint32_t sha256K[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// SHA-512 round constants.
+static const uint64_t sha512K[80] =
+{
+	0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL,
+	0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL, 0x12835b0145706fbeULL,
+	0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL, 0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+	0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+	0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL, 0x983e5152ee66dfabULL,
+	0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+	0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL,
+	0x53380d139d95b3dfULL, 0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+	0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL, 0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL,
+	0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL,
+	0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+	0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL, 0xca273eceea26619cULL,
+	0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL,
+	0x113f9804bef90daeULL, 0x1b710b35131c471bULL, 0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+	0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+// Keccak-f[1600] constants.
+static const uint64_t keccakRoundConstants[24] =
+{
+	0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+	0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+	0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+	0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+	0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+	0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+static const int keccakRotations[24] = {1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44};
+static const int keccakPiLanes[24] = {10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1};
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+#define ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+
+
+// SHA-256 compression function.
+static void sha256Block(uint32_t h[8], const CK_BYTE *block)
+{
+	uint32_t w[64], a, b, c, d, e, f, g, k, t1, t2;
+
+	for(int i=0; i<16; i++)
+		w[i] = ((uint32_t)block[i*4] << 24) | ((uint32_t)block[i*4+1] << 16) | ((uint32_t)block[i*4+2] << 8) | block[i*4+3];
+	for(int i=16; i<64; i++)
+	{
+		uint32_t s0 = ROTR32(w[i-15], 7) ^ ROTR32(w[i-15], 18) ^ (w[i-15] >> 3);
+		uint32_t s1 = ROTR32(w[i-2], 17) ^ ROTR32(w[i-2], 19) ^ (w[i-2] >> 10);
+		w[i] = w[i-16] + s0 + w[i-7] + s1;
+	}
+
+	a = h[0]; b = h[1]; c = h[2]; d = h[3]; e = h[4]; f = h[5]; g = h[6]; k = h[7];
+	for(int i=0; i<64; i++)
+	{
+		t1 = k + (ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25)) + ((e & f) ^ (~e & g)) + sha256K[i] + w[i];
+		t2 = (ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+		k = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+	}
+	h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+}
+
+
+
+// SHA-512 compression function.
+static void sha512Block(uint64_t h[8], const CK_BYTE *block)
+{
+	uint64_t w[80], a, b, c, d, e, f, g, k, t1, t2;
+
+	for(int i=0; i<16; i++)
+	{
+		w[i] = 0;
+		for(int j=0; j<8; j++)
+			w[i] = (w[i] << 8) | block[i*8+j];
+	}
+	for(int i=16; i<80; i++)
+	{
+		uint64_t s0 = ROTR64(w[i-15], 1) ^ ROTR64(w[i-15], 8) ^ (w[i-15] >> 7);
+		uint64_t s1 = ROTR64(w[i-2], 19) ^ ROTR64(w[i-2], 61) ^ (w[i-2] >> 6);
+		w[i] = w[i-16] + s0 + w[i-7] + s1;
+	}
+
+	a = h[0]; b = h[1]; c = h[2]; d = h[3]; e = h[4]; f = h[5]; g = h[6]; k = h[7];
+	for(int i=0; i<80; i++)
+	{
+		t1 = k + (ROTR64(e, 14) ^ ROTR64(e, 18) ^ ROTR64(e, 41)) + ((e & f) ^ (~e & g)) + sha512K[i] + w[i];
+		t2 = (ROTR64(a, 28) ^ ROTR64(a, 34) ^ ROTR64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+		k = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+	}
+	h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+}
+
+
+
+// Keccak-f[1600] permutation.
+static void keccakF1600(uint64_t st[25])
+{
+	uint64_t bc[5], t;
+
+	for(int round=0; round<24; round++)
+	{
+		for(int i=0; i<5; i++)
+			bc[i] = st[i] ^ st[i+5] ^ st[i+10] ^ st[i+15] ^ st[i+20];
+		for(int i=0; i<5; i++)
+		{
+			t = bc[(i+4)%5] ^ ROTL64(bc[(i+1)%5], 1);
+			for(int j=0; j<25; j+=5)
+				st[j+i] ^= t;
+		}
+
+		t = st[1];
+		for(int i=0; i<24; i++)
+		{
+			int j = keccakPiLanes[i];
+			bc[0] = st[j];
+			st[j] = ROTL64(t, keccakRotations[i]);
+			t = bc[0];
+		}
+
+		for(int j=0; j<25; j+=5)
+		{
+			for(int i=0; i<5; i++)
+				bc[i] = st[j+i];
+			for(int i=0; i<5; i++)
+				st[j+i] ^= (~bc[(i+1)%5]) & bc[(i+2)%5];
+		}
+
+		st[0] ^= keccakRoundConstants[round];
+	}
+}
+
+
+
+// XORs one input block into the Keccak state and applies the permutation.
+static void sha3Block(uint64_t st[25], const CK_BYTE *block, unsigned int blockSize)
+{
+	for(unsigned int i=0; i<blockSize/8; i++)
+	{
+		uint64_t lane = 0;
+		for(int j=7; j>=0; j--)
+			lane = (lane << 8) | block[i*8+j];
+		st[i] ^= lane;
+	}
+	keccakF1600(st);
+}
+
+
+
+// Processes one complete input block.
+static void hostHashBlock(HOST_HASH_CTX *ctx, const CK_BYTE *block)
+{
+	switch(ctx->alg->family)
+	{
+		case HASH_SHA2_256: sha256Block(ctx->state.h32, block); break;
+		case HASH_SHA2_512: sha512Block(ctx->state.h64, block); break;
+		default: sha3Block(ctx->state.keccak, block, ctx->blockSize); break;
+	}
+}
+
+
+
+void hostHashInit(HOST_HASH_CTX *ctx, HASH_ALGORITHM *alg)
+{
+	static const uint32_t sha256IV[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+	static const uint64_t sha384IV[8] = {0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+					     0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL};
+	static const uint64_t sha512IV[8] = {0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+					     0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL};
+
+	memset(ctx, 0, sizeof(HOST_HASH_CTX));
+	ctx->alg = alg;
+	switch(alg->family)
+	{
+		case HASH_SHA2_256:
+			memcpy(ctx->state.h32, sha256IV, sizeof(sha256IV));
+			ctx->blockSize = 64;
+			break;
+		case HASH_SHA2_512:
+			memcpy(ctx->state.h64, alg->digestLen==48 ? sha384IV : sha512IV, sizeof(sha512IV));
+			ctx->blockSize = 128;
+			break;
+		default:
+			ctx->blockSize = 200 - 2 * alg->digestLen; // SHA3 rate.
+			break;
+	}
+}
+
+
+
+// Hashes data. Complete blocks are processed directly from the input without being copied.
+void hostHashUpdate(HOST_HASH_CTX *ctx, const CK_BYTE *data, size_t len)
+{
+	ctx->totalLen += len;
+
+	if(ctx->pos>0)
+	{
+		size_t fill = ctx->blockSize - ctx->pos;
+		if(fill>len)
+			fill = len;
+		memcpy(ctx->block + ctx->pos, data, fill);
+		ctx->pos += fill;
+		data += fill;
+		len -= fill;
+		if(ctx->pos<ctx->blockSize)
+			return;
+		hostHashBlock(ctx, ctx->block);
+		ctx->pos = 0;
+	}
+
+	while(len>=ctx->blockSize)
+	{
+		hostHashBlock(ctx, data);
+		data += ctx->blockSize;
+		len -= ctx->blockSize;
+	}
+
+	memcpy(ctx->block, data, len);
+	ctx->pos = len;
+}
+
+
+
+// Applies padding and writes the digest.
+void hostHashFinal(HOST_HASH_CTX *ctx, CK_BYTE *digest)
+{
+	unsigned int lenField = (ctx->alg->family==HASH_SHA2_256) ? 8 : 16;
+	uint64_t bitLen = ctx->totalLen * 8;
+
+	if(ctx->alg->family==HASH_SHA3)
+	{
+		memset(ctx->block + ctx->pos, 0, ctx->blockSize - ctx->pos);
+		ctx->block[ctx->pos] ^= 0x06;
+		ctx->block[ctx->blockSize-1] ^= 0x80;
+		hostHashBlock(ctx, ctx->block);
+		for(CK_ULONG i=0; i<ctx->alg->digestLen; i++)
+			digest[i] = (CK_BYTE)(ctx->state.keccak[i/8] >> (8 * (i%8)));
+		return;
+	}
+
+	ctx->block[ctx->pos++] = 0x80;
+	if(ctx->pos > ctx->blockSize - lenField)
+	{
+		memset(ctx->block + ctx->pos, 0, ctx->blockSize - ctx->pos);
+		hostHashBlock(ctx, ctx->block);
+		ctx->pos = 0;
+	}
+	memset(ctx->block + ctx->pos, 0, ctx->blockSize - ctx->pos);
+	for(int i=0; i<8; i++)
+		ctx->block[ctx->blockSize-1-i] = (CK_BYTE)(bitLen >> (8*i));
+	hostHashBlock(ctx, ctx->block);
+
+	for(CK_ULONG i=0; i<ctx->alg->digestLen; i++)
+	{
+		if(ctx->alg->family==HASH_SHA2_256)
+			digest[i] = (CK_BYTE)(ctx->state.h32[i/4] >> (24 - 8*(i%4)));
+		else
+			digest[i] = (CK_BYTE)(ctx->state.h64[i/8] >> (56 - 8*(i%8)));
+	}
+}
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+	CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+	char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+	if(libPath==NULL)
+	{
+		printf("P11_LIB environment variable not set.\n");
+		printf("\n > On Unix/Linux :-\n");
+		printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\n > On Windows :-\n");
+		printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\nExample :-");
+		printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+		printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+		exit(1);
+	}
+
+
+	#ifdef OS_UNIX
+		libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+	#else
+		libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+	#endif
+	if(!libHandle)
+	{
+		printf("Failed to load Luna library from path : %s\n", libPath);
+		exit(1);
+	}
+
+
+	#ifdef OS_UNIX
+	    C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+	#else
+		C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+	#endif
+
+	C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+	if(p11Func==NULL)
+	{
+		printf("Failed to load P11 functions.\n");
+		exit(1);
+	}
+
+	printf ("\n> P11 library loaded.\n");
+	printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+	for(int ctr=0; ctr<fileCount; ctr++)
+		free(fileNames[ctr]);
+	free(fileNames);
+	free(queue);
+	free(slotPin);
+	free(privKeyLabel);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char exeName[30])
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <ML-DSA_keypair_label> <hash> <manifest_file> <hash_threads> <sign_threads>\n\n", exeName);
+	printf("<hash> : sha256, sha384, sha512, sha3-256 or sha3-512.\n\n");
+}
+
+
+
+// Reads the list of files to sign.
+void loadManifest(const char *manifest)
+{
+	char line[MAX_PATH_LEN];
+	int capacity = 256;
+	FILE *fp = fopen(manifest, "r");
+
+	if(fp==NULL)
+	{
+		printf("Failed to open %s.\n", manifest);
+		exit(1);
+	}
+
+	fileNames = (char**)malloc(capacity * sizeof(char*));
+	while(fgets(line, sizeof(line), fp)!=NULL)
+	{
+		line[strcspn(line, "\r\n")] = '\0';
+		if(line[0]=='\0')
+			continue;
+		if(fileCount==capacity)
+		{
+			capacity *= 2;
+			fileNames = (char**)realloc(fileNames, capacity * sizeof(char*));
+		}
+		fileNames[fileCount++] = strdup(line);
+	}
+	fclose(fp);
+	printf("\n> %d files listed in %s.\n", fileCount, manifest);
+}
+
+
+
+// Finds the ML-DSA private key.
+void loadSigningKey()
+{
+	CK_OBJECT_CLASS objClass = CKO_PRIVATE_KEY;
+	CK_KEY_TYPE keyType = CKK_ML_DSA;
+	CK_ULONG objCount = 0;
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_CLASS,	&objClass,	sizeof(CK_OBJECT_CLASS)},
+		{CKA_KEY_TYPE,	&keyType,	sizeof(CK_KEY_TYPE)},
+		{CKA_LABEL,	privKeyLabel,	strlen(privKeyLabel)}
+	};
+
+	checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, 3), "C_FindObjectsInit");
+	checkOperation(p11Func->C_FindObjects(hSession, &objPrikey, 1, &objCount), "C_FindObjects");
+	checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+	if(objCount==0)
+	{
+		printf("\nKey [ %s ] not found.\n", privKeyLabel);
+		disconnectFromLunaSlot();
+		freeMem();
+		exit(1);
+	}
+	printf("\n> ML-DSA private key found. Handle : %lu\n", objPrikey);
+}
+
+
+
+// Hasher thread; hashes files from the manifest and places the digests in the queue.
+void *hashFiles(void *arg)
+{
+	CK_BYTE *buffer = (CK_BYTE*)malloc(READ_CHUNK_SIZE);
+	HOST_HASH_CTX ctx;
+	SIGN_JOB job;
+	size_t readLen = 0;
+	FILE *fp = NULL;
+	int index = 0;
+
+	while(1)
+	{
+		pthread_mutex_lock(&manifestLock);
+		index = nextFile++;
+		pthread_mutex_unlock(&manifestLock);
+		if(index>=fileCount)
+			break;
+
+		fp = fopen(fileNames[index], "rb");
+		if(fp==NULL)
+		{
+			printf("  --> %s : cannot be read.\n", fileNames[index]);
+			continue;
+		}
+		hostHashInit(&ctx, hashAlg);
+		while((readLen = fread(buffer, 1, READ_CHUNK_SIZE, fp))>0)
+			hostHashUpdate(&ctx, buffer, readLen);
+		if(ferror(fp)) // fread stops on a read error too; the digest of a partly read file must not be signed.
+		{
+			printf("  --> %s : read error.\n", fileNames[index]);
+			fclose(fp);
+			continue;
+		}
+		fclose(fp);
+
+		job.fileName = fileNames[index];
+		hostHashFinal(&ctx, job.digest);
+
+		pthread_mutex_lock(&queueLock);
+		while(queueCount==queueCapacity)
+			pthread_cond_wait(&queueNotFull, &queueLock);
+		queue[(queueHead + queueCount) % queueCapacity] = job;
+		queueCount++;
+		bytesHashed += ctx.totalLen;
+		pthread_cond_signal(&queueNotEmpty);
+		pthread_mutex_unlock(&queueLock);
+	}
+
+	// Wakes up every signer once the last hasher is done, so that they can exit.
+	pthread_mutex_lock(&queueLock);
+	activeHashers--;
+	pthread_cond_broadcast(&queueNotEmpty);
+	pthread_mutex_unlock(&queueLock);
+	free(buffer);
+	return 0;
+}
+
+
+
+// Signer thread; signs digests from the queue until the queue is empty and every hasher is done.
+void *signDigests(void *arg)
+{
+	CK_SESSION_HANDLE hChildSession = 0;
+	CK_HASH_SIGN_ADDITIONAL_CONTEXT additionalContext;
+	CK_MECHANISM mech = {CKM_HASH_ML_DSA, &additionalContext, sizeof(additionalContext)};
+	CK_BYTE signature[8192];
+	CK_ULONG signatureLen = 0;
+	char sigFileName[MAX_PATH_LEN + 5];
+	SIGN_JOB job;
+	CK_RV rv = CKR_OK;
+	FILE *fp = NULL;
+
+	additionalContext.hedgeVariant = CKH_HEDGE_PREFERRED;
+	additionalContext.pContext = NULL;
+	additionalContext.ulContextLen = 0;
+	additionalContext.hash = hashAlg->mechanism;
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hChildSession), "C_OpenSession");
+	while(1)
+	{
+		pthread_mutex_lock(&queueLock);
+		while(queueCount==0 && activeHashers>0)
+			pthread_cond_wait(&queueNotEmpty, &queueLock);
+		if(queueCount==0)
+		{
+			pthread_mutex_unlock(&queueLock);
+			break;
+		}
+		job = queue[queueHead];
+		queueHead = (queueHead + 1) % queueCapacity;
+		queueCount--;
+		pthread_cond_signal(&queueNotFull);
+		pthread_mutex_unlock(&queueLock);
+
+		signatureLen = sizeof(signature);
+		rv = p11Func->C_SignInit(hChildSession, &mech, objPrikey);
+		if(rv==CKR_OK)
+			rv = p11Func->C_Sign(hChildSession, job.digest, hashAlg->digestLen, signature, &signatureLen);
+		if(rv!=CKR_OK)
+		{
+			printf("  --> %s : C_Sign failed with Ox%lX\n", job.fileName, rv);
+			continue;
+		}
+
+		snprintf(sigFileName, sizeof(sigFileName), "%s.sig", job.fileName);
+		fp = fopen(sigFileName, "wb");
+		if(fp==NULL || fwrite(signature, 1, signatureLen, fp)!=signatureLen)
+			printf("  --> %s : failed to write signature.\n", sigFileName);
+		else
+		{
+			pthread_mutex_lock(&queueLock);
+			signedCount++;
+			pthread_mutex_unlock(&queueLock);
+		}
+		if(fp!=NULL)
+			fclose(fp);
+	}
+
+	checkOperation(p11Func->C_CloseSession(hChildSession), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Starts the hasher and signer threads and reports the throughput.
+void signManifest()
+{
+	pthread_t *hashers = (pthread_t*)malloc(hashThreads * sizeof(pthread_t));
+	pthread_t *signers = (pthread_t*)malloc(signThreads * sizeof(pthread_t));
+	struct timespec start, end;
+	double elapsed = 0;
+
+	queueCapacity = 2 * signThreads;
+	queue = (SIGN_JOB*)malloc(queueCapacity * sizeof(SIGN_JOB));
+	activeHashers = hashThreads;
+
+	printf("\n> Signing with HashML-DSA (%s) using %d hasher and %d signer threads.\n", hashAlg->name, hashThreads, signThreads);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<signThreads; ctr++)
+		pthread_create(&signers[ctr], NULL, &signDigests, NULL);
+	for(int ctr=0; ctr<hashThreads; ctr++)
+		pthread_create(&hashers[ctr], NULL, &hashFiles, NULL);
+
+	for(int ctr=0; ctr<hashThreads; ctr++)
+		pthread_join(hashers[ctr], NULL);
+	for(int ctr=0; ctr<signThreads; ctr++)
+		pthread_join(signers[ctr], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	free(hashers);
+	free(signers);
+
+	elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("\n> %d of %d files signed.\n", signedCount, fileCount);
+	printf("  --> Bytes hashed on host : %llu\n", bytesHashed);
+	printf("  --> Time taken : %.3f seconds.\n", elapsed);
+	if(elapsed>0)
+	{
+		printf("  --> Signatures per second : %.1f\n", signedCount / elapsed);
+		printf("  --> Hashing throughput : %.1f MB/s\n", (bytesHashed / (1024.0*1024.0)) / elapsed);
+	}
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int labelLen = 0;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<8) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+
+	labelLen = strlen((const char*)argv[3]) + 8;
+	privKeyLabel = (char*)malloc(labelLen);
+	snprintf(privKeyLabel, labelLen, "%s-prvkey", (char*)argv[3]);
+
+	for(int ctr=0; ctr<HASH_ALGORITHM_COUNT; ctr++)
+		if(strcmp((const char*)argv[4], hashAlgorithms[ctr].name)==0)
+			hashAlg = &hashAlgorithms[ctr];
+	if(hashAlg==NULL)
+	{
+		printf("%s is not a supported hash.\n", (char*)argv[4]);
+		usage((char*)argv[0]);
+		exit(1);
+	}
+
+	hashThreads = atoi((const char*)argv[6]);
+	signThreads = atoi((const char*)argv[7]);
+	if(hashThreads<1)
+		hashThreads = 1;
+	if(signThreads<1)
+		signThreads = 1;
+
+	loadManifest((const char*)argv[5]);
+	loadLunaLibrary();
+	connectToLunaSlot();
+	loadSigningKey();
+	signManifest();
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
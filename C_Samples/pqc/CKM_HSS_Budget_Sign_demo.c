@@ -0,0 +1,679 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to keep track of the one time signatures (leaves) left in a set of HSS keys,
+	  while signing many files from multiple threads.
+	- HSS is a stateful signature scheme, every signature consumes a leaf and a key cannot sign once all its leaves are used.
+	- The HSS keys are used in the order they are given. When the leaves left in a key reach the watermark,
+	  the sample rolls over to the next key, so a key is never exhausted in the middle of a batch.
+	- CKA_HSS_KEYS_REMAINING is read once per key at startup and once at exit, and not before every signature.
+	  In between, the budget of each key is kept in a journal file.
+	- Signer threads reserve a range of leaves from the journal, and sign until the range is used up.
+	  A reservation is written (and flushed) to the journal before it is used, so a crash can only lose unused leaves,
+	  and never reuse a leaf the journal believes is free.
+	- On startup, the journal is reconciled with CKA_HSS_KEYS_REMAINING and the lower of the two values is used.
+	- Each line of the journal is <CKA_ID in hex, or -> <leaves left> <label>; the label is the rest of the line.
+	- The signature of each file is written to a new file with the same name, appended with .sig extension.
+	- It requires Luna HSM with firmware 7.8.9 or newer, and Luna Client 10.8.0 or newer.
+*/
+
+
+
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+        #include <unistd.h> // For fsync.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+#ifndef CKR_KEY_EXHAUSTED
+	#define CKR_KEY_EXHAUSTED 0x203
+#endif
+
+#define MAX_HSS_KEYS 16
+#define MAX_LABEL_LEN 64
+#define MAX_FILE_SIZE 32768
+
+
+// Budget of one HSS key, as stored in the journal.
+typedef struct
+{
+	char label[MAX_LABEL_LEN];
+	CK_OBJECT_HANDLE handle;
+	CK_BYTE *id;
+	CK_ULONG idLen;
+	char *idHex; // CKA_ID in hex, or "-" if it is empty.
+	CK_ULONG unreserved; // Leaves left that are not reserved by a signer thread.
+	CK_ULONG signatures; // Signatures made by this run.
+	int retired; // Set once the key reaches the watermark.
+} HSS_KEY_BUDGET;
+
+
+// Range of leaves reserved by a signer thread.
+typedef struct
+{
+	int keyIndex;
+	CK_ULONG count;
+} LEAF_RESERVATION;
+
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+
+HSS_KEY_BUDGET hssKeys[MAX_HSS_KEYS];
+int hssKeyCount = 0;
+int activeKey = 0; // Key that reservations are currently taken from.
+char *journalFile = NULL;
+CK_ULONG watermark = 0; // Leaves kept unused in every key.
+CK_ULONG reservationSize = 0; // Leaves reserved by a thread at a time.
+CK_ULONG attributeReads = 0; // Number of CKA_HSS_KEYS_REMAINING reads.
+pthread_mutex_t budgetLock = PTHREAD_MUTEX_INITIALIZER;
+
+char **files = NULL; // Files to sign.
+int fileCount = 0;
+int nextFile = 0;
+int filesSigned = 0;
+int filesFailed = 0;
+pthread_mutex_t fileLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+        free(slotPin);
+        for(int ctr=0; ctr<hssKeyCount; ctr++)
+        {
+                free(hssKeys[ctr].id);
+                free(hssKeys[ctr].idHex);
+        }
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		if(rv==CKR_KEY_EXHAUSTED)
+			printf("\n%s failed with CKR_KEY_EXHAUSTED.\n\n", message);
+		else
+			printf("\n%s failed with Ox%lX\n\n",message,rv);
+
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Converts CKA_ID to a hex string.
+void idToHex(HSS_KEY_BUDGET *key)
+{
+	key->idHex = (char*)realloc(key->idHex, (key->idLen*2) + 2);
+	for(CK_ULONG ctr=0; ctr<key->idLen; ctr++)
+		sprintf(key->idHex + (ctr*2), "%02x", key->id[ctr]);
+	key->idHex[key->idLen*2] = 0;
+	if(key->idLen==0)
+		strcpy(key->idHex, "-");
+}
+
+
+
+// Writes the budget of all keys to the journal.
+// The journal is written to a temporary file and renamed, so it is either the old or the new version after a crash.
+void writeJournal()
+{
+	char tempFile[1024];
+	FILE *journal = NULL;
+
+	snprintf(tempFile, sizeof(tempFile), "%s.tmp", journalFile);
+	journal = fopen(tempFile, "w");
+	if(!journal)
+	{
+		fprintf(stderr, "Failed to write journal %s.\n", tempFile);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+
+	for(int ctr=0; ctr<hssKeyCount; ctr++)
+		fprintf(journal, "%s %lu %s\n", hssKeys[ctr].idHex, hssKeys[ctr].unreserved, hssKeys[ctr].label);
+	fflush(journal);
+	#ifdef OS_UNIX
+		fsync(fileno(journal));
+	#endif
+	fclose(journal);
+
+	#ifndef OS_UNIX
+		remove(journalFile); // rename does not replace an existing file on Windows.
+	#endif
+	if(rename(tempFile, journalFile)!=0)
+	{
+		fprintf(stderr, "Failed to update journal %s.\n", journalFile);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Reads CKA_ID and CKA_HSS_KEYS_REMAINING of a key. The length of CKA_ID is read first.
+CK_ULONG readKeysRemaining(CK_SESSION_HANDLE session, HSS_KEY_BUDGET *key)
+{
+	CK_ULONG hssKeysRemaining = 0;
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_ID,			NULL,			0},
+		{CKA_HSS_KEYS_REMAINING,	&hssKeysRemaining,	sizeof(CK_ULONG)}
+	};
+
+	checkOperation(p11Func->C_GetAttributeValue(session, key->handle, attrib, 1), "C_GetAttributeValue");
+	key->id = (CK_BYTE*)realloc(key->id, attrib[0].ulValueLen ? attrib[0].ulValueLen : 1);
+	attrib[0].pValue = key->id;
+	checkOperation(p11Func->C_GetAttributeValue(session, key->handle, attrib, 2), "C_GetAttributeValue");
+	key->idLen = attrib[0].ulValueLen;
+	idToHex(key);
+	attributeReads++;
+	return hssKeysRemaining;
+}
+
+
+
+// Reads the lowest number of leaves left for a key in the journal. Returns 0 if the key is not in the journal.
+int readJournal(HSS_KEY_BUDGET *key, CK_ULONG *journalRemaining)
+{
+	size_t lineSize = strlen(key->idHex) + strlen(key->label) + 32;
+	char *line = (char*)malloc(lineSize);
+	char *label = NULL;
+	char *end = NULL;
+	CK_ULONG remaining = 0;
+	size_t len = 0;
+	int found = 0, complete = 1;
+	FILE *journal = fopen(journalFile, "r");
+
+	while(journal && fgets(line, (int)lineSize, journal))
+	{
+		len = strlen(line);
+		if(len>0 && line[len-1]=='\n')
+			line[--len] = 0;
+		else if(!feof(journal))
+		{
+			complete = 0; // Longer than any line of this key, the rest is skipped.
+			continue;
+		}
+		if(!complete)
+		{
+			complete = 1;
+			continue;
+		}
+		if(len>0 && line[len-1]=='\r')
+			line[--len] = 0;
+
+		// <id> <leaves left> <label>
+		if((label = strchr(line, ' '))==NULL)
+			continue;
+		*label++ = 0;
+		if(strcmp(line, key->idHex)!=0)
+			continue;
+		remaining = strtoul(label, &end, 10);
+		if(end==label || *end!=' ' || strcmp(end + 1, key->label)!=0)
+			continue;
+		if(!found || remaining<*journalRemaining)
+			*journalRemaining = remaining;
+		found = 1;
+	}
+	if(journal)
+		fclose(journal);
+	free(line);
+	return found;
+}
+
+
+
+// Finds the HSS private key of each label, and reconciles it with the journal.
+void loadHSSKeys()
+{
+	CK_BBOOL yes = CK_TRUE;
+	CK_OBJECT_CLASS privateKey = CKO_PRIVATE_KEY;
+	CK_KEY_TYPE hssKey = CKK_HSS;
+	CK_ULONG objCount = 0;
+	CK_ULONG hsmRemaining = 0;
+	CK_ULONG journalRemaining = 0;
+	int found = 0;
+
+	printf("\n> Loading HSS keys.\n");
+	for(int ctr=0; ctr<hssKeyCount; ctr++)
+	{
+		HSS_KEY_BUDGET *key = &hssKeys[ctr];
+		CK_ATTRIBUTE attrib[] =
+		{
+			{CKA_TOKEN,		&yes,		sizeof(CK_BBOOL)},
+			{CKA_CLASS,		&privateKey,	sizeof(CK_OBJECT_CLASS)},
+			{CKA_KEY_TYPE,		&hssKey,	sizeof(CK_KEY_TYPE)},
+			{CKA_LABEL,		key->label,	strlen(key->label)}
+		};
+
+		checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, 4), "C_FindObjectsInit");
+		checkOperation(p11Func->C_FindObjects(hSession, &key->handle, 1, &objCount), "C_FindObjects");
+		checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+		if(objCount==0)
+		{
+			fprintf(stderr, "Signing key %s not found.\n", key->label);
+			p11Func->C_Finalize(NULL_PTR);
+			exit(1);
+		}
+
+		hsmRemaining = readKeysRemaining(hSession, key);
+		key->unreserved = hsmRemaining;
+
+		// Uses the journal value if it is lower, i.e. leaves were reserved by a previous run that did not exit cleanly.
+		found = readJournal(key, &journalRemaining);
+		if(found && journalRemaining<key->unreserved)
+			key->unreserved = journalRemaining;
+
+		printf("  --> %s [ CKA_ID %s ] : %lu leaves left on the HSM, %lu usable%s.\n",
+			key->label, key->idHex, hsmRemaining, key->unreserved, found ? "" : " (not in journal)");
+	}
+	writeJournal();
+}
+
+
+
+// Reserves a range of leaves for a signer thread.
+// Rolls over to the next key when the active key reaches the watermark. Returns 0 when all keys are used up.
+int reserveLeaves(LEAF_RESERVATION *reservation)
+{
+	HSS_KEY_BUDGET *key = NULL;
+
+	pthread_mutex_lock(&budgetLock);
+	while(activeKey<hssKeyCount)
+	{
+		key = &hssKeys[activeKey];
+		if(!key->retired && key->unreserved>watermark)
+			break;
+		if(!key->retired)
+		{
+			key->retired = 1;
+			printf("  --> %s reached the watermark (%lu leaves left), rolling over to the next key.\n", key->label, key->unreserved);
+		}
+		activeKey++;
+	}
+	if(activeKey==hssKeyCount)
+	{
+		pthread_mutex_unlock(&budgetLock);
+		return 0;
+	}
+
+	reservation->keyIndex = activeKey;
+	reservation->count = key->unreserved - watermark;
+	if(reservation->count>reservationSize)
+		reservation->count = reservationSize;
+	key->unreserved -= reservation->count;
+	writeJournal(); // The reservation is durable before any leaf of it is used.
+	pthread_mutex_unlock(&budgetLock);
+	return 1;
+}
+
+
+
+// Retires a key that returned CKR_KEY_EXHAUSTED, e.g. because it was used outside of this journal.
+void retireKey(int keyIndex)
+{
+	pthread_mutex_lock(&budgetLock);
+	if(!hssKeys[keyIndex].retired)
+		printf("  --> %s is exhausted, rolling over to the next key.\n", hssKeys[keyIndex].label);
+	hssKeys[keyIndex].retired = 1;
+	hssKeys[keyIndex].unreserved = 0;
+	writeJournal();
+	pthread_mutex_unlock(&budgetLock);
+}
+
+
+
+// Returns the next file to sign, or NULL when all files are taken.
+char *takeFile()
+{
+	char *file = NULL;
+
+	pthread_mutex_lock(&fileLock);
+	if(nextFile<fileCount)
+		file = files[nextFile++];
+	pthread_mutex_unlock(&fileLock);
+	return file;
+}
+
+
+
+// Reads a file to sign. Returns its size, or -1 on failure.
+long readFile(const char *fileName, CK_BYTE *data)
+{
+	FILE *fileRead = fopen(fileName, "rb");
+	long fileSize = 0;
+
+	if(!fileRead)
+		return -1;
+	fseek(fileRead, 0, SEEK_END);
+	fileSize = ftell(fileRead);
+	rewind(fileRead);
+	if(fileSize>MAX_FILE_SIZE || fread(data, 1, fileSize, fileRead)!=(size_t)fileSize)
+		fileSize = -1;
+	fclose(fileRead);
+	return fileSize;
+}
+
+
+
+// Writes signature to <file>.sig.
+int writeSignature(const char *fileName, CK_BYTE *signature, CK_ULONG signatureLen)
+{
+	char signatureFileName[1024];
+	FILE *sigWrite = NULL;
+
+	snprintf(signatureFileName, sizeof(signatureFileName), "%s.sig", fileName);
+	sigWrite = fopen(signatureFileName, "wb");
+	if(!sigWrite)
+		return 0;
+	fwrite(signature, sizeof(CK_BYTE), signatureLen, sigWrite);
+	fclose(sigWrite);
+	return 1;
+}
+
+
+
+// Signs data using CKM_HSS. The signature buffer grows as needed.
+CK_RV signData(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE hPrivate, CK_BYTE *data, CK_ULONG dataLen, CK_BYTE **signature, CK_ULONG *signatureSize, CK_ULONG *signatureLen)
+{
+	CK_MECHANISM mech = {CKM_HSS};
+	CK_RV rv = CKR_OK;
+
+	rv = p11Func->C_SignInit(session, &mech, hPrivate);
+	if(rv!=CKR_OK)
+		return rv;
+	*signatureLen = *signatureSize;
+	rv = p11Func->C_Sign(session, data, dataLen, *signature, signatureLen);
+	// Without a buffer yet, C_Sign only returns the length, and the operation stays active.
+	if(rv==CKR_BUFFER_TOO_SMALL || (rv==CKR_OK && *signature==NULL))
+	{
+		*signatureSize = *signatureLen;
+		*signature = (CK_BYTE*)realloc(*signature, *signatureSize);
+		rv = p11Func->C_Sign(session, data, dataLen, *signature, signatureLen);
+	}
+	return rv;
+}
+
+
+
+// Signer thread; signs files using the leaves it has reserved.
+void *signer(void *arg)
+{
+	CK_SESSION_HANDLE session = 0;
+	LEAF_RESERVATION reservation = {0, 0};
+	CK_BYTE *data = (CK_BYTE*)malloc(MAX_FILE_SIZE);
+	CK_BYTE *signature = NULL;
+	CK_ULONG signatureSize = 0;
+	CK_ULONG signatureLen = 0;
+	long dataLen = 0;
+	char *fileName = NULL;
+	CK_RV rv = CKR_OK;
+	int done = 0;
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &session), "C_OpenSession");
+	while((fileName = takeFile())!=NULL)
+	{
+		dataLen = readFile(fileName, data);
+		if(dataLen<0)
+		{
+			fprintf(stderr, "  --> %s : failed to read (files of upto 32KB are supported).\n", fileName);
+			pthread_mutex_lock(&fileLock);
+			filesFailed++;
+			pthread_mutex_unlock(&fileLock);
+			continue;
+		}
+
+		done = 0;
+		while(!done)
+		{
+			if(reservation.count==0 && !reserveLeaves(&reservation))
+			{
+				fprintf(stderr, "  --> %s : no HSS key has leaves left above the watermark.\n", fileName);
+				pthread_mutex_lock(&fileLock);
+				filesFailed++;
+				pthread_mutex_unlock(&fileLock);
+				break;
+			}
+
+			rv = signData(session, hssKeys[reservation.keyIndex].handle, data, dataLen, &signature, &signatureSize, &signatureLen);
+			if(rv==CKR_KEY_EXHAUSTED)
+			{
+				retireKey(reservation.keyIndex);
+				reservation.count = 0;
+				continue; // Signs the same file with the next key.
+			}
+
+			// A failed signature may still have used a leaf, so it is counted.
+			reservation.count--;
+			done = 1;
+			pthread_mutex_lock(&fileLock);
+			if(rv==CKR_OK && writeSignature(fileName, signature, signatureLen))
+			{
+				filesSigned++;
+				hssKeys[reservation.keyIndex].signatures++;
+			}
+			else
+			{
+				fprintf(stderr, "  --> %s : signing failed with Ox%lX.\n", fileName, rv);
+				filesFailed++;
+			}
+			pthread_mutex_unlock(&fileLock);
+		}
+	}
+
+	free(data);
+	free(signature);
+	checkOperation(p11Func->C_CloseSession(session), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Reads CKA_HSS_KEYS_REMAINING once more for every key, so the journal matches the HSM after a clean exit.
+void reconcileJournal()
+{
+	printf("\n> HSS key budget.\n");
+	for(int ctr=0; ctr<hssKeyCount; ctr++)
+	{
+		hssKeys[ctr].unreserved = readKeysRemaining(hSession, &hssKeys[ctr]);
+		printf("  --> %s : %lu signatures made, %lu leaves left%s.\n", hssKeys[ctr].label, hssKeys[ctr].signatures,
+			hssKeys[ctr].unreserved, hssKeys[ctr].unreserved<=watermark ? " (below watermark)" : "");
+	}
+	writeJournal();
+	printf("  --> Journal updated : %s.\n", journalFile);
+}
+
+
+
+// Splits a comma separated list of labels.
+void parseKeyLabels(char *labels)
+{
+	char *label = strtok(labels, ",");
+
+	while(label!=NULL && hssKeyCount<MAX_HSS_KEYS)
+	{
+		memset(&hssKeys[hssKeyCount], 0, sizeof(HSS_KEY_BUDGET));
+		strncpy(hssKeys[hssKeyCount].label, label, MAX_LABEL_LEN-1);
+		hssKeyCount++;
+		label = strtok(NULL, ",");
+	}
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <hss_key_labels> <journal_file> <watermark> <leaves_per_reservation> <number_of_threads> <file_to_sign> [file_to_sign ...]\n\n", exeName);
+	printf("  hss_key_labels : comma separated labels of HSS private keys, used in this order.\n");
+	printf("  watermark : number of leaves left unused in every key.\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	pthread_t *threads = NULL;
+	int nThreads = 0;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<9) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+	parseKeyLabels((char*)argv[3]);
+	journalFile = (char*)argv[4];
+	watermark = strtoul((const char*)argv[5], NULL, 10);
+	reservationSize = strtoul((const char*)argv[6], NULL, 10);
+	nThreads = atoi((const char*)argv[7]);
+	files = (char**)&argv[8];
+	fileCount = argc - 8;
+	if(reservationSize<1)
+		reservationSize = 1;
+	if(nThreads<1)
+		nThreads = 1;
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+	loadHSSKeys();
+
+	printf("\n> Signing %d files using %d threads, %lu leaves per reservation, watermark %lu.\n", fileCount, nThreads, reservationSize, watermark);
+	threads = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&threads[ctr], NULL, &signer, NULL);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(threads[ctr], NULL);
+	free(threads);
+
+	printf("\n> %d files signed, %d failed.\n", filesSigned, filesFailed);
+	reconcileJournal();
+	printf("  --> CKA_HSS_KEYS_REMAINING read %lu times for %d signatures.\n", attributeReads, filesSigned);
+
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,1024 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to verify a large number of HSS signatures on the host, without using the HSM.
+	- HSS verification only needs the public key, so the HSM is used once to export the HSS public keys to a cache file.
+	- In export mode, the CKA_VALUE of each HSS public key is written to the cache file as <label> <hex value>.
+	  Exporting a label again, e.g. after the key was rotated, replaces its entry.
+	- In verify mode, the cache file and a manifest are read, and the signatures are verified by multiple threads
+	  using a software implementation of LMS/HSS (RFC 8554 and NIST SP 800-208).
+	- Each line of the manifest is : <hss_public_key_label> <data_file> <signature_file>.
+	- In a multi level HSS key, the signatures of the lower level public keys are shared by many signatures.
+	  Once such a signature is verified, it is remembered and not verified again.
+	- LMS_SHA256_M32_* / LMS_SHA256_M24_* and LMOTS_SHA256_N32_* / LMOTS_SHA256_N24_* are supported.
+	- It requires Luna HSM with firmware 7.8.9 or newer, and Luna Client 10.8.0 or newer, for export mode only.
+*/
+
+
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+        #include <unistd.h> // For fsync.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+#define MAX_LABEL_LEN 64
+#define MAX_PATH_LEN 1024
+#define MAX_HSS_LEVELS 8
+#define MAX_PUBLIC_KEY_LEN (4 + 4 + 4 + 16 + 32)
+#define VERIFIED_CACHE_SIZE 4096 // Number of lower level signatures remembered, must be a power of 2.
+#define READ_CHUNK_SIZE 65536
+#define CACHE_LINE_LEN (MAX_LABEL_LEN + (MAX_PUBLIC_KEY_LEN * 2) + 4)
+
+// Domain separators from RFC 8554.
+#define D_PBLC 0x8080
+#define D_MESG 0x8181
+#define D_LEAF 0x8282
+#define D_INTR 0x8383
+
+
+// LM-OTS parameter sets (RFC 8554 and SP 800-208).
+typedef struct
+{
+	uint32_t type;
+	CK_ULONG n; // Hash length.
+	int w; // Winternitz parameter.
+	int p; // Number of hash chains.
+	int ls; // Checksum left shift.
+} LMOTS_PARAM;
+
+static const LMOTS_PARAM lmotsParams[] =
+{
+	{0x01, 32, 1, 265, 7}, // LMOTS_SHA256_N32_W1
+	{0x02, 32, 2, 133, 6}, // LMOTS_SHA256_N32_W2
+	{0x03, 32, 4, 67, 4},  // LMOTS_SHA256_N32_W4
+	{0x04, 32, 8, 34, 0},  // LMOTS_SHA256_N32_W8
+	{0x05, 24, 1, 200, 8}, // LMOTS_SHA256_N24_W1
+	{0x06, 24, 2, 101, 6}, // LMOTS_SHA256_N24_W2
+	{0x07, 24, 4, 51, 4},  // LMOTS_SHA256_N24_W4
+	{0x08, 24, 8, 26, 0}   // LMOTS_SHA256_N24_W8
+};
+
+
+// LMS parameter sets (RFC 8554 and SP 800-208).
+typedef struct
+{
+	uint32_t type;
+	CK_ULONG m; // Hash length.
+	int h; // Tree height.
+} LMS_PARAM;
+
+static const LMS_PARAM lmsParams[] =
+{
+	{0x05, 32, 5},  {0x06, 32, 10}, {0x07, 32, 15}, {0x08, 32, 20}, {0x09, 32, 25}, // LMS_SHA256_M32_H*
+	{0x0A, 24, 5},  {0x0B, 24, 10}, {0x0C, 24, 15}, {0x0D, 24, 20}, {0x0E, 24, 25}  // LMS_SHA256_M24_H*
+};
+
+
+// LMS public key.
+typedef struct
+{
+	const LMS_PARAM *lms;
+	const LMOTS_PARAM *ots;
+	CK_BYTE I[16];
+	CK_BYTE T1[32];
+	const CK_BYTE *raw; // Encoded public key, hashed as the message of the upper level signature.
+	size_t rawLen;
+} LMS_PUBLIC_KEY;
+
+
+// HSS public key from the cache file.
+typedef struct
+{
+	char label[MAX_LABEL_LEN];
+	uint32_t levels;
+	LMS_PUBLIC_KEY root;
+	CK_BYTE raw[MAX_PUBLIC_KEY_LEN];
+} HSS_PUBLIC_KEY;
+
+
+// LMS signature, pointing into the signature file.
+typedef struct
+{
+	uint32_t q; // Leaf number.
+	const LMOTS_PARAM *ots;
+	const CK_BYTE *C;
+	const CK_BYTE *y;
+	const CK_BYTE *path;
+	const CK_BYTE *raw;
+	size_t rawLen;
+} LMS_SIGNATURE;
+
+
+// Line of the manifest.
+typedef struct
+{
+	HSS_PUBLIC_KEY *key;
+	char dataFile[MAX_PATH_LEN];
+	char signatureFile[MAX_PATH_LEN];
+	int result;
+} VERIFY_JOB;
+
+enum { VERIFY_OK = 0, VERIFY_INVALID, VERIFY_MALFORMED, VERIFY_IO_ERROR, VERIFY_UNKNOWN_KEY };
+static const char *verifyResults[] = {"valid", "INVALID signature", "malformed signature", "cannot read file", "unknown key"};
+
+
+// SHA-256 context.
+typedef struct
+{
+	uint32_t h[8];
+	CK_BYTE block[64];
+	size_t pos;
+	uint64_t totalLen;
+} SHA256_CTX;
+
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+
+HSS_PUBLIC_KEY *publicKeys = NULL; // Public keys from the cache file.
+int publicKeyCount = 0;
+VERIFY_JOB *jobs = NULL;
+int jobCount = 0;
+int nextJob = 0;
+pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+
+CK_BYTE verifiedCache[VERIFIED_CACHE_SIZE][32]; // Digests of verified lower level signatures.
+int verifiedCacheUsed[VERIFIED_CACHE_SIZE];
+unsigned long cacheHits = 0;
+pthread_mutex_t cacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// SHA-256 round constants.
+static const uint32_t sha256K[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+static const uint32_t sha256IV[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+
+
+// SHA-256 compression function.
+static void sha256Block(uint32_t h[8], const CK_BYTE *block)
+{
+	uint32_t w[64], a, b, c, d, e, f, g, k, t1, t2;
+
+	for(int i=0; i<16; i++)
+		w[i] = ((uint32_t)block[i*4] << 24) | ((uint32_t)block[i*4+1] << 16) | ((uint32_t)block[i*4+2] << 8) | block[i*4+3];
+	for(int i=16; i<64; i++)
+	{
+		uint32_t s0 = ROTR32(w[i-15], 7) ^ ROTR32(w[i-15], 18) ^ (w[i-15] >> 3);
+		uint32_t s1 = ROTR32(w[i-2], 17) ^ ROTR32(w[i-2], 19) ^ (w[i-2] >> 10);
+		w[i] = w[i-16] + s0 + w[i-7] + s1;
+	}
+
+	a = h[0]; b = h[1]; c = h[2]; d = h[3]; e = h[4]; f = h[5]; g = h[6]; k = h[7];
+	for(int i=0; i<64; i++)
+	{
+		t1 = k + (ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25)) + ((e & f) ^ (~e & g)) + sha256K[i] + w[i];
+		t2 = (ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+		k = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+	}
+	h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+}
+
+
+
+void sha256Init(SHA256_CTX *ctx)
+{
+	memcpy(ctx->h, sha256IV, sizeof(sha256IV));
+	ctx->pos = 0;
+	ctx->totalLen = 0;
+}
+
+
+
+void sha256Update(SHA256_CTX *ctx, const CK_BYTE *data, size_t len)
+{
+	ctx->totalLen += len;
+	while(len>0)
+	{
+		if(ctx->pos==0 && len>=64)
+		{
+			sha256Block(ctx->h, data);
+			data += 64;
+			len -= 64;
+			continue;
+		}
+		size_t fill = 64 - ctx->pos;
+		if(fill>len)
+			fill = len;
+		memcpy(ctx->block + ctx->pos, data, fill);
+		ctx->pos += fill;
+		data += fill;
+		len -= fill;
+		if(ctx->pos==64)
+		{
+			sha256Block(ctx->h, ctx->block);
+			ctx->pos = 0;
+		}
+	}
+}
+
+
+
+// Writes the first outLen bytes of the digest (24 for SHA-256/192, 32 for SHA-256).
+void sha256Final(SHA256_CTX *ctx, CK_BYTE *digest, CK_ULONG outLen)
+{
+	uint64_t bitLen = ctx->totalLen * 8;
+
+	ctx->block[ctx->pos++] = 0x80;
+	if(ctx->pos>56)
+	{
+		memset(ctx->block + ctx->pos, 0, 64 - ctx->pos);
+		sha256Block(ctx->h, ctx->block);
+		ctx->pos = 0;
+	}
+	memset(ctx->block + ctx->pos, 0, 64 - ctx->pos);
+	for(int i=0; i<8; i++)
+		ctx->block[63-i] = (CK_BYTE)(bitLen >> (8*i));
+	sha256Block(ctx->h, ctx->block);
+
+	for(CK_ULONG i=0; i<outLen; i++)
+		digest[i] = (CK_BYTE)(ctx->h[i/4] >> (24 - 8*(i%4)));
+}
+
+
+
+// Helpers for the big endian encodings of RFC 8554.
+static uint32_t get32(const CK_BYTE *in)
+{
+	return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+}
+
+static void put32(CK_BYTE *out, uint32_t value)
+{
+	out[0] = (CK_BYTE)(value >> 24); out[1] = (CK_BYTE)(value >> 16); out[2] = (CK_BYTE)(value >> 8); out[3] = (CK_BYTE)value;
+}
+
+static void put16(CK_BYTE *out, uint16_t value)
+{
+	out[0] = (CK_BYTE)(value >> 8); out[1] = (CK_BYTE)value;
+}
+
+
+
+// Returns the i-th Winternitz digit of S.
+static int coef(const CK_BYTE *S, int i, int w)
+{
+	return ((1 << w) - 1) & (S[(i * w) / 8] >> (8 - (w * (i % (8 / w)) + w)));
+}
+
+
+
+// Iterates one Winternitz hash chain from digit start to 2^w - 1.
+// The chain input (I || q || i || j || tmp) always fits in one SHA-256 block, so the padded block is
+// prepared once and only j and tmp change between iterations.
+static void lmotsChain(const CK_BYTE *I, uint32_t q, uint16_t i, int start, const LMOTS_PARAM *ots, CK_BYTE *tmp)
+{
+	CK_BYTE block[64];
+	uint32_t h[8];
+	size_t msgLen = 23 + ots->n;
+
+	memset(block, 0, sizeof(block));
+	memcpy(block, I, 16);
+	put32(block + 16, q);
+	put16(block + 20, i);
+	block[msgLen] = 0x80;
+	put16(block + 62, (uint16_t)(msgLen * 8));
+
+	for(int j=start; j<(1 << ots->w)-1; j++)
+	{
+		block[22] = (CK_BYTE)j;
+		memcpy(block + 23, tmp, ots->n);
+		memcpy(h, sha256IV, sizeof(sha256IV));
+		sha256Block(h, block);
+		for(CK_ULONG k=0; k<ots->n; k++)
+			tmp[k] = (CK_BYTE)(h[k/4] >> (24 - 8*(k%4)));
+	}
+}
+
+
+
+// Finds the parameters of an LM-OTS type.
+static const LMOTS_PARAM *findLmots(uint32_t type)
+{
+	for(size_t ctr=0; ctr<sizeof(lmotsParams)/sizeof(*lmotsParams); ctr++)
+		if(lmotsParams[ctr].type==type)
+			return &lmotsParams[ctr];
+	return NULL;
+}
+
+
+
+// Finds the parameters of an LMS type.
+static const LMS_PARAM *findLms(uint32_t type)
+{
+	for(size_t ctr=0; ctr<sizeof(lmsParams)/sizeof(*lmsParams); ctr++)
+		if(lmsParams[ctr].type==type)
+			return &lmsParams[ctr];
+	return NULL;
+}
+
+
+
+// Parses an LMS public key. Returns the number of bytes used, or 0 if malformed.
+size_t parseLmsPublicKey(const CK_BYTE *in, size_t len, LMS_PUBLIC_KEY *pk)
+{
+	if(len<8)
+		return 0;
+	pk->lms = findLms(get32(in));
+	pk->ots = findLmots(get32(in + 4));
+	if(pk->lms==NULL || pk->ots==NULL || len<24 + pk->lms->m)
+		return 0;
+	memcpy(pk->I, in + 8, 16);
+	memcpy(pk->T1, in + 24, pk->lms->m);
+	pk->raw = in;
+	pk->rawLen = 24 + pk->lms->m;
+	return pk->rawLen;
+}
+
+
+
+// Parses an LMS signature made with the given public key. Returns the number of bytes used, or 0 if malformed.
+size_t parseLmsSignature(const CK_BYTE *in, size_t len, const LMS_PUBLIC_KEY *pk, LMS_SIGNATURE *sig)
+{
+	size_t otsLen = 0, total = 0;
+
+	if(len<8)
+		return 0;
+	sig->q = get32(in);
+	sig->ots = findLmots(get32(in + 4));
+	if(sig->ots!=pk->ots)
+		return 0;
+	otsLen = 4 + sig->ots->n * (sig->ots->p + 1);
+	total = 4 + otsLen + 4 + pk->lms->h * pk->lms->m;
+	if(len<total || get32(in + 4 + otsLen)!=pk->lms->type || sig->q>=(1UL << pk->lms->h))
+		return 0;
+
+	sig->C = in + 8;
+	sig->y = sig->C + sig->ots->n;
+	sig->path = in + 4 + otsLen + 4;
+	sig->raw = in;
+	sig->rawLen = total;
+	return total;
+}
+
+
+
+// Starts the message hash Q = H(I || q || D_MESG || C || message). The caller adds the message.
+void lmsMessageInit(SHA256_CTX *ctx, const LMS_PUBLIC_KEY *pk, const LMS_SIGNATURE *sig)
+{
+	CK_BYTE prefix[22];
+
+	memcpy(prefix, pk->I, 16);
+	put32(prefix + 16, sig->q);
+	put16(prefix + 20, D_MESG);
+	sha256Init(ctx);
+	sha256Update(ctx, prefix, sizeof(prefix));
+	sha256Update(ctx, sig->C, sig->ots->n);
+}
+
+
+
+// Verifies an LMS signature given the message hash context (RFC 8554 algorithms 4b and 6a).
+int lmsVerify(SHA256_CTX *msgCtx, const LMS_PUBLIC_KEY *pk, const LMS_SIGNATURE *sig)
+{
+	const LMOTS_PARAM *ots = sig->ots;
+	CK_ULONG n = ots->n, m = pk->lms->m;
+	CK_BYTE Qa[34], tmp[32], prefix[22], node[32];
+	uint32_t checksum = 0, nodeNum = 0;
+	SHA256_CTX ctx;
+
+	// Candidate LM-OTS public key.
+	sha256Final(msgCtx, Qa, n);
+	for(int i=0; i<(int)(n * 8) / ots->w; i++)
+		checksum += ((1 << ots->w) - 1) - coef(Qa, i, ots->w);
+	put16(Qa + n, (uint16_t)(checksum << ots->ls));
+
+	memcpy(prefix, pk->I, 16);
+	put32(prefix + 16, sig->q);
+	put16(prefix + 20, D_PBLC);
+	sha256Init(&ctx);
+	sha256Update(&ctx, prefix, sizeof(prefix));
+	for(int i=0; i<ots->p; i++)
+	{
+		memcpy(tmp, sig->y + i * n, n);
+		lmotsChain(pk->I, sig->q, (uint16_t)i, coef(Qa, i, ots->w), ots, tmp);
+		sha256Update(&ctx, tmp, n);
+	}
+	sha256Final(&ctx, tmp, n);
+
+	// Leaf, then the authentication path up to the root.
+	nodeNum = (1UL << pk->lms->h) + sig->q;
+	put32(prefix + 16, nodeNum);
+	put16(prefix + 20, D_LEAF);
+	sha256Init(&ctx);
+	sha256Update(&ctx, prefix, sizeof(prefix));
+	sha256Update(&ctx, tmp, n);
+	sha256Final(&ctx, node, m);
+
+	for(int i=0; nodeNum>1; i++, nodeNum/=2)
+	{
+		put32(prefix + 16, nodeNum / 2);
+		put16(prefix + 20, D_INTR);
+		sha256Init(&ctx);
+		sha256Update(&ctx, prefix, sizeof(prefix));
+		if(nodeNum & 1)
+		{
+			sha256Update(&ctx, sig->path + i * m, m);
+			sha256Update(&ctx, node, m);
+		}
+		else
+		{
+			sha256Update(&ctx, node, m);
+			sha256Update(&ctx, sig->path + i * m, m);
+		}
+		sha256Final(&ctx, node, m);
+	}
+
+	return memcmp(node, pk->T1, m)==0;
+}
+
+
+
+// Checks if a lower level signature has already been verified, and remembers it if verified is set.
+int verifiedLookup(const CK_BYTE *digest, int verified)
+{
+	uint32_t slot = get32(digest) & (VERIFIED_CACHE_SIZE - 1);
+	int found = 0;
+
+	pthread_mutex_lock(&cacheLock);
+	for(int probe=0; probe<8; probe++, slot=(slot + 1) & (VERIFIED_CACHE_SIZE - 1))
+	{
+		if(verifiedCacheUsed[slot] && memcmp(verifiedCache[slot], digest, 32)==0)
+		{
+			found = 1;
+			cacheHits++;
+			break;
+		}
+		if(!verifiedCacheUsed[slot])
+		{
+			if(verified)
+			{
+				memcpy(verifiedCache[slot], digest, 32);
+				verifiedCacheUsed[slot] = 1;
+			}
+			break;
+		}
+	}
+	pthread_mutex_unlock(&cacheLock);
+	return found;
+}
+
+
+
+// Reads a whole file. Returns NULL on failure.
+CK_BYTE *readWholeFile(const char *fileName, size_t *len)
+{
+	FILE *file = fopen(fileName, "rb");
+	CK_BYTE *buffer = NULL;
+	long size = 0;
+
+	if(!file)
+		return NULL;
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	rewind(file);
+	buffer = (CK_BYTE*)malloc(size > 0 ? size : 1);
+	if(fread(buffer, 1, size, file)!=(size_t)size)
+	{
+		free(buffer);
+		buffer = NULL;
+	}
+	fclose(file);
+	*len = size;
+	return buffer;
+}
+
+
+
+// Verifies an HSS signature (RFC 8554 section 6.3). The data file is hashed in chunks.
+int verifyHSS(HSS_PUBLIC_KEY *key, const char *dataFile, const char *signatureFile, CK_BYTE *chunk)
+{
+	LMS_PUBLIC_KEY current = key->root, next;
+	LMS_SIGNATURE sig;
+	SHA256_CTX ctx;
+	CK_BYTE digest[32];
+	CK_BYTE *signature = NULL;
+	size_t signatureLen = 0, offset = 4, used = 0, readLen = 0;
+	FILE *data = NULL;
+	int result = VERIFY_OK;
+
+	signature = readWholeFile(signatureFile, &signatureLen);
+	if(signature==NULL)
+		return VERIFY_IO_ERROR;
+	if(signatureLen<4 || get32(signature)+1!=key->levels)
+	{
+		free(signature);
+		return VERIFY_MALFORMED;
+	}
+
+	// Signed public keys of the lower levels.
+	for(uint32_t level=0; level<key->levels-1; level++)
+	{
+		used = parseLmsSignature(signature + offset, signatureLen - offset, &current, &sig);
+		if(used==0 || parseLmsPublicKey(signature + offset + used, signatureLen - offset - used, &next)==0)
+		{
+			result = VERIFY_MALFORMED;
+			break;
+		}
+		offset += used + next.rawLen;
+
+		// The same signed public key is part of every signature made by that lower level key.
+		sha256Init(&ctx);
+		sha256Update(&ctx, current.raw, current.rawLen);
+		sha256Update(&ctx, sig.raw, sig.rawLen + next.rawLen);
+		sha256Final(&ctx, digest, 32);
+		if(!verifiedLookup(digest, 0))
+		{
+			lmsMessageInit(&ctx, &current, &sig);
+			sha256Update(&ctx, next.raw, next.rawLen);
+			if(!lmsVerify(&ctx, &current, &sig))
+			{
+				result = VERIFY_INVALID;
+				break;
+			}
+			verifiedLookup(digest, 1);
+		}
+		current = next;
+	}
+
+	// Signature of the data.
+	if(result==VERIFY_OK)
+	{
+		used = parseLmsSignature(signature + offset, signatureLen - offset, &current, &sig);
+		data = fopen(dataFile, "rb");
+		if(used==0 || offset + used!=signatureLen)
+			result = VERIFY_MALFORMED;
+		else if(!data)
+			result = VERIFY_IO_ERROR;
+		else
+		{
+			lmsMessageInit(&ctx, &current, &sig);
+			while((readLen = fread(chunk, 1, READ_CHUNK_SIZE, data))>0)
+				sha256Update(&ctx, chunk, readLen);
+			if(!lmsVerify(&ctx, &current, &sig))
+				result = VERIFY_INVALID;
+		}
+		if(data)
+			fclose(data);
+	}
+
+	free(signature);
+	return result;
+}
+
+
+
+// Verifier thread; takes lines of the manifest until none are left.
+void *verifier(void *arg)
+{
+	CK_BYTE *chunk = (CK_BYTE*)malloc(READ_CHUNK_SIZE);
+	VERIFY_JOB *job = NULL;
+
+	while(1)
+	{
+		pthread_mutex_lock(&jobLock);
+		job = (nextJob<jobCount) ? &jobs[nextJob++] : NULL;
+		pthread_mutex_unlock(&jobLock);
+		if(job==NULL)
+			break;
+
+		if(job->key==NULL)
+			job->result = VERIFY_UNKNOWN_KEY;
+		else
+			job->result = verifyHSS(job->key, job->dataFile, job->signatureFile, chunk);
+	}
+	free(chunk);
+	return 0;
+}
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+	if(libHandle)
+	{
+	        #ifdef OS_UNIX
+	                dlclose(libHandle); // Close library handle on Unix/Linux
+	        #else
+	                FreeLibrary(libHandle); // Close library handle on Windows.
+	        #endif
+	}
+        free(slotPin);
+	free(publicKeys);
+	free(jobs);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("\n%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Exports the CKA_VALUE of HSS public keys to the cache file.
+// The cache is rewritten through a temporary file; the entries of the exported labels are replaced.
+void exportPublicKeys(const char *cacheFile, char **labels, int labelCount)
+{
+	CK_OBJECT_CLASS publicKey = CKO_PUBLIC_KEY;
+	CK_KEY_TYPE hssKey = CKK_HSS;
+	CK_OBJECT_HANDLE hPublic = 0;
+	CK_ULONG objCount = 0;
+	CK_BYTE value[MAX_PUBLIC_KEY_LEN];
+	char (*entries)[CACHE_LINE_LEN] = calloc(labelCount, CACHE_LINE_LEN); // Empty for the keys not exported.
+	char line[CACHE_LINE_LEN];
+	char label[MAX_LABEL_LEN];
+	char tempFile[MAX_PATH_LEN + 4];
+	FILE *previous = NULL;
+	FILE *cache = NULL;
+	int keep = 0, ok = 0;
+	size_t len = 0;
+
+	printf("\n> Exporting HSS public keys to %s.\n", cacheFile);
+	for(int ctr=0; ctr<labelCount; ctr++)
+	{
+		CK_ATTRIBUTE attrib[] =
+		{
+			{CKA_CLASS,		&publicKey,	sizeof(CK_OBJECT_CLASS)},
+			{CKA_KEY_TYPE,		&hssKey,	sizeof(CK_KEY_TYPE)},
+			{CKA_LABEL,		labels[ctr],	strlen(labels[ctr])}
+		};
+		CK_ATTRIBUTE valueAttrib[] = {{CKA_VALUE, value, sizeof(value)}};
+
+		checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, 3), "C_FindObjectsInit");
+		checkOperation(p11Func->C_FindObjects(hSession, &hPublic, 1, &objCount), "C_FindObjects");
+		checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+		if(objCount==0)
+		{
+			fprintf(stderr, "  --> Public key %s not found.\n", labels[ctr]);
+			continue;
+		}
+
+		checkOperation(p11Func->C_GetAttributeValue(hSession, hPublic, valueAttrib, 1), "C_GetAttributeValue");
+		len = snprintf(entries[ctr], CACHE_LINE_LEN, "%.63s ", labels[ctr]);
+		for(CK_ULONG i=0; i<valueAttrib[0].ulValueLen; i++)
+			len += snprintf(entries[ctr] + len, CACHE_LINE_LEN - len, "%02x", value[i]);
+		snprintf(entries[ctr] + len, CACHE_LINE_LEN - len, "\n");
+		printf("  --> %s : %lu bytes.\n", labels[ctr], valueAttrib[0].ulValueLen);
+	}
+
+	snprintf(tempFile, sizeof(tempFile), "%s.tmp", cacheFile);
+	cache = fopen(tempFile, "w");
+	if(!cache)
+	{
+		fprintf(stderr, "Failed to write %s.\n", tempFile);
+		free(entries);
+		return;
+	}
+
+	// Entries of the other labels are kept as they are.
+	previous = fopen(cacheFile, "r");
+	if(previous)
+	{
+		while(fgets(line, sizeof(line), previous))
+		{
+			if(sscanf(line, "%63s", label)!=1)
+				continue;
+			keep = 1;
+			for(int ctr=0; ctr<labelCount && keep; ctr++)
+				keep = !(entries[ctr][0] && strncmp(labels[ctr], label, MAX_LABEL_LEN - 1)==0);
+			if(keep)
+				fputs(line, cache);
+		}
+		fclose(previous);
+	}
+	for(int ctr=0; ctr<labelCount; ctr++)
+		fputs(entries[ctr], cache);
+	free(entries);
+
+	ok = fflush(cache)==0 && !ferror(cache);
+	#ifdef OS_UNIX
+		ok = ok && fsync(fileno(cache))==0;
+	#endif
+	ok = (fclose(cache)==0) && ok;
+
+	#ifndef OS_UNIX
+		if(ok)
+			remove(cacheFile); // rename does not replace an existing file on Windows.
+	#endif
+	if(!ok || rename(tempFile, cacheFile)!=0)
+	{
+		fprintf(stderr, "Failed to update %s.\n", cacheFile);
+		remove(tempFile);
+	}
+}
+
+
+
+// Finds a public key by label.
+HSS_PUBLIC_KEY *findPublicKey(const char *label)
+{
+	for(int ctr=0; ctr<publicKeyCount; ctr++)
+		if(strcmp(publicKeys[ctr].label, label)==0)
+			return &publicKeys[ctr];
+	return NULL;
+}
+
+
+
+// Reads and parses the HSS public keys of the cache file.
+// Caches written by older versions of the sample may list a label more than once; the last entry is kept.
+void loadPublicKeyCache(const char *cacheFile)
+{
+	FILE *cache = fopen(cacheFile, "r");
+	char label[MAX_LABEL_LEN];
+	char hex[256];
+	int capacity = 0;
+	unsigned int byte = 0;
+	size_t rawLen = 0;
+	HSS_PUBLIC_KEY *key = NULL;
+	HSS_PUBLIC_KEY *previous = NULL;
+
+	if(!cache)
+	{
+		fprintf(stderr, "Failed to read %s.\n", cacheFile);
+		exit(1);
+	}
+
+	while(fscanf(cache, "%63s %255s", label, hex)==2)
+	{
+		if(publicKeyCount==capacity)
+		{
+			capacity = capacity ? capacity * 2 : 16;
+			publicKeys = (HSS_PUBLIC_KEY*)realloc(publicKeys, capacity * sizeof(HSS_PUBLIC_KEY));
+		}
+		key = &publicKeys[publicKeyCount];
+		memset(key, 0, sizeof(HSS_PUBLIC_KEY));
+		snprintf(key->label, MAX_LABEL_LEN, "%s", label);
+
+		rawLen = strlen(hex) / 2;
+		for(size_t i=0; i<rawLen && i<MAX_PUBLIC_KEY_LEN; i++)
+		{
+			sscanf(hex + (i*2), "%2x", &byte);
+			key->raw[i] = (CK_BYTE)byte;
+		}
+		key->levels = (rawLen>4) ? get32(key->raw) : 0;
+		if(rawLen>MAX_PUBLIC_KEY_LEN || key->levels<1 || key->levels>MAX_HSS_LEVELS ||
+		   parseLmsPublicKey(key->raw + 4, rawLen - 4, &key->root)!=rawLen - 4)
+		{
+			fprintf(stderr, "  --> Ignoring malformed public key %s.\n", label);
+			continue;
+		}
+		if((previous = findPublicKey(label))!=NULL)
+			*previous = *key;
+		else
+			publicKeyCount++;
+	}
+	fclose(cache);
+
+	// The array may have moved while growing, so the encoded root keys are pointed to only now.
+	for(int ctr=0; ctr<publicKeyCount; ctr++)
+		publicKeys[ctr].root.raw = publicKeys[ctr].raw + 4;
+	printf("\n> %d HSS public keys loaded from %s.\n", publicKeyCount, cacheFile);
+}
+
+
+
+// Reads the manifest : <hss_public_key_label> <data_file> <signature_file> per line.
+void loadManifest(const char *manifest)
+{
+	FILE *file = fopen(manifest, "r");
+	char label[MAX_LABEL_LEN];
+	int capacity = 0;
+
+	if(!file)
+	{
+		fprintf(stderr, "Failed to read %s.\n", manifest);
+		exit(1);
+	}
+
+	while(1)
+	{
+		if(jobCount==capacity)
+		{
+			capacity = capacity ? capacity * 2 : 1024;
+			jobs = (VERIFY_JOB*)realloc(jobs, capacity * sizeof(VERIFY_JOB));
+		}
+		if(fscanf(file, "%63s %1023s %1023s", label, jobs[jobCount].dataFile, jobs[jobCount].signatureFile)!=3)
+			break;
+		jobs[jobCount].key = findPublicKey(label);
+		jobs[jobCount].result = VERIFY_OK;
+		jobCount++;
+	}
+	fclose(file);
+	printf("\n> %d signatures to verify from %s.\n", jobCount, manifest);
+}
+
+
+
+// Verifies all lines of the manifest using multiple threads.
+void verifyManifest(int nThreads)
+{
+	pthread_t *threads = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	struct timespec start, end;
+	int counts[VERIFY_UNKNOWN_KEY + 1] = {0};
+	double seconds = 0;
+
+	printf("\n> Verifying on the host using %d threads, the HSM is not used.\n", nThreads);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&threads[ctr], NULL, &verifier, NULL);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(threads[ctr], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	free(threads);
+
+	for(int ctr=0; ctr<jobCount; ctr++)
+	{
+		counts[jobs[ctr].result]++;
+		if(jobs[ctr].result!=VERIFY_OK)
+			printf("  --> %s : %s.\n", jobs[ctr].signatureFile, verifyResults[jobs[ctr].result]);
+	}
+
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("\n> Verification completed.\n");
+	printf("  --> Valid : %d, invalid : %d, malformed : %d, unreadable : %d, unknown key : %d.\n",
+		counts[VERIFY_OK], counts[VERIFY_INVALID], counts[VERIFY_MALFORMED], counts[VERIFY_IO_ERROR], counts[VERIFY_UNKNOWN_KEY]);
+	printf("  --> %.1f verifications per second.\n", jobCount / (seconds > 0 ? seconds : 1e-9));
+	printf("  --> Lower level signatures verified earlier and reused : %lu.\n", cacheHits);
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s export <slot_number> <crypto_officer_password> <cache_file> <hss_public_key_label> [hss_public_key_label ...]\n", exeName);
+	printf("%s verify <cache_file> <manifest_file> <number_of_threads>\n\n", exeName);
+	printf("  manifest_file : one <hss_public_key_label> <data_file> <signature_file> per line.\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int nThreads = 0;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc>=6 && strcmp((const char*)argv[1], "export")==0)
+	{
+		slotId = atoi((const char*)argv[2]);
+		slotPin = (CK_BYTE*)strdup((const char*)argv[3]);
+		loadLunaLibrary();
+		connectToLunaSlot();
+		exportPublicKeys((const char*)argv[4], (char**)&argv[5], argc - 5);
+		disconnectFromLunaSlot();
+	}
+	else if(argc>=5 && strcmp((const char*)argv[1], "verify")==0)
+	{
+		nThreads = atoi((const char*)argv[4]);
+		if(nThreads<1)
+			nThreads = 1;
+		loadPublicKeyCache((const char*)argv[2]);
+		loadManifest((const char*)argv[3]);
+		verifyManifest(nThreads);
+	}
+	else
+	{
+		usage((char*)argv[0]);
+		exit(1);
+	}
+
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,522 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2024 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+
+        OBJECTIVE :
+	- This sample benchmarks ML-DSA key generation, signing and verification on a Luna HSM.
+	- All three parameter sets (ML-DSA-44, ML-DSA-65 and ML-DSA-87) are measured.
+	- Signing is measured with both the hedged (CKH_HEDGE_REQUIRED) and deterministic (CKH_DETERMINISTIC_REQUIRED) variants.
+	- Sign and verify are measured for message sizes from 32 bytes to 1 MB, using 1 to N threads with one session per thread.
+	- RSA-2048 (CKM_SHA256_RSA_PKCS) and ECDSA P-256 (CKM_ECDSA_SHA256) are measured the same way to provide a baseline.
+	- For every measurement, operations per second, signature size and latency percentiles are displayed.
+	- All keys are generated as session objects and are destroyed when the sample disconnects.
+*/
+
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+#define OP_KEYGEN 0
+#define OP_SIGN 1
+#define OP_VERIFY 2
+
+#define ALG_ML_DSA 0
+#define ALG_RSA 1
+#define ALG_ECDSA 2
+
+
+// Algorithms to benchmark.
+typedef struct
+{
+	const char *name;
+	int family;
+	CK_ML_DSA_PARAMETER_SET_TYPE paramSet; // Only used by ML-DSA.
+	CK_OBJECT_HANDLE hPublic;
+	CK_OBJECT_HANDLE hPrivate;
+} ALGORITHM;
+
+ALGORITHM algorithms[] =
+{
+	{"ML-DSA-44",	ALG_ML_DSA,	CKP_ML_DSA_44,	0, 0},
+	{"ML-DSA-65",	ALG_ML_DSA,	CKP_ML_DSA_65,	0, 0},
+	{"ML-DSA-87",	ALG_ML_DSA,	CKP_ML_DSA_87,	0, 0},
+	{"RSA-2048",	ALG_RSA,	0,		0, 0},
+	{"ECDSA-P256",	ALG_ECDSA,	0,		0, 0}
+};
+#define ALGORITHM_COUNT (sizeof(algorithms)/sizeof(*algorithms))
+
+CK_ULONG messageSizes[] = {32, 1024, 65536, 1048576};
+#define MESSAGE_SIZE_COUNT (sizeof(messageSizes)/sizeof(*messageSizes))
+
+
+// Parameters of one measurement, shared by all the threads running it.
+typedef struct
+{
+	ALGORITHM *alg;
+	int operation;
+	CK_ULONG hedgeVariant; // Only used by ML-DSA signing.
+	CK_BYTE *message;
+	CK_ULONG messageLen;
+	CK_BYTE *signature; // Used by verify.
+	CK_ULONG signatureLen;
+	int opsPerThread;
+	double *latencies; // opsPerThread entries per thread, in milliseconds.
+} RUN_CONFIG;
+
+typedef struct
+{
+	RUN_CONFIG *config;
+	int index;
+} THREAD_ARG;
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+CK_BYTE *message = NULL; // Random message, the first messageLen bytes are used.
+int maxThreads = 0;
+int opsPerThread = 0;
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+	CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+	char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+	if(libPath==NULL)
+	{
+		printf("P11_LIB environment variable not set.\n");
+		printf("\n > On Unix/Linux :-\n");
+		printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\n > On Windows :-\n");
+		printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\nExample :-");
+		printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+		printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+		exit(1);
+	}
+
+
+	#ifdef OS_UNIX
+		libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+	#else
+		libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+	#endif
+	if(!libHandle)
+	{
+		printf("Failed to load Luna library from path : %s\n", libPath);
+		exit(1);
+	}
+
+
+	#ifdef OS_UNIX
+	    C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+	#else
+		C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+	#endif
+
+	C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+	if(p11Func==NULL)
+	{
+		printf("Failed to load P11 functions.\n");
+		exit(1);
+	}
+
+	printf ("\n> P11 library loaded.\n");
+	printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+	free(slotPin);
+	free(message);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char exeName[30])
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <max_threads> <ops_per_thread>\n\n", exeName);
+}
+
+
+
+// Returns the time elapsed between two timestamps in milliseconds.
+double elapsedMs(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e3 + (end->tv_nsec - start->tv_nsec) / 1e6;
+}
+
+
+
+// Used by qsort to sort latencies.
+int compareDouble(const void *a, const void *b)
+{
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+
+
+// Generates a session keypair of the given algorithm.
+CK_RV generateKeyPair(CK_SESSION_HANDLE hSess, ALGORITHM *alg, CK_OBJECT_HANDLE *hPub, CK_OBJECT_HANDLE *hPri)
+{
+	CK_MECHANISM mech = {CKM_ML_DSA_KEY_PAIR_GEN};
+	CK_BBOOL yes = CK_TRUE;
+	CK_BBOOL no = CK_FALSE;
+	CK_OBJECT_CLASS objClassPub = CKO_PUBLIC_KEY;
+	CK_OBJECT_CLASS objClassPri = CKO_PRIVATE_KEY;
+	CK_ML_DSA_PARAMETER_SET_TYPE paramType = alg->paramSet;
+	CK_ULONG mod = 2048;
+	CK_BYTE exp[] = {0x01, 0x00, 0x01};
+	CK_BYTE ecParam[] = {0x06,0x08,0x2A,0x86,0x48,0xCE,0x3D,0x03,0x01,0x07}; // prime256v1
+
+	// The last entry of the public key template depends on the algorithm.
+	CK_ATTRIBUTE attribPub[] =
+	{
+		{CKA_TOKEN,             &no,            sizeof(CK_BBOOL)},
+		{CKA_CLASS,             &objClassPub,   sizeof(CK_OBJECT_CLASS)},
+		{CKA_PRIVATE,           &no,            sizeof(CK_BBOOL)},
+		{CKA_VERIFY,            &yes,           sizeof(CK_BBOOL)},
+		{CKA_PARAMETER_SET,     &paramType,     sizeof(CK_ML_DSA_PARAMETER_SET_TYPE)},
+		{CKA_PUBLIC_EXPONENT,   exp,            sizeof(exp)}
+	};
+	CK_ULONG attribPubLen = 5;
+
+	CK_ATTRIBUTE attribPri[] =
+	{
+		{CKA_TOKEN,             &no,            sizeof(CK_BBOOL)},
+		{CKA_PRIVATE,           &yes,           sizeof(CK_BBOOL)},
+		{CKA_SENSITIVE,         &yes,           sizeof(CK_BBOOL)},
+		{CKA_MODIFIABLE,        &no,            sizeof(CK_BBOOL)},
+		{CKA_EXTRACTABLE,       &no,            sizeof(CK_BBOOL)},
+		{CKA_SIGN,              &yes,           sizeof(CK_BBOOL)},
+		{CKA_CLASS,             &objClassPri,   sizeof(CK_OBJECT_CLASS)}
+	};
+	CK_ULONG attribPriLen = sizeof(attribPri) / sizeof(*attribPri);
+
+	if(alg->family==ALG_RSA)
+	{
+		mech.mechanism = CKM_RSA_PKCS_KEY_PAIR_GEN;
+		attribPub[4].type = CKA_MODULUS_BITS;
+		attribPub[4].pValue = &mod;
+		attribPub[4].ulValueLen = sizeof(CK_ULONG);
+		attribPubLen = 6;
+	}
+	else if(alg->family==ALG_ECDSA)
+	{
+		mech.mechanism = CKM_EC_KEY_PAIR_GEN;
+		attribPub[4].type = CKA_EC_PARAMS;
+		attribPub[4].pValue = ecParam;
+		attribPub[4].ulValueLen = sizeof(ecParam);
+	}
+
+	return p11Func->C_GenerateKeyPair(hSess, &mech, attribPub, attribPubLen, attribPri, attribPriLen, hPub, hPri);
+}
+
+
+
+// Builds the signature mechanism for the given algorithm.
+void initSignMechanism(RUN_CONFIG *config, CK_MECHANISM *mech, CK_SIGN_ADDITIONAL_CONTEXT *param)
+{
+	switch(config->alg->family)
+	{
+		case ALG_ML_DSA:
+			param->hedgeVariant = config->hedgeVariant;
+			param->pContext = NULL;
+			param->ulContextLen = 0;
+			mech->mechanism = CKM_ML_DSA;
+			mech->pParameter = param;
+			mech->ulParameterLen = sizeof(CK_SIGN_ADDITIONAL_CONTEXT);
+			break;
+		case ALG_RSA:
+			mech->mechanism = CKM_SHA256_RSA_PKCS;
+			mech->pParameter = NULL;
+			mech->ulParameterLen = 0;
+			break;
+		default:
+			mech->mechanism = CKM_ECDSA_SHA256;
+			mech->pParameter = NULL;
+			mech->ulParameterLen = 0;
+			break;
+	}
+}
+
+
+
+// Thread function; performs opsPerThread operations using its own session and records the latency of each one.
+void *runOperations(void *arg)
+{
+	THREAD_ARG *threadArg = (THREAD_ARG*)arg;
+	RUN_CONFIG *config = threadArg->config;
+	double *latencies = config->latencies + (threadArg->index * config->opsPerThread);
+	CK_SESSION_HANDLE hChildSession = 0;
+	CK_OBJECT_HANDLE hPub = 0, hPri = 0;
+	CK_SIGN_ADDITIONAL_CONTEXT param;
+	CK_MECHANISM mech;
+	CK_BYTE signature[8192];
+	CK_ULONG signatureLen = 0;
+	struct timespec start, end;
+
+	initSignMechanism(config, &mech, &param);
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hChildSession), "C_OpenSession");
+
+	for(int ctr=0; ctr<config->opsPerThread; ctr++)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		switch(config->operation)
+		{
+			case OP_KEYGEN:
+				checkOperation(generateKeyPair(hChildSession, config->alg, &hPub, &hPri), "C_GenerateKeyPair");
+				break;
+			case OP_SIGN:
+				signatureLen = sizeof(signature);
+				checkOperation(p11Func->C_SignInit(hChildSession, &mech, config->alg->hPrivate), "C_SignInit");
+				checkOperation(p11Func->C_Sign(hChildSession, config->message, config->messageLen, signature, &signatureLen), "C_Sign");
+				break;
+			case OP_VERIFY:
+				checkOperation(p11Func->C_VerifyInit(hChildSession, &mech, config->alg->hPublic), "C_VerifyInit");
+				checkOperation(p11Func->C_Verify(hChildSession, config->message, config->messageLen, config->signature, config->signatureLen), "C_Verify");
+				break;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		latencies[ctr] = elapsedMs(&start, &end);
+
+		if(config->operation==OP_KEYGEN)
+		{
+			checkOperation(p11Func->C_DestroyObject(hChildSession, hPri), "C_DestroyObject");
+			checkOperation(p11Func->C_DestroyObject(hChildSession, hPub), "C_DestroyObject");
+		}
+	}
+
+	checkOperation(p11Func->C_CloseSession(hChildSession), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Runs one measurement with nThreads threads and prints its result.
+void runMeasurement(RUN_CONFIG *config, const char *opName, int nThreads)
+{
+	pthread_t *workers = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	THREAD_ARG *args = (THREAD_ARG*)malloc(nThreads * sizeof(THREAD_ARG));
+	int total = nThreads * config->opsPerThread;
+	struct timespec start, end;
+	double wall, p50, p95, p99;
+
+	config->latencies = (double*)calloc(total, sizeof(double));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+	{
+		args[ctr].config = config;
+		args[ctr].index = ctr;
+		pthread_create(&workers[ctr], NULL, &runOperations, &args[ctr]);
+	}
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(workers[ctr], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	wall = elapsedMs(&start, &end);
+
+	qsort(config->latencies, total, sizeof(double), compareDouble);
+	p50 = config->latencies[(total * 50) / 100];
+	p95 = config->latencies[(total * 95) / 100 < total ? (total * 95) / 100 : total-1];
+	p99 = config->latencies[(total * 99) / 100 < total ? (total * 99) / 100 : total-1];
+
+	printf("  %-10s | %-13s | %8lu | %7d | %10.1f | %8lu | %9.2f | %9.2f | %9.2f\n",
+		config->alg->name, opName, config->operation==OP_KEYGEN ? 0 : config->messageLen, nThreads,
+		total / (wall / 1e3), config->operation==OP_KEYGEN ? 0 : config->signatureLen, p50, p95, p99);
+
+	free(config->latencies);
+	free(args);
+	free(workers);
+}
+
+
+
+// Runs a measurement for 1, 2, 4 ... maxThreads threads.
+void sweepThreads(RUN_CONFIG *config, const char *opName)
+{
+	for(int t=1; t<=maxThreads; t*=2)
+	{
+		int nThreads = (t*2>maxThreads) ? maxThreads : t;
+		runMeasurement(config, opName, nThreads);
+		if(nThreads==maxThreads)
+			break;
+	}
+}
+
+
+
+// Generates one keypair per algorithm for the sign and verify measurements.
+void generateKeys()
+{
+	for(int ctr=0; ctr<ALGORITHM_COUNT; ctr++)
+	{
+		checkOperation(generateKeyPair(hSession, &algorithms[ctr], &algorithms[ctr].hPublic, &algorithms[ctr].hPrivate), "C_GenerateKeyPair");
+		printf("  --> %s keypair generated. Private : %lu, Public : %lu.\n", algorithms[ctr].name, algorithms[ctr].hPrivate, algorithms[ctr].hPublic);
+	}
+}
+
+
+
+// Runs the complete benchmark.
+void runBenchmark()
+{
+	RUN_CONFIG config;
+	CK_SIGN_ADDITIONAL_CONTEXT param;
+	CK_MECHANISM mech;
+	CK_BYTE signature[8192];
+
+	message = (CK_BYTE*)malloc(messageSizes[MESSAGE_SIZE_COUNT-1]);
+	checkOperation(p11Func->C_GenerateRandom(hSession, message, messageSizes[MESSAGE_SIZE_COUNT-1]), "C_GenerateRandom");
+
+	printf("\n> Generating keypairs.\n");
+	generateKeys();
+
+	printf("\n  %-10s | %-13s | %8s | %7s | %10s | %8s | %9s | %9s | %9s\n", "algorithm", "operation", "msg", "threads", "ops/sec", "sig", "p50(ms)", "p95(ms)", "p99(ms)");
+	for(int a=0; a<ALGORITHM_COUNT; a++)
+	{
+		config.alg = &algorithms[a];
+		config.opsPerThread = opsPerThread;
+		config.message = message;
+		config.signature = signature;
+		config.hedgeVariant = CKH_DETERMINISTIC_REQUIRED;
+
+		config.operation = OP_KEYGEN;
+		sweepThreads(&config, "keygen");
+
+		for(int m=0; m<MESSAGE_SIZE_COUNT; m++)
+		{
+			config.messageLen = messageSizes[m];
+
+			// Computes one signature; its length is displayed and it is used by verify.
+			initSignMechanism(&config, &mech, &param);
+			config.signatureLen = sizeof(signature);
+			checkOperation(p11Func->C_SignInit(hSession, &mech, config.alg->hPrivate), "C_SignInit");
+			checkOperation(p11Func->C_Sign(hSession, config.message, config.messageLen, config.signature, &config.signatureLen), "C_Sign");
+
+			config.operation = OP_SIGN;
+			if(config.alg->family==ALG_ML_DSA)
+			{
+				config.hedgeVariant = CKH_HEDGE_REQUIRED;
+				sweepThreads(&config, "sign-hedged");
+				config.hedgeVariant = CKH_DETERMINISTIC_REQUIRED;
+				sweepThreads(&config, "sign-determ");
+			}
+			else
+				sweepThreads(&config, "sign");
+
+			config.operation = OP_VERIFY;
+			sweepThreads(&config, "verify");
+		}
+	}
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<5) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+	maxThreads = atoi((const char*)argv[3]);
+	opsPerThread = atoi((const char*)argv[4]);
+	if(maxThreads<1)
+		maxThreads = 1;
+	if(opsPerThread<1)
+		opsPerThread = 1;
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+	runBenchmark();
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
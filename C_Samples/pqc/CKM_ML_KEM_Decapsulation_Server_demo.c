@@ -0,0 +1,737 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2024 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+	OBJECTIVE :
+	- This sample demonstrates how to build a decapsulation service around a long-lived ML-KEM private key.
+	- In server mode, the sample listens on a local (Unix domain) socket and accepts ML-KEM ciphertexts.
+	- Each ciphertext is decapsulated into an AES-256 session key using CA_DecapsulateKey.
+	- Requests are served by a pool of worker threads, each with its own session.
+	- The server displays decapsulations per second and latency percentiles every 5 seconds, and a summary when stopped (Ctrl+C).
+	- In client mode, the sample encapsulates a few AES keys with the ML-KEM public key and sends the ciphertexts
+	  to the server from multiple threads, to measure the round trip throughput and latency.
+	- The ML-KEM keypair must exist on the partition as <LABEL>-prvkey and <LABEL>-pubkey (see CKM_ML_KEM_KEY_PAIR_GEN_demo.c).
+	  The parameter set (ML-KEM-512, 768 or 1024) is read from the key, and the expected ciphertext length is derived from it.
+	- Protocol :-
+		> Request  : ciphertext length (4 bytes, big endian) followed by the ciphertext.
+		> Response : CK_RV (4 bytes, big endian) followed by the handle of the decapsulated key (4 bytes, big endian).
+	- In this sample, the decapsulated key is destroyed once the response is sent. A real service would use it first.
+	- This sample uses Unix domain sockets and runs on Unix/Linux only.
+	- It requires firmware version 7.9.0 and Luna Client 10.9.0.
+*/
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <sfnt_extensions.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+#define MAX_CIPHERTEXT_LEN 1568
+#define CONNECTION_QUEUE_LEN 256
+#define REPORT_INTERVAL 5 // seconds
+#define CLIENT_CIPHERTEXTS 16 // Number of ciphertexts the client encapsulates and replays.
+
+
+// ML-KEM parameter sets and their ciphertext lengths.
+typedef struct
+{
+	CK_ML_KEM_PARAMETER_SET_TYPE paramType;
+	const char *name;
+	CK_ULONG cipherTextLen;
+} ML_KEM_PARAMETER;
+
+ML_KEM_PARAMETER mlKemParameters[] =
+{
+	{CKP_ML_KEM_512,	"ML-KEM-512",	768},
+	{CKP_ML_KEM_768,	"ML-KEM-768",	1088},
+	{CKP_ML_KEM_1024,	"ML-KEM-1024",	1568}
+};
+#define ML_KEM_PARAMETER_COUNT (sizeof(mlKemParameters)/sizeof(*mlKemParameters))
+
+
+// Latencies recorded since the last report.
+typedef struct
+{
+	double *values; // milliseconds
+	int count;
+	int capacity;
+} LATENCY_LOG;
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SFNT_CA_FUNCTION_LIST *sfntFunc = NULL;
+
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+char *privKeyLabel = NULL;
+char *pubKeyLabel = NULL;
+char *socketPath = NULL;
+ML_KEM_PARAMETER *mlKemParam = NULL;
+CK_OBJECT_HANDLE objHandlePub = 0;
+CK_OBJECT_HANDLE objHandlePri = 0;
+int nThreads = 0;
+int requestsPerThread = 0;
+
+// Template of the decapsulated AES-256 key.
+CK_BBOOL yes = CK_TRUE;
+CK_BBOOL no = CK_FALSE;
+CK_KEY_TYPE keyType = CKK_AES;
+CK_ULONG keySize = 32;
+CK_OBJECT_CLASS objClass = CKO_SECRET_KEY;
+CK_ATTRIBUTE aesKeyTemplate[] =
+{
+	{CKA_CLASS,		&objClass,	sizeof(CK_OBJECT_CLASS)},
+	{CKA_TOKEN,		&no,		sizeof(CK_BBOOL)},
+	{CKA_ENCRYPT,		&yes,		sizeof(CK_BBOOL)},
+	{CKA_DECRYPT,		&yes,		sizeof(CK_BBOOL)},
+	{CKA_KEY_TYPE,		&keyType,	sizeof(CK_KEY_TYPE)},
+	{CKA_VALUE_LEN,		&keySize,	sizeof(CK_ULONG)}
+};
+#define AES_KEY_TEMPLATE_LEN (sizeof(aesKeyTemplate)/sizeof(*aesKeyTemplate))
+
+// Server state.
+int listenFd = -1;
+volatile sig_atomic_t stopServer = 0;
+int connections[CONNECTION_QUEUE_LEN]; // Accepted connections waiting for a worker.
+int *activeConnections = NULL; // Connection served by each worker, or -1.
+int connectionHead = 0;
+int connectionCount = 0;
+pthread_mutex_t connectionLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t connectionReady = PTHREAD_COND_INITIALIZER;
+
+LATENCY_LOG intervalLog = {NULL, 0, 0};
+unsigned long long totalRequests = 0;
+unsigned long long totalFailures = 0;
+pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+	CK_CA_GetFunctionList CA_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+        	C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+		CA_GetFunctionList = (CK_CA_GetFunctionList)dlsym(libHandle, "CA_GetFunctionList");
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+		CA_GetFunctionList = (CK_CA_GetFunctionList)GetProcAddress(libHandle, "CA_GetFunctionList");
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+	CA_GetFunctionList(&sfntFunc); // Gets the list of all SFNT CA functions.
+
+        if(p11Func==NULL || sfntFunc==NULL)
+        {
+                printf("Failed to load required functions.\n");
+                exit(1);
+	}
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+        free(slotPin);
+	free(privKeyLabel);
+	free(pubKeyLabel);
+	free(intervalLog.values);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the time elapsed between two timestamps in milliseconds.
+double elapsedMs(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e3 + (end->tv_nsec - start->tv_nsec) / 1e6;
+}
+
+
+
+// Used by qsort to sort latencies.
+int compareDouble(const void *a, const void *b)
+{
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+
+
+// Sorts the latencies and prints rate and percentiles.
+void printLatencies(const char *title, double *values, int count, double seconds)
+{
+	if(count==0)
+	{
+		printf("  --> %s : no requests.\n", title);
+		return;
+	}
+	qsort(values, count, sizeof(double), compareDouble);
+	printf("  --> %s : %d requests, %.1f per second, p50 %.2f ms, p99 %.2f ms, max %.2f ms.\n",
+		title, count, count / seconds, values[count/2], values[(count*99)/100], values[count-1]);
+}
+
+
+
+// Reads exactly len bytes from a socket. Returns 0 on EOF or error.
+int readFull(int fd, void *buffer, size_t len)
+{
+	size_t done = 0;
+	ssize_t rc = 0;
+
+	while(done<len)
+	{
+		rc = read(fd, (char*)buffer + done, len - done);
+		if(rc<=0)
+			return 0;
+		done += rc;
+	}
+	return 1;
+}
+
+
+
+// Writes exactly len bytes to a socket. Returns 0 on error.
+int writeFull(int fd, const void *buffer, size_t len)
+{
+	size_t done = 0;
+	ssize_t rc = 0;
+
+	while(done<len)
+	{
+		rc = write(fd, (const char*)buffer + done, len - done);
+		if(rc<=0)
+			return 0;
+		done += rc;
+	}
+	return 1;
+}
+
+
+
+// Finds a key by its class and label.
+CK_OBJECT_HANDLE findKey(CK_OBJECT_CLASS keyClass, const char *label)
+{
+	CK_OBJECT_HANDLE handle = 0;
+	CK_ULONG objCount = 0;
+	CK_KEY_TYPE mlKemType = CKK_ML_KEM;
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_CLASS,	&keyClass,	sizeof(CK_OBJECT_CLASS)},
+		{CKA_KEY_TYPE,	&mlKemType,	sizeof(CK_KEY_TYPE)},
+		{CKA_LABEL,	(CK_VOID_PTR)label,	strlen(label)}
+	};
+
+	checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, 3), "C_FindObjectsInit");
+	checkOperation(p11Func->C_FindObjects(hSession, &handle, 1, &objCount), "C_FindObjects");
+	checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+	if(objCount==0)
+	{
+		printf("\nKey [ %s ] not found.\n", label);
+		disconnectFromLunaSlot();
+		freeMem();
+		exit(1);
+	}
+	return handle;
+}
+
+
+
+// Finds the ML-KEM key and reads its parameter set.
+void loadMLKEMKey(CK_OBJECT_CLASS keyClass)
+{
+	CK_ML_KEM_PARAMETER_SET_TYPE paramType = 0;
+	CK_ATTRIBUTE attrib[] = {{CKA_PARAMETER_SET, &paramType, sizeof(paramType)}};
+	CK_OBJECT_HANDLE hKey = 0;
+
+	if(keyClass==CKO_PRIVATE_KEY)
+		hKey = objHandlePri = findKey(CKO_PRIVATE_KEY, privKeyLabel);
+	else
+		hKey = objHandlePub = findKey(CKO_PUBLIC_KEY, pubKeyLabel);
+	checkOperation(p11Func->C_GetAttributeValue(hSession, hKey, attrib, 1), "C_GetAttributeValue");
+
+	for(int ctr=0; ctr<ML_KEM_PARAMETER_COUNT; ctr++)
+		if(mlKemParameters[ctr].paramType==paramType)
+			mlKemParam = &mlKemParameters[ctr];
+	if(mlKemParam==NULL)
+	{
+		printf("\nUnknown ML-KEM parameter set : %lu.\n", paramType);
+		disconnectFromLunaSlot();
+		freeMem();
+		exit(1);
+	}
+
+	printf("\n> ML-KEM key found.\n");
+	printf("  --> Handle : %lu\n", hKey);
+	printf("  --> Parameter set : %s\n", mlKemParam->name);
+	printf("  --> CipherText length : %lu\n", mlKemParam->cipherTextLen);
+}
+
+
+
+// Adds a latency to the current reporting interval.
+void recordLatency(double latency, CK_RV rv)
+{
+	pthread_mutex_lock(&statsLock);
+	if(intervalLog.count==intervalLog.capacity)
+	{
+		intervalLog.capacity = intervalLog.capacity ? intervalLog.capacity * 2 : 4096;
+		intervalLog.values = (double*)realloc(intervalLog.values, intervalLog.capacity * sizeof(double));
+	}
+	intervalLog.values[intervalLog.count++] = latency;
+	totalRequests++;
+	if(rv!=CKR_OK)
+		totalFailures++;
+	pthread_mutex_unlock(&statsLock);
+}
+
+
+
+// Serves all requests of one connection. The caller closes it.
+void serveConnection(int fd, CK_SESSION_HANDLE hWorkerSession)
+{
+	CK_MECHANISM mech = {CKM_ML_KEM};
+	CK_BYTE cipherText[MAX_CIPHERTEXT_LEN];
+	CK_OBJECT_HANDLE hKey = 0;
+	uint32_t length = 0;
+	uint32_t response[2];
+	struct timespec start, end;
+	CK_RV rv = CKR_OK;
+
+	while(readFull(fd, &length, sizeof(length)))
+	{
+		length = ntohl(length);
+		if(length!=mlKemParam->cipherTextLen)
+			break; // Protocol error, drops the connection.
+		if(!readFull(fd, cipherText, length))
+			break;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		hKey = 0;
+		rv = sfntFunc->CA_DecapsulateKey(hWorkerSession, &mech, objHandlePri, aesKeyTemplate, AES_KEY_TEMPLATE_LEN, cipherText, length, &hKey);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		recordLatency(elapsedMs(&start, &end), rv);
+
+		response[0] = htonl((uint32_t)rv);
+		response[1] = htonl((uint32_t)hKey);
+		if(!writeFull(fd, response, sizeof(response)))
+			break;
+		if(rv==CKR_OK)
+			p11Func->C_DestroyObject(hWorkerSession, hKey);
+	}
+}
+
+
+
+// Worker thread; takes accepted connections from the queue and serves them with its own session.
+void *decapsulationWorker(void *arg)
+{
+	int index = (int)(intptr_t)arg;
+	CK_SESSION_HANDLE hWorkerSession = 0;
+	int fd = -1;
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL_PTR, NULL_PTR, &hWorkerSession), "C_OpenSession");
+	while(1)
+	{
+		pthread_mutex_lock(&connectionLock);
+		while(connectionCount==0 && !stopServer)
+			pthread_cond_wait(&connectionReady, &connectionLock);
+		if(connectionCount==0)
+		{
+			pthread_mutex_unlock(&connectionLock);
+			break;
+		}
+		fd = connections[connectionHead];
+		connectionHead = (connectionHead + 1) % CONNECTION_QUEUE_LEN;
+		connectionCount--;
+		activeConnections[index] = fd; // Lets the server shut it down when stopping.
+		pthread_mutex_unlock(&connectionLock);
+
+		serveConnection(fd, hWorkerSession);
+
+		pthread_mutex_lock(&connectionLock);
+		activeConnections[index] = -1;
+		pthread_mutex_unlock(&connectionLock);
+		close(fd);
+	}
+	checkOperation(p11Func->C_CloseSession(hWorkerSession), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Reporter thread; prints the statistics of the last interval.
+void *reporter(void *arg)
+{
+	LATENCY_LOG snapshot;
+
+	while(!stopServer)
+	{
+		sleep(REPORT_INTERVAL);
+		pthread_mutex_lock(&statsLock);
+		snapshot = intervalLog;
+		intervalLog.values = NULL;
+		intervalLog.count = 0;
+		intervalLog.capacity = 0;
+		pthread_mutex_unlock(&statsLock);
+
+		printLatencies("Last interval", snapshot.values, snapshot.count, REPORT_INTERVAL);
+		free(snapshot.values);
+	}
+	return 0;
+}
+
+
+
+// Stops the accept loop on Ctrl+C.
+void onSignal(int signum)
+{
+	stopServer = 1;
+	if(listenFd>=0)
+	{
+		shutdown(listenFd, SHUT_RDWR);
+		close(listenFd);
+		listenFd = -1;
+	}
+}
+
+
+
+// Accepts connections on the local socket and hands them over to the worker pool.
+void runServer()
+{
+	pthread_t *workers = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	pthread_t reporterThread;
+	struct sockaddr_un addr;
+	struct timespec start, end;
+	int fd = -1;
+
+	listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path)-1);
+	unlink(socketPath);
+	if(listenFd<0 || bind(listenFd, (struct sockaddr*)&addr, sizeof(addr))!=0 || listen(listenFd, SOMAXCONN)!=0)
+	{
+		printf("Failed to listen on %s.\n", socketPath);
+		free(workers);
+		return;
+	}
+
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+	signal(SIGPIPE, SIG_IGN);
+
+	activeConnections = (int*)malloc(nThreads * sizeof(int));
+	for(int ctr=0; ctr<nThreads; ctr++)
+		activeConnections[ctr] = -1;
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&workers[ctr], NULL, &decapsulationWorker, (void*)(intptr_t)ctr);
+	pthread_create(&reporterThread, NULL, &reporter, NULL);
+
+	printf("\n> Listening on %s with %d sessions. Press Ctrl+C to stop.\n", socketPath, nThreads);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while(!stopServer)
+	{
+		fd = accept(listenFd, NULL, NULL);
+		if(fd<0)
+			continue;
+
+		pthread_mutex_lock(&connectionLock);
+		if(connectionCount==CONNECTION_QUEUE_LEN)
+		{
+			pthread_mutex_unlock(&connectionLock);
+			close(fd); // Too many pending connections.
+			continue;
+		}
+		connections[(connectionHead + connectionCount) % CONNECTION_QUEUE_LEN] = fd;
+		connectionCount++;
+		pthread_cond_signal(&connectionReady);
+		pthread_mutex_unlock(&connectionLock);
+	}
+
+	// Drops the pending connections, and wakes up the workers blocked reading from a connected client.
+	pthread_mutex_lock(&connectionLock);
+	while(connectionCount>0)
+	{
+		close(connections[connectionHead]);
+		connectionHead = (connectionHead + 1) % CONNECTION_QUEUE_LEN;
+		connectionCount--;
+	}
+	for(int ctr=0; ctr<nThreads; ctr++)
+		if(activeConnections[ctr]>=0)
+			shutdown(activeConnections[ctr], SHUT_RDWR);
+	pthread_cond_broadcast(&connectionReady);
+	pthread_mutex_unlock(&connectionLock);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(workers[ctr], NULL);
+	free(activeConnections);
+	pthread_join(reporterThread, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	unlink(socketPath);
+	free(workers);
+
+	printf("\n> Server stopped.\n");
+	printf("  --> Requests served : %llu, failed : %llu.\n", totalRequests, totalFailures);
+	printf("  --> Average rate : %.1f decapsulations per second.\n", totalRequests / (elapsedMs(&start, &end) / 1e3));
+}
+
+
+
+// Ciphertexts replayed by the client threads.
+CK_BYTE clientCipherTexts[CLIENT_CIPHERTEXTS][MAX_CIPHERTEXT_LEN];
+double *clientLatencies = NULL;
+int *clientCompleted = NULL; // Requests completed by each client thread.
+
+
+
+// Client thread; sends requestsPerThread ciphertexts over one connection and records the round trip latencies.
+void *clientWorker(void *arg)
+{
+	int index = (int)(intptr_t)arg;
+	double *latencies = clientLatencies + (index * requestsPerThread);
+	struct sockaddr_un addr;
+	struct timespec start, end;
+	uint32_t length = htonl((uint32_t)mlKemParam->cipherTextLen);
+	uint32_t response[2];
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path)-1);
+	if(fd<0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr))!=0)
+	{
+		printf("  --> Thread %d : cannot connect to %s.\n", index, socketPath);
+		return 0;
+	}
+
+	for(int ctr=0; ctr<requestsPerThread; ctr++)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if(!writeFull(fd, &length, sizeof(length)) ||
+		   !writeFull(fd, clientCipherTexts[(index + ctr) % CLIENT_CIPHERTEXTS], mlKemParam->cipherTextLen) ||
+		   !readFull(fd, response, sizeof(response)))
+		{
+			printf("  --> Thread %d : connection lost.\n", index);
+			break;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		latencies[ctr] = elapsedMs(&start, &end);
+		clientCompleted[index] = ctr + 1;
+		if(ntohl(response[0])!=CKR_OK)
+			printf("  --> Thread %d : CA_DecapsulateKey failed with Ox%X\n", index, ntohl(response[0]));
+	}
+	close(fd);
+	return 0;
+}
+
+
+
+// Encapsulates a few AES keys and replays the ciphertexts against the server.
+void runClient()
+{
+	CK_MECHANISM mech = {CKM_ML_KEM};
+	CK_OBJECT_HANDLE hKey = 0;
+	CK_ULONG cipherTextLen = 0;
+	pthread_t *workers = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	struct timespec start, end;
+	int completed = 0;
+
+	for(int ctr=0; ctr<CLIENT_CIPHERTEXTS; ctr++)
+	{
+		cipherTextLen = MAX_CIPHERTEXT_LEN;
+		checkOperation(sfntFunc->CA_EncapsulateKey(hSession, &mech, objHandlePub, aesKeyTemplate, AES_KEY_TEMPLATE_LEN, clientCipherTexts[ctr], &cipherTextLen, &hKey), "CA_EncapsulateKey");
+		checkOperation(p11Func->C_DestroyObject(hSession, hKey), "C_DestroyObject");
+	}
+	printf("\n> %d AES keys encapsulated.\n", CLIENT_CIPHERTEXTS);
+
+	clientLatencies = (double*)calloc(nThreads * requestsPerThread, sizeof(double));
+	clientCompleted = (int*)calloc(nThreads, sizeof(int));
+	printf("\n> Sending %d requests from %d threads to %s.\n", nThreads * requestsPerThread, nThreads, socketPath);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&workers[ctr], NULL, &clientWorker, (void*)(intptr_t)ctr);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(workers[ctr], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	// Keeps the latencies of the completed requests only; a thread stops early if its connection is lost.
+	for(int ctr=0; ctr<nThreads; ctr++)
+	{
+		memmove(clientLatencies + completed, clientLatencies + ctr * requestsPerThread, clientCompleted[ctr] * sizeof(double));
+		completed += clientCompleted[ctr];
+	}
+	printLatencies(mlKemParam->name, clientLatencies, completed, elapsedMs(&start, &end) / 1e3);
+	free(clientLatencies);
+	free(clientCompleted);
+	free(workers);
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> server <ML-KEM_keypair_label> <socket_path> <number_of_sessions>\n", exeName);
+	printf("%s <slot_number> <crypto_officer_password> client <ML-KEM_keypair_label> <socket_path> <number_of_threads> <requests_per_thread>\n\n", exeName);
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int isServer = 0;
+	int labelLen = 0;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<7) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+	if(strcmp((const char*)argv[3], "server")==0)
+		isServer = 1;
+	else if(strcmp((const char*)argv[3], "client")!=0 || argc<8)
+	{
+		usage((char*)argv[0]);
+		exit(1);
+	}
+
+	labelLen = strlen((const char*)argv[4]) + 8;
+	privKeyLabel = (char*)malloc(labelLen);
+	snprintf(privKeyLabel, labelLen, "%s-prvkey", (char*)argv[4]);
+	pubKeyLabel = (char*)malloc(labelLen);
+	snprintf(pubKeyLabel, labelLen, "%s-pubkey", (char*)argv[4]);
+	socketPath = (char*)argv[5];
+	nThreads = atoi((const char*)argv[6]);
+	if(nThreads<1)
+		nThreads = 1;
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+	if(isServer)
+	{
+		loadMLKEMKey(CKO_PRIVATE_KEY);
+		runServer();
+	}
+	else
+	{
+		requestsPerThread = atoi((const char*)argv[7]);
+		if(requestsPerThread<1)
+			requestsPerThread = 1;
+		loadMLKEMKey(CKO_PUBLIC_KEY);
+		runClient();
+	}
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,543 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to produce a hybrid (classical + post quantum) signature, as used by hybrid certificates.
+	- The same message is signed using ECDSA P-256 (CKM_ECDSA_SHA256) and ML-DSA-65 (CKM_ML_DSA).
+	- The two signatures are computed at the same time on two sessions. The ECDSA signature is computed by the
+	  calling thread while a helper thread computes the ML-DSA signature, so the latency of a hybrid signature
+	  is close to the latency of the slower of the two algorithms, instead of their sum.
+	- Both signatures are verified, and written to <file>.ecdsa.sig and <file>.mldsa.sig.
+	- The sample then signs the message repeatedly, one algorithm after the other and then concurrently,
+	  and compares the latency of both methods.
+	- Session keypairs are generated for this sample and destroyed when the session is closed.
+	- It requires firmware version 7.9.0 and Luna Client 10.9.0 or newer.
+*/
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+#define EC_SIGNATURE_LEN 256
+#define ML_DSA_SIGNATURE_LEN 8192
+
+
+// Signs with two keys on two sessions at the same time.
+// The ML-DSA signature is computed by a helper thread, which waits for requests between signatures.
+typedef struct
+{
+	CK_SESSION_HANDLE ecSession;
+	CK_SESSION_HANDLE pqSession;
+	CK_OBJECT_HANDLE ecKey;
+	CK_OBJECT_HANDLE pqKey;
+
+	pthread_t helper;
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+	int pending; // Set while the helper thread has a signature to compute.
+	int stop;
+
+	CK_BYTE *message;
+	CK_ULONG messageLen;
+	CK_BYTE *pqSignature;
+	CK_ULONG *pqSignatureLen;
+	CK_RV pqRv;
+} HYBRID_SIGNER;
+
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+
+CK_OBJECT_HANDLE ecPubKey = 0, ecPriKey = 0;
+CK_OBJECT_HANDLE pqPubKey = 0, pqPriKey = 0;
+CK_SIGN_ADDITIONAL_CONTEXT optionalParam; // Optional parameter for CKM_ML_DSA mechanism.
+CK_BYTE *message = NULL;
+CK_ULONG messageLen = 0;
+char *fileName = NULL;
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+        free(slotPin);
+	free(message);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the time elapsed between two timestamps in milliseconds.
+double elapsedMs(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e3 + (end->tv_nsec - start->tv_nsec) / 1e6;
+}
+
+
+
+// Used by qsort to sort latencies.
+int compareDouble(const void *a, const void *b)
+{
+	double x = *(const double*)a;
+	double y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+
+
+// Reads the message to sign.
+void readFile()
+{
+	FILE *fileRead = fopen(fileName, "rb");
+	long fileSize = 0;
+
+	if(!fileRead)
+	{
+		fprintf(stderr, "Failed to read %s.\n", fileName);
+		exit(1);
+	}
+	fseek(fileRead, 0, SEEK_END);
+	fileSize = ftell(fileRead);
+	rewind(fileRead);
+
+	message = (CK_BYTE*)malloc(fileSize > 0 ? fileSize : 1);
+	messageLen = fread(message, sizeof(CK_BYTE), fileSize, fileRead);
+	fclose(fileRead);
+	printf("\n> Message read from %s (%lu bytes).\n", fileName, messageLen);
+}
+
+
+
+// Generates the ECDSA P-256 and ML-DSA-65 session keypairs.
+void generateKeyPairs()
+{
+	CK_MECHANISM ecMech = {CKM_EC_KEY_PAIR_GEN};
+	CK_MECHANISM pqMech = {CKM_ML_DSA_KEY_PAIR_GEN};
+	CK_BBOOL yes = CK_TRUE;
+	CK_BBOOL no = CK_FALSE;
+	CK_OBJECT_CLASS objClassPub = CKO_PUBLIC_KEY;
+	CK_OBJECT_CLASS objClassPri = CKO_PRIVATE_KEY;
+	CK_ML_DSA_PARAMETER_SET_TYPE paramType = CKP_ML_DSA_65;
+	CK_BYTE ecParam[] = {0x06,0x08,0x2A,0x86,0x48,0xCE,0x3D,0x03,0x01,0x07}; // prime256v1
+
+	// The last entry is the EC curve or the ML-DSA parameter set.
+	CK_ATTRIBUTE attribPub[] =
+	{
+		{CKA_TOKEN,             &no,            sizeof(CK_BBOOL)},
+		{CKA_CLASS,             &objClassPub,   sizeof(CK_OBJECT_CLASS)},
+		{CKA_PRIVATE,           &no,            sizeof(CK_BBOOL)},
+		{CKA_VERIFY,            &yes,           sizeof(CK_BBOOL)},
+		{CKA_EC_PARAMS,         ecParam,        sizeof(ecParam)}
+	};
+	CK_ULONG attribPubLen = sizeof(attribPub) / sizeof(*attribPub);
+
+	CK_ATTRIBUTE attribPri[] =
+	{
+		{CKA_TOKEN,             &no,            sizeof(CK_BBOOL)},
+		{CKA_PRIVATE,           &yes,           sizeof(CK_BBOOL)},
+		{CKA_SENSITIVE,         &yes,           sizeof(CK_BBOOL)},
+		{CKA_MODIFIABLE,        &no,            sizeof(CK_BBOOL)},
+		{CKA_EXTRACTABLE,       &no,            sizeof(CK_BBOOL)},
+		{CKA_SIGN,              &yes,           sizeof(CK_BBOOL)},
+		{CKA_CLASS,             &objClassPri,   sizeof(CK_OBJECT_CLASS)}
+	};
+	CK_ULONG attribPriLen = sizeof(attribPri) / sizeof(*attribPri);
+
+	checkOperation(p11Func->C_GenerateKeyPair(hSession, &ecMech, attribPub, attribPubLen, attribPri, attribPriLen, &ecPubKey, &ecPriKey), "C_GenerateKeyPair");
+
+	attribPub[4].type = CKA_PARAMETER_SET;
+	attribPub[4].pValue = &paramType;
+	attribPub[4].ulValueLen = sizeof(CK_ML_DSA_PARAMETER_SET_TYPE);
+	checkOperation(p11Func->C_GenerateKeyPair(hSession, &pqMech, attribPub, attribPubLen, attribPri, attribPriLen, &pqPubKey, &pqPriKey), "C_GenerateKeyPair");
+
+	printf("\n> Keypairs generated.\n");
+	printf("  --> ECDSA P-256 private key handle : %lu, public key handle : %lu\n", ecPriKey, ecPubKey);
+	printf("  --> ML-DSA-65 private key handle : %lu, public key handle : %lu\n", pqPriKey, pqPubKey);
+}
+
+
+
+// Signs a message with CKM_ECDSA_SHA256.
+CK_RV signECDSA(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE hKey, CK_BYTE *data, CK_ULONG dataLen, CK_BYTE *signature, CK_ULONG *signatureLen)
+{
+	CK_MECHANISM mech = {CKM_ECDSA_SHA256};
+	CK_RV rv = p11Func->C_SignInit(session, &mech, hKey);
+	*signatureLen = EC_SIGNATURE_LEN;
+	return (rv==CKR_OK) ? p11Func->C_Sign(session, data, dataLen, signature, signatureLen) : rv;
+}
+
+
+
+// Signs a message with CKM_ML_DSA.
+CK_RV signMLDSA(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE hKey, CK_BYTE *data, CK_ULONG dataLen, CK_BYTE *signature, CK_ULONG *signatureLen)
+{
+	CK_MECHANISM mech = {CKM_ML_DSA, &optionalParam, sizeof(optionalParam)};
+	CK_RV rv = p11Func->C_SignInit(session, &mech, hKey);
+	*signatureLen = ML_DSA_SIGNATURE_LEN;
+	return (rv==CKR_OK) ? p11Func->C_Sign(session, data, dataLen, signature, signatureLen) : rv;
+}
+
+
+
+// Helper thread of the hybrid signer; computes the ML-DSA signature of each request.
+void *hybridHelper(void *arg)
+{
+	HYBRID_SIGNER *signer = (HYBRID_SIGNER*)arg;
+	CK_RV rv = CKR_OK;
+
+	pthread_mutex_lock(&signer->lock);
+	while(1)
+	{
+		while(!signer->pending && !signer->stop)
+			pthread_cond_wait(&signer->changed, &signer->lock);
+		if(signer->stop)
+			break;
+		pthread_mutex_unlock(&signer->lock);
+
+		rv = signMLDSA(signer->pqSession, signer->pqKey, signer->message, signer->messageLen, signer->pqSignature, signer->pqSignatureLen);
+
+		pthread_mutex_lock(&signer->lock);
+		signer->pqRv = rv;
+		signer->pending = 0;
+		pthread_cond_broadcast(&signer->changed);
+	}
+	pthread_mutex_unlock(&signer->lock);
+	return 0;
+}
+
+
+
+// Opens the two sessions of the hybrid signer and starts its helper thread.
+void hybridSignerInit(HYBRID_SIGNER *signer, CK_OBJECT_HANDLE ecKey, CK_OBJECT_HANDLE pqKey)
+{
+	memset(signer, 0, sizeof(HYBRID_SIGNER));
+	signer->ecKey = ecKey;
+	signer->pqKey = pqKey;
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &signer->ecSession), "C_OpenSession");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &signer->pqSession), "C_OpenSession");
+	pthread_mutex_init(&signer->lock, NULL);
+	pthread_cond_init(&signer->changed, NULL);
+	pthread_create(&signer->helper, NULL, &hybridHelper, signer);
+}
+
+
+
+// Computes both signatures of a message at the same time.
+CK_RV hybridSign(HYBRID_SIGNER *signer, CK_BYTE *data, CK_ULONG dataLen, CK_BYTE *ecSignature, CK_ULONG *ecSignatureLen, CK_BYTE *pqSignature, CK_ULONG *pqSignatureLen)
+{
+	CK_RV rv = CKR_OK;
+
+	pthread_mutex_lock(&signer->lock);
+	signer->message = data;
+	signer->messageLen = dataLen;
+	signer->pqSignature = pqSignature;
+	signer->pqSignatureLen = pqSignatureLen;
+	signer->pending = 1;
+	pthread_cond_broadcast(&signer->changed);
+	pthread_mutex_unlock(&signer->lock);
+
+	rv = signECDSA(signer->ecSession, signer->ecKey, data, dataLen, ecSignature, ecSignatureLen);
+
+	pthread_mutex_lock(&signer->lock);
+	while(signer->pending)
+		pthread_cond_wait(&signer->changed, &signer->lock);
+	pthread_mutex_unlock(&signer->lock);
+
+	return (rv!=CKR_OK) ? rv : signer->pqRv;
+}
+
+
+
+// Stops the helper thread and closes the sessions of the hybrid signer.
+void hybridSignerFinal(HYBRID_SIGNER *signer)
+{
+	pthread_mutex_lock(&signer->lock);
+	signer->stop = 1;
+	pthread_cond_broadcast(&signer->changed);
+	pthread_mutex_unlock(&signer->lock);
+	pthread_join(signer->helper, NULL);
+	pthread_mutex_destroy(&signer->lock);
+	pthread_cond_destroy(&signer->changed);
+	checkOperation(p11Func->C_CloseSession(signer->ecSession), "C_CloseSession");
+	checkOperation(p11Func->C_CloseSession(signer->pqSession), "C_CloseSession");
+}
+
+
+
+// Writes a signature to <file><extension>.
+void writeSignature(const char *extension, CK_BYTE *signature, CK_ULONG signatureLen)
+{
+	char signatureFileName[1024];
+	FILE *sigWrite = NULL;
+
+	snprintf(signatureFileName, sizeof(signatureFileName), "%s%s", fileName, extension);
+	sigWrite = fopen(signatureFileName, "wb");
+	if(!sigWrite)
+	{
+		fprintf(stderr, "Failed to write %s.\n", signatureFileName);
+		return;
+	}
+	fwrite(signature, sizeof(CK_BYTE), signatureLen, sigWrite);
+	fclose(sigWrite);
+	printf("  --> Signature written to file : %s.\n", signatureFileName);
+}
+
+
+
+// Signs the message once with the hybrid signer, verifies both signatures and writes them.
+void signAndVerify(HYBRID_SIGNER *signer)
+{
+	CK_MECHANISM ecMech = {CKM_ECDSA_SHA256};
+	CK_MECHANISM pqMech = {CKM_ML_DSA, &optionalParam, sizeof(optionalParam)};
+	CK_BYTE ecSignature[EC_SIGNATURE_LEN];
+	CK_BYTE pqSignature[ML_DSA_SIGNATURE_LEN];
+	CK_ULONG ecSignatureLen = 0, pqSignatureLen = 0;
+
+	checkOperation(hybridSign(signer, message, messageLen, ecSignature, &ecSignatureLen, pqSignature, &pqSignatureLen), "hybridSign");
+	printf("\n> Hybrid signature computed.\n");
+	printf("  --> ECDSA P-256 signature length : %lu.\n", ecSignatureLen);
+	printf("  --> ML-DSA-65 signature length : %lu.\n", pqSignatureLen);
+
+	checkOperation(p11Func->C_VerifyInit(hSession, &ecMech, ecPubKey), "C_VerifyInit");
+	checkOperation(p11Func->C_Verify(hSession, message, messageLen, ecSignature, ecSignatureLen), "C_Verify");
+	checkOperation(p11Func->C_VerifyInit(hSession, &pqMech, pqPubKey), "C_VerifyInit");
+	checkOperation(p11Func->C_Verify(hSession, message, messageLen, pqSignature, pqSignatureLen), "C_Verify");
+	printf("  --> Both signatures verified.\n");
+
+	writeSignature(".ecdsa.sig", ecSignature, ecSignatureLen);
+	writeSignature(".mldsa.sig", pqSignature, pqSignatureLen);
+}
+
+
+
+// Prints the latencies of a run.
+void printLatencies(const char *title, double *latencies, int count)
+{
+	double total = 0;
+
+	for(int ctr=0; ctr<count; ctr++)
+		total += latencies[ctr];
+	qsort(latencies, count, sizeof(double), compareDouble);
+	printf("  --> %-12s : mean %8.2f ms, p50 %8.2f ms, p99 %8.2f ms.\n", title, total / count, latencies[count/2], latencies[(count*99)/100]);
+}
+
+
+
+// Compares the latency of the two signatures computed one after the other, and at the same time.
+void benchmark(HYBRID_SIGNER *signer, int iterations)
+{
+	CK_BYTE ecSignature[EC_SIGNATURE_LEN];
+	CK_BYTE pqSignature[ML_DSA_SIGNATURE_LEN];
+	CK_ULONG ecSignatureLen = 0, pqSignatureLen = 0;
+	double *ecLatencies = (double*)malloc(iterations * sizeof(double));
+	double *pqLatencies = (double*)malloc(iterations * sizeof(double));
+	double *sequential = (double*)malloc(iterations * sizeof(double));
+	double *concurrent = (double*)malloc(iterations * sizeof(double));
+	double sequentialTotal = 0, concurrentTotal = 0;
+	struct timespec start, middle, end;
+
+	printf("\n> Signing the message %d times.\n", iterations);
+	for(int ctr=0; ctr<iterations; ctr++)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		checkOperation(signECDSA(hSession, ecPriKey, message, messageLen, ecSignature, &ecSignatureLen), "C_Sign");
+		clock_gettime(CLOCK_MONOTONIC, &middle);
+		checkOperation(signMLDSA(hSession, pqPriKey, message, messageLen, pqSignature, &pqSignatureLen), "C_Sign");
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		ecLatencies[ctr] = elapsedMs(&start, &middle);
+		pqLatencies[ctr] = elapsedMs(&middle, &end);
+		sequential[ctr] = elapsedMs(&start, &end);
+		sequentialTotal += sequential[ctr];
+	}
+
+	for(int ctr=0; ctr<iterations; ctr++)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		checkOperation(hybridSign(signer, message, messageLen, ecSignature, &ecSignatureLen, pqSignature, &pqSignatureLen), "hybridSign");
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		concurrent[ctr] = elapsedMs(&start, &end);
+		concurrentTotal += concurrent[ctr];
+	}
+
+	printLatencies("ECDSA P-256", ecLatencies, iterations);
+	printLatencies("ML-DSA-65", pqLatencies, iterations);
+	printLatencies("Sequential", sequential, iterations);
+	printLatencies("Concurrent", concurrent, iterations);
+	printf("  --> Concurrent signing takes %.0f%% of the sequential latency.\n", 100.0 * concurrentTotal / sequentialTotal);
+
+	free(ecLatencies);
+	free(pqLatencies);
+	free(sequential);
+	free(concurrent);
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> <file_to_sign> <iterations>\n\n", exeName);
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	HYBRID_SIGNER signer;
+	int iterations = 0;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<5) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+	fileName = (char*)argv[3];
+	iterations = atoi((const char*)argv[4]);
+	if(iterations<1)
+		iterations = 1;
+
+	optionalParam.hedgeVariant = CKH_HEDGE_PREFERRED;
+	optionalParam.pContext = NULL;
+	optionalParam.ulContextLen = 0;
+
+	readFile();
+	loadLunaLibrary();
+	connectToLunaSlot();
+	generateKeyPairs();
+
+	hybridSignerInit(&signer, ecPriKey, pqPriKey);
+	signAndVerify(&signer);
+	benchmark(&signer, iterations);
+	hybridSignerFinal(&signer);
+
+	disconnectFromLunaSlot();
+	freeMem();
+	return 0;
+}
@@ -0,0 +1,839 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to move a large number of ML-DSA and ML-KEM private keys from one partition to another.
+	- In wrap mode, all private keys matching a key type (and optionally a label prefix) are found, wrapped by
+	  multiple threads using CKM_AES_KWP, and written to an archive file as soon as they are wrapped.
+	  Every write is checked and the archive is synced to disk before success is reported. Its header holds the
+	  number of records written; keys that failed to wrap are reported and are not in the archive.
+	- If the archive cannot be written, wrapping stops and the sample exits with an error.
+	- In unwrap mode, the archive is read one record at a time and the keys are unwrapped by multiple threads.
+	- Unwrap mode reports an archive that holds fewer records than its header says.
+	- Unwrap mode is resumable. A progress file records the keys that are started and done; when the sample is run
+	  again, finished keys are skipped, and keys that were started but not recorded as done are looked up by label
+	  and CKA_ID before being unwrapped again.
+	- The label, CKA_ID, key type, parameter set, usage (CKA_SIGN / CKA_DECAPSULATE) and CKA_EXTRACTABLE of each key
+	  are kept in the archive. Keys without a CKA_ID are unwrapped without one.
+	- The same AES wrapping key must exist in both partitions.
+	- It requires firmware version 7.9.1 and Lunaclient 10.9.0 or later to execute.
+*/
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+        #include <unistd.h> // For fsync.
+#else
+        #include <windows.h> // For Windows OS.
+        #include <io.h> // For _commit.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+
+#define ARCHIVE_MAGIC 0x50514B41 // "PQKA"
+#define RECORD_MAGIC 0x50514B52 // "PQKR"
+#define FIND_BATCH 256
+#define MAX_ATTRIBUTE_LEN 65536 // Largest label or CKA_ID accepted in an archive.
+#define WRAPPED_BUFFER_LEN 16384
+#define PROGRESS_INTERVAL 1000
+
+#define USAGE_SIGN 0x1
+#define USAGE_DECAPSULATE 0x2
+#define USAGE_EXTRACTABLE 0x4 // Not a usage, but kept in the same field.
+
+
+// One wrapped key of the archive.
+// On disk, the fields are big endian 32-bit values, followed by the label, the CKA_ID and the wrapped key.
+// The label and CKA_ID buffers grow as needed; a record is reused for all the keys of a thread.
+typedef struct
+{
+	uint32_t sequence; // Position of the record in the archive, used by the progress file.
+	uint32_t keyType;
+	uint32_t parameterSet;
+	uint32_t usage;
+	uint32_t labelLen;
+	uint32_t idLen;
+	uint32_t wrappedLen;
+	uint32_t labelCapacity;
+	uint32_t idCapacity;
+	CK_BYTE *label;
+	CK_BYTE *id;
+	CK_BYTE wrapped[WRAPPED_BUFFER_LEN];
+} KEY_RECORD;
+
+
+
+CK_FUNCTION_LIST *p11Func = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL; // slot password
+CK_OBJECT_HANDLE hWrappingKey = 0; // stores the wrapping key handle.
+CK_BYTE iv[] = {0x1, 0x2, 0x3, 0x4};
+
+CK_OBJECT_HANDLE *keyHandles = NULL; // Keys found in wrap mode.
+uint32_t keyCount = 0; // Keys to wrap, or records in the archive.
+uint32_t nextKey = 0;
+FILE *archive = NULL;
+uint32_t recordsWritten = 0;
+uint32_t recordsRead = 0;
+int writeFailed = 0; // Set when a record could not be written; stops the wrapping.
+pthread_mutex_t archiveLock = PTHREAD_MUTEX_INITIALIZER;
+
+FILE *progress = NULL;
+unsigned char *progressState = NULL; // 0 : not started, 1 : started, 2 : done.
+uint32_t keysDone = 0;
+uint32_t keysSkipped = 0;
+uint32_t keysFailed = 0;
+pthread_mutex_t progressLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+        CK_C_GetFunctionList C_GetFunctionList = NULL;
+
+        char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+        if(libPath==NULL)
+        {
+                printf("P11_LIB environment variable not set.\n");
+                printf("\n > On Unix/Linux :-\n");
+                printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\n > On Windows :-\n");
+                printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+                printf("\n\nExample :-");
+                printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+                printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+                libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+        #else
+                libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+        #endif
+        if(!libHandle)
+        {
+                printf("Failed to load Luna library from path : %s\n", libPath);
+                exit(1);
+        }
+
+
+        #ifdef OS_UNIX
+            C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+                C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+        C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+        if(p11Func==NULL)
+        {
+                printf("Failed to load P11 functions.\n");
+                exit(1);
+        }
+
+        printf ("\n> P11 library loaded.\n");
+        printf ("  --> %s\n", libPath);
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+        free(slotPin);
+	free(keyHandles);
+	free(progressState);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+	checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+	checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+	printf("\n> Connected to Luna.\n");
+	printf("  --> SLOT ID : %ld.\n", slotId);
+	printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+	checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+	checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+	checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+	printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the seconds elapsed since start.
+double secondsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+
+// Big endian helpers for the archive.
+int writeUint32(FILE *file, uint32_t value)
+{
+	CK_BYTE out[4] = {(CK_BYTE)(value >> 24), (CK_BYTE)(value >> 16), (CK_BYTE)(value >> 8), (CK_BYTE)value};
+	return fwrite(out, 1, 4, file)==4;
+}
+
+int readUint32(FILE *file, uint32_t *value)
+{
+	CK_BYTE in[4];
+	if(fread(in, 1, 4, file)!=4)
+		return 0;
+	*value = ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+	return 1;
+}
+
+
+
+// Makes sure that a buffer can hold length bytes.
+int reserve(CK_BYTE **buffer, uint32_t *capacity, uint32_t length)
+{
+	CK_BYTE *grown = NULL;
+
+	if(length<=*capacity)
+		return 1;
+	grown = (CK_BYTE*)realloc(*buffer, length);
+	if(!grown)
+		return 0;
+	*buffer = grown;
+	*capacity = length;
+	return 1;
+}
+
+
+
+void freeRecord(KEY_RECORD *record)
+{
+	free(record->label);
+	free(record->id);
+	free(record);
+}
+
+
+
+// Appends a record to the archive, numbered in the order the records are written.
+// Returns 0 if it could not be written; no record is written after a failure.
+int writeRecord(KEY_RECORD *record)
+{
+	int ok = 0;
+
+	pthread_mutex_lock(&archiveLock);
+	record->sequence = recordsWritten;
+	ok = !writeFailed &&
+		writeUint32(archive, RECORD_MAGIC) &&
+		writeUint32(archive, record->sequence) &&
+		writeUint32(archive, record->keyType) &&
+		writeUint32(archive, record->parameterSet) &&
+		writeUint32(archive, record->usage) &&
+		writeUint32(archive, record->labelLen) &&
+		writeUint32(archive, record->idLen) &&
+		writeUint32(archive, record->wrappedLen) &&
+		fwrite(record->label, 1, record->labelLen, archive)==record->labelLen &&
+		fwrite(record->id, 1, record->idLen, archive)==record->idLen &&
+		fwrite(record->wrapped, 1, record->wrappedLen, archive)==record->wrappedLen;
+	if(ok)
+		recordsWritten++;
+	else
+		writeFailed = 1;
+	pthread_mutex_unlock(&archiveLock);
+	return ok;
+}
+
+
+
+// Writes the number of records to the header and flushes the archive to disk. Returns 0 on failure.
+int finishArchive()
+{
+	if(fflush(archive)!=0 || fseek(archive, 0, SEEK_SET)!=0 ||
+	   !writeUint32(archive, ARCHIVE_MAGIC) || !writeUint32(archive, recordsWritten) || fflush(archive)!=0)
+		return 0;
+	#ifdef OS_UNIX
+		return fsync(fileno(archive))==0;
+	#else
+		return _commit(_fileno(archive))==0;
+	#endif
+}
+
+
+
+// Reads the next record of the archive. Returns 0 at the end of the archive.
+int readRecord(KEY_RECORD *record)
+{
+	uint32_t magic = 0;
+	int ok = 0;
+
+	pthread_mutex_lock(&archiveLock);
+	ok = recordsRead<keyCount && readUint32(archive, &magic) && magic==RECORD_MAGIC &&
+		readUint32(archive, &record->sequence) && readUint32(archive, &record->keyType) &&
+		readUint32(archive, &record->parameterSet) && readUint32(archive, &record->usage) &&
+		readUint32(archive, &record->labelLen) && readUint32(archive, &record->idLen) &&
+		readUint32(archive, &record->wrappedLen) &&
+		record->labelLen<=MAX_ATTRIBUTE_LEN && record->idLen<=MAX_ATTRIBUTE_LEN && record->wrappedLen<=WRAPPED_BUFFER_LEN &&
+		reserve(&record->label, &record->labelCapacity, record->labelLen) &&
+		reserve(&record->id, &record->idCapacity, record->idLen) &&
+		record->sequence<keyCount &&
+		fread(record->label, 1, record->labelLen, archive)==record->labelLen &&
+		fread(record->id, 1, record->idLen, archive)==record->idLen &&
+		fread(record->wrapped, 1, record->wrappedLen, archive)==record->wrappedLen;
+	if(ok)
+		recordsRead++;
+	pthread_mutex_unlock(&archiveLock);
+	return ok;
+}
+
+
+
+// This function finds the wrapping AES key.
+void findWrappingKey(const char *wrappingKeyLabel)
+{
+	CK_OBJECT_CLASS objClass = CKO_SECRET_KEY;
+	CK_KEY_TYPE keyType = CKK_AES;
+	CK_ULONG objectCount = 0;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_CLASS,                     &objClass,              sizeof(CK_OBJECT_CLASS)},
+		{CKA_KEY_TYPE,                  &keyType,               sizeof(CK_KEY_TYPE)},
+		{CKA_LABEL,                     (CK_VOID_PTR)wrappingKeyLabel,       strlen(wrappingKeyLabel)}
+	};
+	CK_ULONG attribLen = sizeof(attrib) / sizeof(*attrib);
+	checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, attribLen), "C_FindObjectsInit");
+	checkOperation(p11Func->C_FindObjects(hSession, &hWrappingKey, 1, &objectCount), "C_FindObjects");
+	checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+	if(objectCount==0)
+	{
+		printf("\n> Wrapping key not found.\n");
+		disconnectFromLunaSlot();
+		freeMem();
+		exit(1);
+	}
+	printf("\n> Wrapping key found. Handle : %lu\n", hWrappingKey);
+}
+
+
+
+// Finds all token private keys of a key type, in batches of FIND_BATCH handles.
+void findPrivateKeys(CK_KEY_TYPE keyType)
+{
+	CK_BBOOL yes = CK_TRUE;
+	CK_OBJECT_CLASS objClass = CKO_PRIVATE_KEY;
+	CK_ULONG objectCount = 0;
+	uint32_t capacity = keyCount;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_TOKEN,	&yes,		sizeof(CK_BBOOL)},
+		{CKA_CLASS,	&objClass,	sizeof(CK_OBJECT_CLASS)},
+		{CKA_KEY_TYPE,	&keyType,	sizeof(CK_KEY_TYPE)}
+	};
+
+	checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, 3), "C_FindObjectsInit");
+	do
+	{
+		if(keyCount + FIND_BATCH>capacity)
+		{
+			capacity = (capacity + FIND_BATCH) * 2;
+			keyHandles = (CK_OBJECT_HANDLE*)realloc(keyHandles, capacity * sizeof(CK_OBJECT_HANDLE));
+		}
+		checkOperation(p11Func->C_FindObjects(hSession, keyHandles + keyCount, FIND_BATCH, &objectCount), "C_FindObjects");
+		keyCount += objectCount;
+	} while(objectCount==FIND_BATCH);
+	checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+}
+
+
+
+// Reads a label or CKA_ID into a buffer that is grown to the size of the value.
+// A key without the attribute gets a length of 0.
+CK_RV getBytesAttribute(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE hKey, CK_ATTRIBUTE_TYPE type,
+			CK_BYTE **buffer, uint32_t *capacity, uint32_t *length)
+{
+	CK_ATTRIBUTE attrib = {type, NULL, 0};
+	CK_RV rv = p11Func->C_GetAttributeValue(session, hKey, &attrib, 1);
+
+	*length = 0;
+	if(rv==CKR_ATTRIBUTE_TYPE_INVALID)
+		return CKR_OK;
+	if(rv!=CKR_OK)
+		return rv;
+	if(attrib.ulValueLen>MAX_ATTRIBUTE_LEN || !reserve(buffer, capacity, (uint32_t)attrib.ulValueLen))
+		return CKR_HOST_MEMORY;
+
+	attrib.pValue = *buffer;
+	rv = p11Func->C_GetAttributeValue(session, hKey, &attrib, 1);
+	if(rv==CKR_OK)
+		*length = (uint32_t)attrib.ulValueLen;
+	return rv;
+}
+
+
+
+// Removes the keys whose label does not start with the prefix.
+void filterByLabelPrefix(const char *prefix)
+{
+	CK_BYTE *label = NULL;
+	uint32_t labelCapacity = 0;
+	uint32_t labelLen = 0;
+	uint32_t kept = 0;
+	size_t prefixLen = strlen(prefix);
+
+	for(uint32_t ctr=0; ctr<keyCount; ctr++)
+	{
+		if(getBytesAttribute(hSession, keyHandles[ctr], CKA_LABEL, &label, &labelCapacity, &labelLen)==CKR_OK &&
+		   labelLen>=prefixLen && memcmp(label, prefix, prefixLen)==0)
+			keyHandles[kept++] = keyHandles[ctr];
+	}
+	free(label);
+	keyCount = kept;
+}
+
+
+
+// Reads the attributes of a key and wraps it.
+CK_RV wrapKey(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE hKey, KEY_RECORD *record)
+{
+	CK_MECHANISM mech = {CKM_AES_KWP, iv, sizeof(iv)};
+	CK_KEY_TYPE keyType = 0;
+	CK_ULONG parameterSet = 0;
+	CK_BBOOL canSign = CK_FALSE;
+	CK_BBOOL canDecapsulate = CK_FALSE;
+	CK_BBOOL extractable = CK_FALSE;
+	CK_ULONG wrappedLen = WRAPPED_BUFFER_LEN;
+	CK_RV rv = CKR_OK;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_KEY_TYPE,		&keyType,	sizeof(CK_KEY_TYPE)},
+		{CKA_PARAMETER_SET,	&parameterSet,	sizeof(CK_ULONG)}
+	};
+	CK_ATTRIBUTE usage[] =
+	{
+		{CKA_SIGN,		&canSign,	sizeof(CK_BBOOL)},
+		{CKA_DECAPSULATE,	&canDecapsulate,	sizeof(CK_BBOOL)},
+		{CKA_EXTRACTABLE,	&extractable,	sizeof(CK_BBOOL)}
+	};
+
+	rv = p11Func->C_GetAttributeValue(session, hKey, attrib, 2);
+	if(rv!=CKR_OK)
+		return rv;
+	// The label and CKA_ID are read one at a time, so a key without a CKA_ID is still wrapped.
+	rv = getBytesAttribute(session, hKey, CKA_LABEL, &record->label, &record->labelCapacity, &record->labelLen);
+	if(rv!=CKR_OK)
+		return rv;
+	rv = getBytesAttribute(session, hKey, CKA_ID, &record->id, &record->idCapacity, &record->idLen);
+	if(rv!=CKR_OK)
+		return rv;
+	p11Func->C_GetAttributeValue(session, hKey, usage, 3); // One of the usages is not defined for each key type.
+
+	record->keyType = (uint32_t)keyType;
+	record->parameterSet = (uint32_t)parameterSet;
+	record->usage = 0;
+	if(usage[0].ulValueLen==sizeof(CK_BBOOL) && canSign)
+		record->usage |= USAGE_SIGN;
+	if(usage[1].ulValueLen==sizeof(CK_BBOOL) && canDecapsulate)
+		record->usage |= USAGE_DECAPSULATE;
+	if(usage[2].ulValueLen==sizeof(CK_BBOOL) && extractable)
+		record->usage |= USAGE_EXTRACTABLE;
+
+	rv = p11Func->C_WrapKey(session, &mech, hWrappingKey, hKey, record->wrapped, &wrappedLen);
+	record->wrappedLen = (uint32_t)wrappedLen;
+	return rv;
+}
+
+
+
+// Wrapping thread; wraps keys until none are left, and appends them to the archive.
+void *wrapper(void *arg)
+{
+	CK_SESSION_HANDLE session = 0;
+	KEY_RECORD *record = (KEY_RECORD*)calloc(1, sizeof(KEY_RECORD));
+	uint32_t index = 0;
+	int written = 0;
+	CK_RV rv = CKR_OK;
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &session), "C_OpenSession");
+	while(1)
+	{
+		pthread_mutex_lock(&progressLock);
+		index = writeFailed ? keyCount : nextKey++;
+		pthread_mutex_unlock(&progressLock);
+		if(index>=keyCount)
+			break;
+
+		rv = wrapKey(session, keyHandles[index], record);
+		written = (rv==CKR_OK) && writeRecord(record);
+		pthread_mutex_lock(&progressLock);
+		if(written)
+			keysDone++;
+		else
+		{
+			keysFailed++;
+			if(rv==CKR_OK)
+				printf("  --> Key handle %lu : failed to write the archive, stopping.\n", keyHandles[index]);
+			else
+				printf("  --> Key handle %lu : failed with Ox%lX.\n", keyHandles[index], rv);
+		}
+		if((keysDone + keysFailed) % PROGRESS_INTERVAL==0)
+			printf("  --> %u of %u keys wrapped.\n", keysDone + keysFailed, keyCount);
+		pthread_mutex_unlock(&progressLock);
+	}
+	freeRecord(record);
+	checkOperation(p11Func->C_CloseSession(session), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Finds the keys and wraps them into the archive. Returns 0 if the archive could not be written.
+int wrapToArchive(const char *archiveFile, int nThreads, CK_KEY_TYPE *keyTypes, int keyTypeCount, const char *labelPrefix)
+{
+	pthread_t *threads = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	struct timespec start;
+
+	for(int ctr=0; ctr<keyTypeCount; ctr++)
+		findPrivateKeys(keyTypes[ctr]);
+	if(labelPrefix!=NULL)
+		filterByLabelPrefix(labelPrefix);
+	printf("\n> %u private keys to wrap.\n", keyCount);
+
+	archive = fopen(archiveFile, "wb");
+	if(!archive)
+	{
+		printf("Failed to create %s.\n", archiveFile);
+		free(threads);
+		return 0;
+	}
+	writeFailed = !writeUint32(archive, ARCHIVE_MAGIC) || !writeUint32(archive, 0); // The count is written at the end.
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&threads[ctr], NULL, &wrapper, NULL);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(threads[ctr], NULL);
+	if(!writeFailed && !finishArchive())
+		writeFailed = 1;
+	if(fclose(archive)!=0)
+		writeFailed = 1;
+	free(threads);
+
+	printf("\n> %u keys wrapped to %s, %u failed.\n", recordsWritten, archiveFile, keysFailed);
+	printf("  --> %.1f keys per second.\n", keysDone / secondsSince(&start));
+	if(writeFailed)
+		printf("  --> %s could not be written and is not usable.\n", archiveFile);
+	return !writeFailed;
+}
+
+
+
+// Checks if a key with the same label, CKA_ID and key type already exists in the partition.
+int keyExists(CK_SESSION_HANDLE session, KEY_RECORD *record)
+{
+	CK_OBJECT_CLASS objClass = CKO_PRIVATE_KEY;
+	CK_KEY_TYPE keyType = record->keyType;
+	CK_OBJECT_HANDLE handle = 0;
+	CK_ULONG objectCount = 0;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_CLASS,	&objClass,	sizeof(CK_OBJECT_CLASS)},
+		{CKA_KEY_TYPE,	&keyType,	sizeof(CK_KEY_TYPE)},
+		{CKA_LABEL,	record->label,	record->labelLen},
+		{CKA_ID,	record->id,	record->idLen}
+	};
+
+	if(p11Func->C_FindObjectsInit(session, attrib, record->idLen ? 4 : 3)!=CKR_OK)
+		return 0;
+	p11Func->C_FindObjects(session, &handle, 1, &objectCount);
+	p11Func->C_FindObjectsFinal(session);
+	return objectCount>0;
+}
+
+
+
+// Unwraps a key of the archive with the attributes it was wrapped with.
+CK_RV unwrapKey(CK_SESSION_HANDLE session, KEY_RECORD *record, CK_OBJECT_HANDLE *hKey)
+{
+	CK_BBOOL yes = CK_TRUE;
+	CK_BBOOL extractable = (record->usage & USAGE_EXTRACTABLE) ? CK_TRUE : CK_FALSE; // FALSE for older archives.
+	CK_MECHANISM mech = {CKM_AES_KWP, iv, sizeof(iv)};
+	CK_OBJECT_CLASS objClass = CKO_PRIVATE_KEY;
+	CK_KEY_TYPE keyType = record->keyType;
+	CK_ULONG attribLen = 7;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_TOKEN,             &yes,           	sizeof(CK_BBOOL)},
+		{CKA_PRIVATE,           &yes,           	sizeof(CK_BBOOL)},
+		{CKA_SENSITIVE,         &yes,           	sizeof(CK_BBOOL)},
+		{CKA_EXTRACTABLE,       &extractable,   	sizeof(CK_BBOOL)},
+		{CKA_CLASS,             &objClass,      	sizeof(CK_OBJECT_CLASS)},
+		{CKA_KEY_TYPE,          &keyType,      		sizeof(CK_KEY_TYPE)},
+		{CKA_LABEL,		record->label,		record->labelLen},
+		{0,			&yes,			sizeof(CK_BBOOL)}, // Usage and CKA_ID, when present.
+		{0,			&yes,			sizeof(CK_BBOOL)},
+		{0,			NULL,			0}
+	};
+
+	if(record->usage & USAGE_SIGN)
+		attrib[attribLen++].type = CKA_SIGN;
+	if(record->usage & USAGE_DECAPSULATE)
+		attrib[attribLen++].type = CKA_DECAPSULATE;
+	if(record->idLen>0)
+	{
+		attrib[attribLen].type = CKA_ID;
+		attrib[attribLen].pValue = record->id;
+		attrib[attribLen].ulValueLen = record->idLen;
+		attribLen++;
+	}
+
+	return p11Func->C_UnwrapKey(session, &mech, hWrappingKey, record->wrapped, record->wrappedLen, attrib, attribLen, hKey);
+}
+
+
+
+// Records the state of a key in the progress file.
+void recordProgress(uint32_t sequence, unsigned char state, CK_OBJECT_HANDLE hKey)
+{
+	pthread_mutex_lock(&progressLock);
+	progressState[sequence] = state;
+	if(state==1)
+		fprintf(progress, "S %u\n", sequence);
+	else
+		fprintf(progress, "D %u %lu\n", sequence, hKey);
+	fflush(progress);
+	pthread_mutex_unlock(&progressLock);
+}
+
+
+
+// Unwrapping thread; reads records from the archive until none are left.
+void *unwrapper(void *arg)
+{
+	CK_SESSION_HANDLE session = 0;
+	CK_OBJECT_HANDLE hKey = 0;
+	KEY_RECORD *record = (KEY_RECORD*)calloc(1, sizeof(KEY_RECORD));
+	unsigned char state = 0;
+	CK_RV rv = CKR_OK;
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &session), "C_OpenSession");
+	while(readRecord(record))
+	{
+		pthread_mutex_lock(&progressLock);
+		state = progressState[record->sequence];
+		pthread_mutex_unlock(&progressLock);
+
+		// Keys started by an interrupted run may already be in the partition.
+		if(state==2 || (state==1 && keyExists(session, record)))
+		{
+			if(state==1)
+				recordProgress(record->sequence, 2, 0);
+			pthread_mutex_lock(&progressLock);
+			keysSkipped++;
+			pthread_mutex_unlock(&progressLock);
+			continue;
+		}
+
+		recordProgress(record->sequence, 1, 0);
+		rv = unwrapKey(session, record, &hKey);
+		if(rv==CKR_OK)
+			recordProgress(record->sequence, 2, hKey);
+
+		pthread_mutex_lock(&progressLock);
+		if(rv==CKR_OK)
+			keysDone++;
+		else
+		{
+			keysFailed++;
+			printf("  --> %.*s : failed with Ox%lX.\n", (int)record->labelLen, record->label, rv);
+		}
+		if((keysDone + keysFailed) % PROGRESS_INTERVAL==0)
+			printf("  --> %u keys unwrapped.\n", keysDone + keysFailed);
+		pthread_mutex_unlock(&progressLock);
+	}
+	freeRecord(record);
+	checkOperation(p11Func->C_CloseSession(session), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Reads the progress file of a previous run.
+void loadProgress(const char *progressFile)
+{
+	FILE *file = fopen(progressFile, "r");
+	char state = 0;
+	uint32_t sequence = 0;
+	char line[64];
+
+	progressState = (unsigned char*)calloc(keyCount ? keyCount : 1, 1);
+	if(file)
+	{
+		while(fgets(line, sizeof(line), file))
+			if(sscanf(line, "%c %u", &state, &sequence)==2 && sequence<keyCount)
+				progressState[sequence] = (state=='D') ? 2 : (progressState[sequence]==2 ? 2 : 1);
+		fclose(file);
+	}
+	progress = fopen(progressFile, "a");
+	if(!progress)
+	{
+		printf("Failed to open %s.\n", progressFile);
+		disconnectFromLunaSlot();
+		freeMem();
+		exit(1);
+	}
+}
+
+
+
+// Unwraps the keys of the archive into the partition. Returns 0 if the archive is shorter than its header says.
+int unwrapFromArchive(const char *archiveFile, int nThreads, const char *progressFile)
+{
+	pthread_t *threads = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	struct timespec start;
+	uint32_t magic = 0;
+
+	archive = fopen(archiveFile, "rb");
+	if(!archive || !readUint32(archive, &magic) || magic!=ARCHIVE_MAGIC || !readUint32(archive, &keyCount))
+	{
+		printf("%s is not a key archive.\n", archiveFile);
+		if(archive)
+			fclose(archive);
+		free(threads);
+		return 0;
+	}
+	loadProgress(progressFile);
+	printf("\n> %u keys in %s.\n", keyCount, archiveFile);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&threads[ctr], NULL, &unwrapper, NULL);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(threads[ctr], NULL);
+	fclose(archive);
+	fclose(progress);
+	free(threads);
+
+	printf("\n> %u keys unwrapped, %u already done, %u failed.\n", keysDone, keysSkipped, keysFailed);
+	printf("  --> %.1f keys per second.\n", keysDone / secondsSince(&start));
+	if(keysFailed>0)
+		printf("  --> Run the same command again to retry the failed keys.\n");
+	if(recordsRead<keyCount)
+		printf("  --> %s is truncated or damaged : %u of %u records could be read.\n", archiveFile, recordsRead, keyCount);
+	return recordsRead==keyCount;
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s wrap <slot_number> <crypto_officer_password> <wrapping_key_label> <archive_file> <number_of_threads> <ml-dsa|ml-kem|all> [label_prefix]\n", exeName);
+	printf("%s unwrap <slot_number> <crypto_officer_password> <wrapping_key_label> <archive_file> <number_of_threads> <progress_file>\n\n", exeName);
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	CK_KEY_TYPE keyTypes[2] = {CKK_ML_DSA, CKK_ML_KEM};
+	int keyTypeCount = 2;
+	int isWrap = 0;
+	int nThreads = 0;
+	int ok = 0;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<8) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	if(strcmp((const char*)argv[1], "wrap")==0)
+	{
+		isWrap = 1;
+		if(strcmp((const char*)argv[7], "ml-kem")==0)
+			keyTypes[0] = CKK_ML_KEM;
+		if(strcmp((const char*)argv[7], "all")!=0)
+			keyTypeCount = 1;
+	}
+	else if(strcmp((const char*)argv[1], "unwrap")!=0)
+	{
+		usage((char*)argv[0]);
+		exit(1);
+	}
+
+	slotId = atoi((const char*)argv[2]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[3]);
+	nThreads = atoi((const char*)argv[6]);
+	if(nThreads<1)
+		nThreads = 1;
+
+	loadLunaLibrary();
+	connectToLunaSlot();
+	findWrappingKey((const char*)argv[4]);
+	if(isWrap)
+		ok = wrapToArchive((const char*)argv[5], nThreads, keyTypes, keyTypeCount, argc>8 ? (const char*)argv[8] : NULL);
+	else
+		ok = unwrapFromArchive((const char*)argv[5], nThreads, (const char*)argv[7]);
+	disconnectFromLunaSlot();
+	freeMem();
+	return (ok && keysFailed==0) ? 0 : 1;
+}
@@ -0,0 +1,531 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to extract a large number of keys from an SKS enabled partition in chunks.
+	- CA_SIMExtract_demo.c extracts every private key in one call, into one blob held in memory. This sample instead:
+		> finds the keys once and splits the handle list into chunks of a fixed number of objects.
+		> extracts the chunks concurrently, each thread using its own session.
+		> streams each blob to an archive as soon as it is extracted, with its object count and CRC-32 in an index.
+	- Memory use is bounded by the number of threads times the blob size of a chunk.
+	- A failed chunk is retried once, then recorded as failed in the index; the other chunks are still exported.
+	- The archive can be inserted with CA_SIMInsert_Chunked_demo.c. Its layout is described in sim_archive.h.
+	- By default the keys are kept on the partition. With the delete option, the keys of the extracted chunks are
+	  destroyed only once every blob and the index are written and flushed to disk, so an interrupted run never loses
+	  keys. If a blob or the index cannot be written, extraction stops and no key is deleted.
+	- This sample makes use of SFNTExtension function (VENDOR DEFINED FUNCTIONS). SFNTExtensions are supported only on Luna HSMs.
+*/
+
+
+
+
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include "sim_archive.h"
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+        #include <unistd.h> // For fsync.
+#else
+        #include <windows.h> // For Windows OS.
+        #include <io.h> // For _commit.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+#define FIND_BATCH 1024
+#define MAX_ATTEMPTS 2 // Attempts per chunk.
+
+
+CK_FUNCTION_LIST *p11Func = NULL; // Stores all pkcs11 functions.
+CK_SFNT_CA_FUNCTION_LIST *sfntFunc = NULL; // Stores all sfnt functions.
+
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL;
+CK_SESSION_HANDLE hSession = 0;
+CK_OBJECT_HANDLE *objHandles = NULL;
+CK_ULONG objCount = 0;
+
+CK_OBJECT_CLASS objClass = CKO_PRIVATE_KEY;
+int anyClass = 0;
+int deleteExtracted = 0; // Destroys the extracted keys once the archive is on disk.
+const char *archiveName = "extracted_chunks.sim";
+CK_ULONG chunkSize = 100; // Objects per chunk.
+
+SIM_CHUNK *chunks = NULL; // Index of the archive.
+uint32_t chunkCount = 0;
+uint32_t nextChunk = 0;
+uint32_t chunksFailed = 0;
+int writeFailed = 0; // Set when a blob could not be written; stops the extraction.
+CK_ULONG objectsExtracted = 0;
+pthread_mutex_t progressLock = PTHREAD_MUTEX_INITIALIZER;
+
+FILE *archive = NULL;
+uint64_t archiveEnd = SIM_ARCHIVE_HEADER_SIZE; // Where the next blob is written.
+pthread_mutex_t archiveLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+	CK_C_GetFunctionList C_GetFunctionList = NULL;
+	CK_CA_GetFunctionList CA_GetFunctionList = NULL;
+
+	char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+	if(libPath==NULL)
+	{
+		printf("P11_LIB environment variable not set.\n");
+		printf("\n > On Unix/Linux :-\n");
+		printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\n > On Windows :-\n");
+		printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\nExample :-");
+		printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+		printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+		exit(1);
+	}
+
+	#ifdef OS_UNIX
+		libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+	#else
+		libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+	#endif
+	if(!libHandle)
+	{
+		printf("Failed to load Luna library from path : %s\n", libPath);
+		exit(1);
+	}
+
+	// Loads PKCS#11 functions.
+	#ifdef OS_UNIX
+		C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+	#else
+		C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+	#endif
+
+	C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+	if(p11Func==NULL)
+	{
+		printf("Failed to load P11 functions.\n");
+		exit(1);
+	}
+
+	printf ("\n> P11 library loaded.\n");
+	printf ("  --> %s\n", libPath);
+
+	// Loads SFNTExtensions.
+	#ifdef OS_UNIX
+            CA_GetFunctionList = (CK_CA_GetFunctionList)dlsym(libHandle, "CA_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+            CA_GetFunctionList = (CK_CA_GetFunctionList)GetProcAddress(libHandle, "CA_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+	CA_GetFunctionList(&sfntFunc);
+	if(sfntFunc==NULL)
+	{
+		printf("Failed to load SFNT functions.\n");
+		exit(1);
+	}
+	printf("\n> SafeNet Extensions loaded.\n");
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+	free(slotPin);
+	free(objHandles);
+	free(chunks);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+        checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+        checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+        checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+        printf("\n> Connected to Luna.\n");
+        printf("  --> SLOT ID : %ld.\n", slotId);
+        printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+        checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+        checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+        checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+        printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the seconds elapsed since start.
+double secondsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+
+// Finds the handles of all keys to extract, in batches of FIND_BATCH handles.
+void findObjects()
+{
+	CK_BBOOL yes = CK_TRUE;
+	CK_ULONG found = 0;
+	CK_ULONG capacity = 0;
+
+	CK_ATTRIBUTE attrib[] =
+	{
+		{CKA_TOKEN,	&yes,		sizeof(CK_BBOOL)},
+		{CKA_CLASS,	&objClass,	sizeof(CK_OBJECT_CLASS)}
+	};
+
+	checkOperation(p11Func->C_FindObjectsInit(hSession, attrib, anyClass ? 1 : 2), "C_FindObjectsInit");
+	do
+	{
+		if(objCount + FIND_BATCH>capacity)
+		{
+			capacity = (capacity + FIND_BATCH) * 2;
+			objHandles = (CK_OBJECT_HANDLE*)realloc(objHandles, capacity * sizeof(CK_OBJECT_HANDLE));
+		}
+		checkOperation(p11Func->C_FindObjects(hSession, objHandles + objCount, FIND_BATCH, &found), "C_FindObjects");
+		objCount += found;
+	} while(found==FIND_BATCH);
+	checkOperation(p11Func->C_FindObjectsFinal(hSession), "C_FindObjectsFinal");
+	printf("\n> %lu objects found.\n", objCount);
+}
+
+
+
+// Extracts count objects into a newly allocated blob. The objects are kept on the partition.
+CK_RV extractChunk(CK_SESSION_HANDLE session, CK_OBJECT_HANDLE *handles, CK_ULONG count, CK_BYTE **blob, CK_ULONG *blobSize)
+{
+	CK_RV rv = CKR_OK;
+
+	*blob = NULL;
+	rv = sfntFunc->CA_SIMExtract(session, count, handles, 0, 0, CKA_SIM_NO_AUTHORIZATION, 0, NULL_PTR, CK_FALSE, blobSize, NULL);
+	if(rv!=CKR_OK)
+		return rv;
+	*blob = (CK_BYTE*)malloc(*blobSize);
+	rv = sfntFunc->CA_SIMExtract(session, count, handles, 0, 0, CKA_SIM_NO_AUTHORIZATION, 0, NULL_PTR, CK_FALSE, blobSize, *blob);
+	if(rv!=CKR_OK)
+	{
+		free(*blob);
+		*blob = NULL;
+	}
+	return rv;
+}
+
+
+
+// Appends a blob to the archive. Returns 0 if it could not be written.
+int appendBlob(CK_BYTE *blob, CK_ULONG blobSize, uint64_t *offset)
+{
+	int written = 0;
+
+	pthread_mutex_lock(&archiveLock);
+	*offset = archiveEnd;
+	written = fseek(archive, (long)archiveEnd, SEEK_SET)==0 && fwrite(blob, blobSize, 1, archive)==1;
+	if(written)
+		archiveEnd += blobSize;
+	pthread_mutex_unlock(&archiveLock);
+	return written;
+}
+
+
+
+// Extraction thread; extracts and writes one chunk at a time until none are left.
+void *extractor(void *arg)
+{
+	CK_SESSION_HANDLE session = 0;
+	CK_BYTE *blob = NULL;
+	CK_ULONG blobSize = 0;
+	CK_ULONG first = 0, count = 0;
+	uint32_t chunk = 0;
+	CK_RV rv = CKR_OK;
+
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &session), "C_OpenSession");
+	while(1)
+	{
+		pthread_mutex_lock(&progressLock);
+		chunk = writeFailed ? chunkCount : nextChunk++;
+		pthread_mutex_unlock(&progressLock);
+		if(chunk>=chunkCount)
+			break;
+
+		first = chunk * chunkSize;
+		count = (first + chunkSize<objCount) ? chunkSize : objCount - first;
+		for(int attempt=0; attempt<MAX_ATTEMPTS; attempt++)
+		{
+			rv = extractChunk(session, objHandles + first, count, &blob, &blobSize);
+			if(rv==CKR_OK)
+				break;
+		}
+		chunks[chunk].objectCount = (uint32_t)count;
+		chunks[chunk].status = (uint32_t)rv;
+		if(rv==CKR_OK)
+		{
+			chunks[chunk].size = blobSize;
+			chunks[chunk].crc = simCrc32(0, blob, blobSize);
+			if(!appendBlob(blob, blobSize, &chunks[chunk].offset))
+				chunks[chunk].status = (uint32_t)CKR_FUNCTION_FAILED;
+			free(blob);
+		}
+
+		pthread_mutex_lock(&progressLock);
+		if(chunks[chunk].status==CKR_OK)
+		{
+			objectsExtracted += count;
+			printf("  --> Chunk %u : %lu objects, %lu bytes.\n", chunk, count, blobSize);
+		}
+		else
+		{
+			chunksFailed++;
+			if(rv==CKR_OK)
+			{
+				writeFailed = 1;
+				printf("  --> Chunk %u : failed to write %s, stopping.\n", chunk, archiveName);
+			}
+			else
+				printf("  --> Chunk %u : CA_SIMExtract failed with Ox%lX.\n", chunk, rv);
+		}
+		pthread_mutex_unlock(&progressLock);
+	}
+	checkOperation(p11Func->C_CloseSession(session), "C_CloseSession");
+	return 0;
+}
+
+
+
+// Flushes the archive to disk. Returns 0 on failure.
+int syncArchive()
+{
+	if(fflush(archive)!=0)
+		return 0;
+	#ifdef OS_UNIX
+		return fsync(fileno(archive))==0;
+	#else
+		return _commit(_fileno(archive))==0;
+	#endif
+}
+
+
+
+// Destroys the objects of the chunks that were extracted and written to the archive.
+void destroyExtracted()
+{
+	CK_ULONG destroyed = 0, failed = 0, first = 0, count = 0;
+	CK_RV rv = CKR_OK;
+
+	printf("\n> Deleting the extracted keys.\n");
+	for(uint32_t chunk=0; chunk<chunkCount; chunk++)
+	{
+		if(chunks[chunk].status!=CKR_OK || chunks[chunk].size==0)
+			continue;
+		first = chunk * chunkSize;
+		count = chunks[chunk].objectCount;
+		for(CK_ULONG ctr=first; ctr<first + count; ctr++)
+		{
+			if((rv = p11Func->C_DestroyObject(hSession, objHandles[ctr]))==CKR_OK)
+				destroyed++;
+			else if(failed++==0)
+				printf("  --> C_DestroyObject failed with Ox%lX.\n", rv);
+		}
+	}
+	printf("  --> %lu objects deleted, %lu failed.\n", destroyed, failed);
+}
+
+
+
+// Extracts all chunks using nThreads sessions and writes the archive index.
+void extractToArchive(int nThreads)
+{
+	pthread_t *threads = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	struct timespec start;
+	double seconds = 0;
+
+	archive = fopen(archiveName, "wb");
+	if(archive==NULL)
+	{
+		printf("\nfailed to open/write %s\n", archiveName);
+		free(threads);
+		disconnectFromLunaSlot();
+		freeMem();
+		exit(1);
+	}
+	chunkCount = (uint32_t)((objCount + chunkSize - 1) / chunkSize);
+	chunks = (SIM_CHUNK*)calloc(chunkCount ? chunkCount : 1, sizeof(SIM_CHUNK));
+	writeArchiveHeader(archive, chunkCount, 0);
+	printf("\n> Extracting %u chunks of up to %lu objects using %d threads.\n", chunkCount, chunkSize, nThreads);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&threads[ctr], NULL, &extractor, NULL);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(threads[ctr], NULL);
+	seconds = secondsSince(&start);
+	free(threads);
+
+	// Chunks left after a write failure were never extracted; CKR_CANCEL keeps them out of the insert.
+	for(uint32_t chunk=nextChunk; chunk<chunkCount; chunk++)
+	{
+		chunks[chunk].objectCount = (uint32_t)((chunk + 1) * chunkSize<objCount ? chunkSize : objCount - chunk * chunkSize);
+		chunks[chunk].status = (uint32_t)CKR_CANCEL;
+		chunksFailed++;
+	}
+
+	if(!writeArchiveIndex(archive, chunks, chunkCount, archiveEnd) || !syncArchive())
+	{
+		printf("\nfailed to write the index of %s\n", archiveName);
+		writeFailed = 1;
+	}
+	fclose(archive);
+
+	printf("\n> %lu of %lu objects extracted to %s in %.2f seconds.\n", objectsExtracted, objCount, archiveName, seconds);
+	printf("  --> %u chunks, %u failed.\n", chunkCount, chunksFailed);
+	printf("  --> %llu bytes.\n", (unsigned long long)archiveEnd);
+	printf("  --> %.1f objects per second.\n", seconds>0 ? objectsExtracted / seconds : 0);
+
+	if(deleteExtracted && writeFailed)
+		printf("\n> %s could not be written; no key was deleted.\n", archiveName);
+	else if(deleteExtracted)
+		destroyExtracted();
+}
+
+
+
+// Parses a name=value option. Returns 0 if the option is unknown.
+int parseOption(const char *option, int *nThreads)
+{
+	const char *value = strchr(option, '=');
+	value = value ? value + 1 : "";
+
+	if(strncmp(option, "class=", 6)==0)
+	{
+		anyClass = 0;
+		if(strcmp(value, "private")==0)
+			objClass = CKO_PRIVATE_KEY;
+		else if(strcmp(value, "secret")==0)
+			objClass = CKO_SECRET_KEY;
+		else if(strcmp(value, "all")==0)
+			anyClass = 1;
+		else
+			return 0;
+	}
+	else if(strncmp(option, "archive=", 8)==0)
+		archiveName = value;
+	else if(strncmp(option, "chunk=", 6)==0)
+		chunkSize = strtoul(value, NULL, 10);
+	else if(strncmp(option, "threads=", 8)==0)
+		*nThreads = atoi(value);
+	else if(strcmp(option, "delete")==0)
+		deleteExtracted = 1;
+	else
+		return 0;
+	return 1;
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> [option ...]\n\n", exeName);
+	printf("Options :-\n");
+	printf("  class=<private|secret|all>  : keys to extract (default : private).\n");
+	printf("  archive=<file>              : archive to write (default : extracted_chunks.sim).\n");
+	printf("  chunk=<n>                   : objects per chunk (default : 100).\n");
+	printf("  threads=<n>                 : number of threads (default : 4).\n");
+	printf("  delete                      : deletes the extracted keys once the archive is written to disk.\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int nThreads = 4;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<3) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	for(int ctr=3; ctr<argc; ctr++)
+	{
+		if(!parseOption((const char*)argv[ctr], &nThreads))
+		{
+			printf("\nUnknown option : %s\n", (const char*)argv[ctr]);
+			usage((char*)argv[0]);
+			exit(1);
+		}
+	}
+	if(nThreads<1)
+		nThreads = 1;
+	if(chunkSize<1)
+		chunkSize = 1;
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+	initSimCrc32();
+
+	loadLunaLibrary();
+
+	connectToLunaSlot();
+	findObjects();
+	extractToArchive(nThreads);
+	disconnectFromLunaSlot();
+
+	freeMem();
+	return (chunksFailed || writeFailed) ? 1 : 0;
+}
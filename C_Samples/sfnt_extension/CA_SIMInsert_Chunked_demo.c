@@ -0,0 +1,471 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+
+
+
+
+	OBJECTIVE :
+	- This sample demonstrates how to insert the archive written by CA_SIMExtract_Chunked_demo.c into an SKS enabled partition.
+	- CA_SIMInsert_demo.c reads one blob into memory and inserts it in one call. This sample instead:
+		> reads the index of the archive (see sim_archive.h).
+		> inserts the chunks concurrently with CA_SIMInsert, each thread using its own session and reading only
+		  the blob of the chunk it inserts. The CRC-32 of each blob is checked before it is sent to the HSM.
+		> records every inserted chunk in a journal file. When the sample is run again, the chunks listed in the
+		  journal are skipped, so a failed or interrupted restore resumes where it stopped.
+		> reports the number of objects inserted per second.
+	- A chunk is journaled right after CA_SIMInsert returns. If the sample is stopped between the two, that chunk is
+	  inserted again on the next run.
+	- This sample makes use of SFNTExtension function (VENDOR DEFINED FUNCTIONS). SFNTExtensions are supported only on Luna HSMs.
+*/
+
+
+
+
+
+#include <stdio.h>
+#include <cryptoki_v2.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include "sim_archive.h"
+
+
+// Windows and Linux OS uses different header files for loading libraries.
+#ifdef OS_UNIX
+        #include <dlfcn.h> // For Unix/Linux OS.
+#else
+        #include <windows.h> // For Windows OS.
+#endif
+
+
+// Windows uses HINSTANCE for storing library handles.
+#ifdef OS_UNIX
+        void *libHandle = 0; // Library handle for Unix/Linux
+#else
+        HINSTANCE libHandle = 0; //Library handle for Windows.
+#endif
+
+#define MAX_ATTEMPTS 2 // Attempts per chunk.
+#define MAX_PATH_LEN 1024
+
+
+CK_FUNCTION_LIST *p11Func = NULL; // Stores all pkcs11 functions.
+CK_SFNT_CA_FUNCTION_LIST *sfntFunc = NULL; // Stores all sfnt functions.
+
+CK_SLOT_ID slotId = 0; // slot id
+CK_BYTE *slotPin = NULL;
+CK_SESSION_HANDLE hSession = 0;
+const char *archiveName = "extracted_chunks.sim";
+char journalName[MAX_PATH_LEN] = "";
+
+SIM_CHUNK *chunks = NULL; // Index of the archive.
+uint32_t chunkCount = 0;
+char *chunkDone = NULL; // Chunks listed in the journal.
+uint32_t nextChunk = 0;
+uint32_t chunksInserted = 0;
+uint32_t chunksSkipped = 0;
+uint32_t chunksFailed = 0;
+uint32_t chunksMissing = 0; // Chunks the extraction failed to write.
+CK_ULONG objectsInserted = 0;
+pthread_mutex_t progressLock = PTHREAD_MUTEX_INITIALIZER;
+
+FILE *journal = NULL;
+
+
+// Loads Luna cryptoki library
+void loadLunaLibrary()
+{
+	CK_C_GetFunctionList C_GetFunctionList = NULL;
+	CK_CA_GetFunctionList CA_GetFunctionList = NULL;
+
+	char *libPath = getenv("P11_LIB"); // P11_LIB is the complete path of Cryptoki library.
+	if(libPath==NULL)
+	{
+		printf("P11_LIB environment variable not set.\n");
+		printf("\n > On Unix/Linux :-\n");
+		printf("export P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\n > On Windows :-\n");
+		printf("set P11_LIB=<PATH_TO_CRYPTOKI>");
+		printf("\n\nExample :-");
+		printf("\nexport P11_LIB=/usr/safenet/lunaclient/lib/libCryptoki2_64.so");
+		printf("\nset P11_LIB=C:\\Program Files\\SafeNet\\LunaClient\\cryptoki.dll\n\n");
+		exit(1);
+	}
+
+	#ifdef OS_UNIX
+		libHandle = dlopen(libPath, RTLD_NOW); // Loads shared library on Unix/Linux.
+	#else
+		libHandle = LoadLibrary(libPath); // Loads shared library on Windows.
+	#endif
+	if(!libHandle)
+	{
+		printf("Failed to load Luna library from path : %s\n", libPath);
+		exit(1);
+	}
+
+	// Loads PKCS#11 functions.
+	#ifdef OS_UNIX
+		C_GetFunctionList = (CK_C_GetFunctionList)dlsym(libHandle, "C_GetFunctionList"); // Loads symbols on Unix/Linux
+	#else
+		C_GetFunctionList = (CK_C_GetFunctionList)GetProcAddress(libHandle, "C_GetFunctionList"); // Loads symbols on Windows.
+	#endif
+
+	C_GetFunctionList(&p11Func); // Gets the list of all Pkcs11 Functions.
+	if(p11Func==NULL)
+	{
+		printf("Failed to load P11 functions.\n");
+		exit(1);
+	}
+
+	printf ("\n> P11 library loaded.\n");
+	printf ("  --> %s\n", libPath);
+
+	// Loads SFNTExtensions.
+	#ifdef OS_UNIX
+            CA_GetFunctionList = (CK_CA_GetFunctionList)dlsym(libHandle, "CA_GetFunctionList"); // Loads symbols on Unix/Linux
+        #else
+            CA_GetFunctionList = (CK_CA_GetFunctionList)GetProcAddress(libHandle, "CA_GetFunctionList"); // Loads symbols on Windows.
+        #endif
+
+	CA_GetFunctionList(&sfntFunc);
+	if(sfntFunc==NULL)
+	{
+		printf("Failed to load SFNT functions.\n");
+		exit(1);
+	}
+	printf("\n> SafeNet Extensions loaded.\n");
+}
+
+
+
+// Always a good idea to free up some memory before exiting.
+void freeMem()
+{
+        #ifdef OS_UNIX
+                dlclose(libHandle); // Close library handle on Unix/Linux
+        #else
+                FreeLibrary(libHandle); // Close library handle on Windows.
+        #endif
+	free(slotPin);
+	free(chunks);
+	free(chunkDone);
+}
+
+
+
+// Checks if a P11 operation was a success or failure
+void checkOperation(CK_RV rv, const char *message)
+{
+	if(rv!=CKR_OK)
+	{
+		printf("%s failed with Ox%lX\n\n",message,rv);
+		p11Func->C_Finalize(NULL_PTR);
+		exit(1);
+	}
+}
+
+
+
+// Connects to a Luna slot (C_Initialize, C_OpenSession, C_Login)
+void connectToLunaSlot()
+{
+        checkOperation(p11Func->C_Initialize(NULL), "C_Initialize");
+        checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &hSession), "C_OpenSession");
+        checkOperation(p11Func->C_Login(hSession, CKU_USER, slotPin, strlen(slotPin)), "C_Login");
+        printf("\n> Connected to Luna.\n");
+        printf("  --> SLOT ID : %ld.\n", slotId);
+        printf("  --> SESSION ID : %ld.\n", hSession);
+}
+
+
+
+// Disconnects from Luna slot (C_Logout, C_CloseSession and C_Finalize)
+void disconnectFromLunaSlot()
+{
+        checkOperation(p11Func->C_Logout(hSession), "C_Logout");
+        checkOperation(p11Func->C_CloseSession(hSession), "C_CloseSession");
+        checkOperation(p11Func->C_Finalize(NULL), "C_Finalize");
+        printf("\n> Disconnected from Luna slot.\n\n");
+}
+
+
+
+// Returns the seconds elapsed since start.
+double secondsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+
+// Reads the archive index.
+void readArchive()
+{
+	FILE *file = fopen(archiveName, "rb");
+	if(file==NULL)
+	{
+		printf("\nfailed to open/read %s\n", archiveName);
+		exit(1);
+	}
+	chunks = readArchiveIndex(file, &chunkCount);
+	fclose(file);
+	if(chunks==NULL)
+	{
+		printf("\n%s is not a complete chunked SIM archive.\n", archiveName);
+		exit(1);
+	}
+	chunkDone = (char*)calloc(chunkCount ? chunkCount : 1, 1);
+	printf("\n> %u chunks in %s.\n", chunkCount, archiveName);
+}
+
+
+
+// Marks the chunks listed in the journal as done, then opens the journal to append the next ones.
+// Each journal line is "<chunk> <objects>".
+void readJournal()
+{
+	unsigned int chunk = 0;
+	unsigned long count = 0;
+	uint32_t done = 0;
+	FILE *file = fopen(journalName, "r");
+
+	if(file!=NULL)
+	{
+		while(fscanf(file, "%u %lu", &chunk, &count)==2)
+		{
+			if(chunk<chunkCount && !chunkDone[chunk])
+			{
+				chunkDone[chunk] = 1;
+				done++;
+			}
+		}
+		fclose(file);
+		printf("\n> %u chunks already inserted according to %s.\n", done, journalName);
+	}
+	journal = fopen(journalName, "a");
+	if(journal==NULL)
+	{
+		printf("\nfailed to open/write %s\n", journalName);
+		exit(1);
+	}
+}
+
+
+
+// Reads the blob of a chunk and checks its CRC-32. Returns NULL if the blob cannot be read or is corrupted.
+CK_BYTE *readChunk(FILE *file, SIM_CHUNK *chunk)
+{
+	CK_BYTE *blob = (CK_BYTE*)malloc(chunk->size ? chunk->size : 1);
+
+	if(fseek(file, (long)chunk->offset, SEEK_SET)!=0 || fread(blob, chunk->size, 1, file)!=1
+	   || simCrc32(0, blob, chunk->size)!=chunk->crc)
+	{
+		free(blob);
+		return NULL;
+	}
+	return blob;
+}
+
+
+
+// Inserts a blob. Returns the number of objects in objCount.
+CK_RV insertChunk(CK_SESSION_HANDLE session, CK_BYTE *blob, CK_ULONG blobSize, CK_ULONG *objCount)
+{
+	CK_OBJECT_HANDLE *objHandles = NULL;
+	CK_RV rv = CKR_OK;
+
+	rv = sfntFunc->CA_SIMInsert(session, 0, 0, 0, NULL, blobSize, blob, objCount, NULL);
+	if(rv!=CKR_OK)
+		return rv;
+	objHandles = (CK_OBJECT_HANDLE*)calloc(*objCount ? *objCount : 1, sizeof(CK_OBJECT_HANDLE));
+	rv = sfntFunc->CA_SIMInsert(session, 0, 0, 0, NULL, blobSize, blob, objCount, objHandles);
+	free(objHandles);
+	return rv;
+}
+
+
+
+// Insertion thread; inserts one chunk at a time until none are left.
+void *inserter(void *arg)
+{
+	CK_SESSION_HANDLE session = 0;
+	CK_BYTE *blob = NULL;
+	CK_ULONG objCount = 0;
+	uint32_t chunk = 0;
+	int blobRead = 0;
+	CK_RV rv = CKR_OK;
+	FILE *file = fopen(archiveName, "rb"); // Each thread reads the archive with its own file position.
+
+	if(file==NULL)
+	{
+		printf("\nfailed to open/read %s\n", archiveName);
+		return 0;
+	}
+	checkOperation(p11Func->C_OpenSession(slotId, CKF_SERIAL_SESSION|CKF_RW_SESSION, NULL, NULL, &session), "C_OpenSession");
+	while(1)
+	{
+		pthread_mutex_lock(&progressLock);
+		while(nextChunk<chunkCount && (chunkDone[nextChunk] || chunks[nextChunk].status!=CKR_OK))
+		{
+			if(chunkDone[nextChunk])
+				chunksSkipped++;
+			else
+			{
+				chunksMissing++;
+				if(chunks[nextChunk].status==CKR_CANCEL)
+					printf("  --> Chunk %u : not in the archive, not extracted.\n", nextChunk);
+				else
+					printf("  --> Chunk %u : not in the archive, extraction failed with Ox%X.\n", nextChunk, chunks[nextChunk].status);
+			}
+			nextChunk++;
+		}
+		chunk = nextChunk++;
+		pthread_mutex_unlock(&progressLock);
+		if(chunk>=chunkCount)
+			break;
+
+		blob = readChunk(file, &chunks[chunk]);
+		blobRead = blob!=NULL;
+		rv = CKR_DATA_INVALID;
+		for(int attempt=0; blobRead && attempt<MAX_ATTEMPTS; attempt++)
+		{
+			rv = insertChunk(session, blob, chunks[chunk].size, &objCount);
+			if(rv==CKR_OK)
+				break;
+		}
+		free(blob);
+
+		pthread_mutex_lock(&progressLock);
+		if(rv==CKR_OK)
+		{
+			fprintf(journal, "%u %lu\n", chunk, objCount);
+			fflush(journal);
+			chunksInserted++;
+			objectsInserted += objCount;
+			printf("  --> Chunk %u : %lu objects inserted.\n", chunk, objCount);
+		}
+		else
+		{
+			chunksFailed++;
+			if(!blobRead)
+				printf("  --> Chunk %u : blob unreadable or CRC-32 mismatch.\n", chunk);
+			else
+				printf("  --> Chunk %u : CA_SIMInsert failed with Ox%lX.\n", chunk, rv);
+		}
+		pthread_mutex_unlock(&progressLock);
+	}
+	checkOperation(p11Func->C_CloseSession(session), "C_CloseSession");
+	fclose(file);
+	return 0;
+}
+
+
+
+// Inserts the chunks that are not in the journal using nThreads sessions.
+void insertFromArchive(int nThreads)
+{
+	pthread_t *threads = (pthread_t*)malloc(nThreads * sizeof(pthread_t));
+	struct timespec start;
+	double seconds = 0;
+
+	printf("\n> Inserting chunks using %d threads.\n", nThreads);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_create(&threads[ctr], NULL, &inserter, NULL);
+	for(int ctr=0; ctr<nThreads; ctr++)
+		pthread_join(threads[ctr], NULL);
+	seconds = secondsSince(&start);
+	free(threads);
+	fclose(journal);
+
+	printf("\n> %lu objects inserted in %.2f seconds.\n", objectsInserted, seconds);
+	printf("  --> %u chunks inserted, %u skipped (journal), %u failed, %u missing from the archive.\n",
+	       chunksInserted, chunksSkipped, chunksFailed, chunksMissing);
+	printf("  --> %.1f objects per second.\n", seconds>0 ? objectsInserted / seconds : 0);
+	if(chunksFailed)
+		printf("  --> Run the sample again to retry the failed chunks.\n");
+}
+
+
+
+// Parses a name=value option. Returns 0 if the option is unknown.
+int parseOption(const char *option, int *nThreads)
+{
+	const char *value = strchr(option, '=');
+	value = value ? value + 1 : "";
+
+	if(strncmp(option, "archive=", 8)==0)
+		archiveName = value;
+	else if(strncmp(option, "journal=", 8)==0)
+		snprintf(journalName, sizeof(journalName), "%s", value);
+	else if(strncmp(option, "threads=", 8)==0)
+		*nThreads = atoi(value);
+	else
+		return 0;
+	return 1;
+}
+
+
+
+// Prints the syntax for executing this code.
+void usage(const char *exeName)
+{
+	printf("\nUsage :-\n");
+	printf("%s <slot_number> <crypto_officer_password> [option ...]\n\n", exeName);
+	printf("Options :-\n");
+	printf("  archive=<file>  : archive to insert (default : extracted_chunks.sim).\n");
+	printf("  journal=<file>  : journal of the inserted chunks (default : <archive>.journal).\n");
+	printf("  threads=<n>     : number of threads (default : 4).\n\n");
+}
+
+
+
+int main(int argc, char **argv[])
+{
+	int nThreads = 4;
+
+	printf("\n%s\n", (char*)argv[0]);
+	if(argc<3) {
+		usage((char*)argv[0]);
+		exit(1);
+	}
+	for(int ctr=3; ctr<argc; ctr++)
+	{
+		if(!parseOption((const char*)argv[ctr], &nThreads))
+		{
+			printf("\nUnknown option : %s\n", (const char*)argv[ctr]);
+			usage((char*)argv[0]);
+			exit(1);
+		}
+	}
+	if(nThreads<1)
+		nThreads = 1;
+	if(journalName[0]=='\0')
+		snprintf(journalName, sizeof(journalName), "%s.journal", archiveName);
+	slotId = atoi((const char*)argv[1]);
+	slotPin = (CK_BYTE*)strdup((const char*)argv[2]);
+	initSimCrc32();
+
+	readArchive();
+	readJournal();
+	loadLunaLibrary();
+
+	connectToLunaSlot();
+	insertFromArchive(nThreads);
+	disconnectFromLunaSlot();
+
+	freeMem();
+	return (chunksFailed || chunksMissing) ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Chunked SIM archive shared by CA_SIMExtract_Chunked_demo.c and CA_SIMInsert_Chunked_demo.c.
+ *
+ * Layout (all integers little-endian) :
+ *   header : magic "LUNASIMA", chunk count (4 bytes), index offset (8 bytes).
+ *   blobs  : the CA_SIMExtract blob of each chunk, in the order the chunks completed.
+ *   index  : one entry per chunk, in chunk order : blob offset (8), blob size (8), object count (4), CRC-32 of the blob (4)
+ *            and status (4, 0 if the chunk was extracted, else the CK_RV of the failure).
+ *
+ * The index offset stays 0 until the index is written, so an interrupted extract is detected when the archive is read.
+ */
+
+#ifndef SIM_ARCHIVE_H
+#define SIM_ARCHIVE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+
+#define SIM_ARCHIVE_MAGIC "LUNASIMA"
+#define SIM_ARCHIVE_HEADER_SIZE 20
+#define SIM_ARCHIVE_ENTRY_SIZE 28
+
+
+typedef struct
+{
+	uint64_t offset;
+	uint64_t size;
+	uint32_t objectCount;
+	uint32_t crc;
+	uint32_t status;
+} SIM_CHUNK;
+
+
+
+void putU32(unsigned char *out, uint32_t value)
+{
+	for(int ctr=0; ctr<4; ctr++)
+		out[ctr] = (unsigned char)(value >> (8 * ctr));
+}
+
+void putU64(unsigned char *out, uint64_t value)
+{
+	for(int ctr=0; ctr<8; ctr++)
+		out[ctr] = (unsigned char)(value >> (8 * ctr));
+}
+
+uint32_t getU32(const unsigned char *in)
+{
+	uint32_t value = 0;
+	for(int ctr=3; ctr>=0; ctr--)
+		value = (value << 8) | in[ctr];
+	return value;
+}
+
+uint64_t getU64(const unsigned char *in)
+{
+	uint64_t value = 0;
+	for(int ctr=7; ctr>=0; ctr--)
+		value = (value << 8) | in[ctr];
+	return value;
+}
+
+
+
+uint32_t simCrcTable[256];
+
+// Fills the CRC-32 (IEEE 802.3) table. Call once before simCrc32 is used.
+void initSimCrc32()
+{
+	for(uint32_t ctr=0; ctr<256; ctr++)
+	{
+		uint32_t value = ctr;
+		for(int bit=0; bit<8; bit++)
+			value = (value & 1) ? 0xEDB88320 ^ (value >> 1) : value >> 1;
+		simCrcTable[ctr] = value;
+	}
+}
+
+// CRC-32 of a buffer. Pass 0 as crc for the first buffer.
+uint32_t simCrc32(uint32_t crc, const unsigned char *data, size_t len)
+{
+	crc = ~crc;
+	for(size_t ctr=0; ctr<len; ctr++)
+		crc = simCrcTable[(crc ^ data[ctr]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+
+
+// Writes the archive header at the start of the file. Returns 0 on failure.
+int writeArchiveHeader(FILE *file, uint32_t chunkCount, uint64_t indexOffset)
+{
+	unsigned char header[SIM_ARCHIVE_HEADER_SIZE];
+
+	memcpy(header, SIM_ARCHIVE_MAGIC, 8);
+	putU32(header + 8, chunkCount);
+	putU64(header + 12, indexOffset);
+	return fseek(file, 0, SEEK_SET)==0 && fwrite(header, sizeof(header), 1, file)==1;
+}
+
+
+
+// Writes the index at indexOffset, then records indexOffset in the header. Returns 0 on failure.
+int writeArchiveIndex(FILE *file, const SIM_CHUNK *chunks, uint32_t chunkCount, uint64_t indexOffset)
+{
+	unsigned char entry[SIM_ARCHIVE_ENTRY_SIZE];
+
+	if(fseek(file, (long)indexOffset, SEEK_SET)!=0)
+		return 0;
+	for(uint32_t ctr=0; ctr<chunkCount; ctr++)
+	{
+		putU64(entry, chunks[ctr].offset);
+		putU64(entry + 8, chunks[ctr].size);
+		putU32(entry + 16, chunks[ctr].objectCount);
+		putU32(entry + 20, chunks[ctr].crc);
+		putU32(entry + 24, chunks[ctr].status);
+		if(fwrite(entry, sizeof(entry), 1, file)!=1)
+			return 0;
+	}
+	return fflush(file)==0 && writeArchiveHeader(file, chunkCount, indexOffset) && fflush(file)==0;
+}
+
+
+
+// Reads the header and index of an archive. Returns the allocated index, or NULL if the archive is invalid or incomplete.
+SIM_CHUNK *readArchiveIndex(FILE *file, uint32_t *chunkCount)
+{
+	unsigned char header[SIM_ARCHIVE_HEADER_SIZE];
+	unsigned char entry[SIM_ARCHIVE_ENTRY_SIZE];
+	SIM_CHUNK *chunks = NULL;
+	uint64_t indexOffset = 0;
+
+	if(fseek(file, 0, SEEK_SET)!=0 || fread(header, sizeof(header), 1, file)!=1 || memcmp(header, SIM_ARCHIVE_MAGIC, 8)!=0)
+		return NULL;
+	*chunkCount = getU32(header + 8);
+	indexOffset = getU64(header + 12);
+	if(indexOffset==0 || fseek(file, (long)indexOffset, SEEK_SET)!=0)
+		return NULL;
+
+	chunks = (SIM_CHUNK*)calloc(*chunkCount ? *chunkCount : 1, sizeof(SIM_CHUNK));
+	for(uint32_t ctr=0; ctr<*chunkCount; ctr++)
+	{
+		if(fread(entry, sizeof(entry), 1, file)!=1)
+		{
+			free(chunks);
+			return NULL;
+		}
+		chunks[ctr].offset = getU64(entry);
+		chunks[ctr].size = getU64(entry + 8);
+		chunks[ctr].objectCount = getU32(entry + 16);
+		chunks[ctr].crc = getU32(entry + 20);
+		chunks[ctr].status = getU32(entry + 24);
+	}
+	return chunks;
+}
+
+#endif
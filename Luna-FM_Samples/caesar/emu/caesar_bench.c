@@ -0,0 +1,468 @@
+/*      **********************************************************************************
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+	Objective:
+	- Runs fm/caesar.c in the host emulator to check its request parsing and processing, and to measure it.
+	- test  : sends well-formed and malformed single, batch and stream requests and checks the FM status and reply.
+	- bench : measures messages and megabytes per second for several message sizes, records per second for batches,
+	          and megabytes per second for stream updates.
+	- Without an argument, both are run. The exit status is non-zero if a test fails.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fm/common/fm_byteorder.h"
+#include "fm/common/fmerr.h"
+#include "caesar_protocol.h"
+#include "fm_emu.h"
+
+#define BENCH_SECONDS 0.5 // Duration of each measurement.
+#define BENCH_RECORD_SIZE 16
+
+
+uint8_t request[EMU_MAX_MESSAGE_SIZE];
+uint32_t request_len = 0;
+int failures = 0;
+
+
+
+// Returns the seconds elapsed since start.
+double seconds_since(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+
+// Appends a big-endian 32-bit integer to the request.
+void add_be32(uint32_t value)
+{
+	value = fm_htobe32(value);
+	memcpy(request + request_len, &value, sizeof(value));
+	request_len += sizeof(value);
+}
+
+
+
+// Appends bytes to the request.
+void add_bytes(const void *data, uint32_t len)
+{
+	memcpy(request + request_len, data, len);
+	request_len += len;
+}
+
+
+
+uint32_t get_be32(const uint8_t *p)
+{
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return fm_betoh32(value);
+}
+
+
+
+// Starts a single encrypt or decrypt request.
+void single_request(uint32_t operation, const char *text, uint32_t len)
+{
+	request_len = 0;
+	add_be32(0); // slot
+	add_be32(operation);
+	add_be32(len);
+	add_bytes(text, len);
+}
+
+
+
+// Starts a batch request; records are added with add_record.
+void batch_request(uint32_t version, uint32_t count)
+{
+	request_len = 0;
+	add_be32(0); // slot
+	add_be32(CAESAR_OP_BATCH);
+	add_be32(version);
+	add_be32(count);
+}
+
+void add_record(uint32_t operation, const char *text)
+{
+	add_be32(operation);
+	add_be32((uint32_t)strlen(text));
+	add_bytes(text, (uint32_t)strlen(text));
+}
+
+
+
+// Sends the request, for its effect on the FM only.
+void send_request(void)
+{
+	const uint8_t *reply = NULL;
+	uint32_t reply_len = 0;
+
+	emu_dispatch(request, request_len, &reply, &reply_len);
+}
+
+
+
+// Starts a stream request : begin, update or final.
+void stream_request(uint32_t operation, uint32_t stream_id)
+{
+	request_len = 0;
+	add_be32(0); // slot
+	add_be32(operation);
+	add_be32(stream_id);
+}
+
+// Appends a 64-bit offset or total to a stream request.
+void add_be64(uint64_t value)
+{
+	add_be32((uint32_t)(value >> 32));
+	add_be32((uint32_t)value);
+}
+
+// Opens a stream and returns its id, or 0 if the FM refused it.
+uint32_t open_stream(uint32_t operation)
+{
+	const uint8_t *reply = NULL;
+	uint32_t reply_len = 0;
+
+	stream_request(CAESAR_OP_STREAM_BEGIN, operation);
+	if(emu_dispatch(request, request_len, &reply, &reply_len) != FM_OK || reply_len != 4)
+		return 0;
+	return get_be32(reply);
+}
+
+// Starts an update of a stream with a chunk of text.
+void stream_update(uint32_t stream_id, uint64_t offset, const char *text)
+{
+	stream_request(CAESAR_OP_STREAM_UPDATE, stream_id);
+	add_be64(offset);
+	add_be32((uint32_t)strlen(text));
+	add_bytes(text, (uint32_t)strlen(text));
+}
+
+// Starts the final request of a stream.
+void stream_final(uint32_t stream_id, uint64_t total)
+{
+	stream_request(CAESAR_OP_STREAM_FINAL, stream_id);
+	add_be64(total);
+}
+
+
+
+// Prints the result of a test.
+void report(const char *name, int passed)
+{
+	printf("%s : %s\n", passed ? "PASS" : "FAIL", name);
+	if(!passed)
+		failures++;
+}
+
+
+
+// Sends the request and checks the FM status, and the reply when expected is not NULL.
+void check(const char *name, uint32_t expected_status, const uint8_t *expected, uint32_t expected_len)
+{
+	const uint8_t *reply = NULL;
+	uint32_t reply_len = 0;
+	uint32_t status = emu_dispatch(request, request_len, &reply, &reply_len);
+	int passed = (status == expected_status);
+
+	if(passed && expected != NULL)
+		passed = (reply_len == expected_len && memcmp(reply, expected, expected_len) == 0);
+	if(status != expected_status)
+		printf("       status 0x%X, expected 0x%X\n", status, expected_status);
+	report(name, passed);
+}
+
+
+
+// Builds an expected single reply : length and text.
+uint32_t single_reply(uint8_t *out, const char *text)
+{
+	uint32_t len = (uint32_t)strlen(text), be = fm_htobe32(len);
+	memcpy(out, &be, sizeof(be));
+	memcpy(out + sizeof(be), text, len);
+	return sizeof(be) + len;
+}
+
+
+
+void run_stream_tests(void)
+{
+	uint8_t expected[32];
+	uint32_t expected_len = 0;
+	uint32_t stream_id = 0, stale_id = 0;
+	uint32_t ids[CAESAR_MAX_STREAMS];
+	int opened = 0;
+
+	stream_id = open_stream(CAESAR_OP_ENCRYPT);
+	report("stream begin", stream_id != 0);
+	stream_update(stream_id, 0, "Hello, ");
+	expected_len = single_reply(expected, "KHOOR, ");
+	check("stream update", FM_OK, expected, expected_len);
+	stream_update(stream_id, 7, "World");
+	expected_len = single_reply(expected, "ZRUOG");
+	check("stream second update", FM_OK, expected, expected_len);
+	stream_final(stream_id, 12);
+	check("stream final", FM_OK, (const uint8_t*)"\0\0\0\0\0\0\0\x0C", 8);
+	stale_id = stream_id;
+
+	stream_id = open_stream(CAESAR_OP_DECRYPT);
+	stream_update(stream_id, 5, "ZRUOG");
+	expected_len = single_reply(expected, "WORLD");
+	check("stream update out of order", FM_OK, expected, expected_len);
+	stream_update(stream_id, 0, "KHOOR");
+	check("stream update before the previous one", FM_OK, NULL, 0);
+	stream_final(stream_id, 10);
+	check("stream final after updates out of order", FM_OK, NULL, 0);
+
+	stream_update(stale_id, 0, "abc");
+	check("stream update after final", CAESAR_ERR_NO_STREAM, NULL, 0);
+	stream_final(0x12345678, 0);
+	check("stream final with an unknown id", CAESAR_ERR_NO_STREAM, NULL, 0);
+
+	stream_id = open_stream(CAESAR_OP_ENCRYPT);
+	stream_update(stream_id, 0, "abc");
+	send_request();
+	stream_final(stream_id, 4);
+	check("stream final with a missing update", CAESAR_ERR_STREAM_LENGTH, NULL, 0);
+	stream_update(stream_id, 0, "abc");
+	check("stream closed by a failed final", CAESAR_ERR_NO_STREAM, NULL, 0);
+
+	stream_id = open_stream(CAESAR_OP_ENCRYPT);
+	stream_update(stream_id, 0, "abc");
+	send_request();
+	send_request();
+	stream_final(stream_id, 3);
+	check("stream final with a repeated update", CAESAR_ERR_STREAM_LENGTH, NULL, 0);
+
+	stream_id = open_stream(CAESAR_OP_ENCRYPT);
+	stream_update(stream_id, 0, "abc");
+	request_len -= 1;
+	check("stream update with a truncated chunk", FM_ERR_INVALID_LENGTH, NULL, 0);
+	stream_update(stream_id, UINT64_MAX - 1, "abc");
+	check("stream update past the largest offset", FM_ERR_INVALID_LENGTH, NULL, 0);
+	stream_final(stream_id, 0);
+	check("empty stream", FM_OK, (const uint8_t*)"\0\0\0\0\0\0\0\0", 8);
+
+	stream_request(CAESAR_OP_STREAM_BEGIN, 7);
+	check("stream begin with a bad operation", CAESAR_ERR_BAD_OPERATION, NULL, 0);
+
+	for(opened=0; opened<CAESAR_MAX_STREAMS && (ids[opened] = open_stream(CAESAR_OP_ENCRYPT)) != 0; opened++);
+	stream_request(CAESAR_OP_STREAM_BEGIN, CAESAR_OP_ENCRYPT);
+	check("stream begin with all contexts in use", CAESAR_ERR_NO_STREAM, NULL, 0);
+	report("streams open at once", opened == CAESAR_MAX_STREAMS);
+
+	// Only the first stream is still used; the clients of the others are gone without a final.
+	for(int ctr=0; ctr<CAESAR_STREAM_IDLE_MESSAGES; ctr++)
+	{
+		stream_update(ids[0], ctr, "a");
+		send_request();
+	}
+	stream_id = open_stream(CAESAR_OP_ENCRYPT);
+	report("stream begin with all contexts abandoned", stream_id != 0);
+	stream_update(ids[1], 0, "abc");
+	check("stream update after its context was taken over", CAESAR_ERR_NO_STREAM, NULL, 0);
+	stream_update(ids[0], CAESAR_STREAM_IDLE_MESSAGES, "abc");
+	check("stream update of the stream still used", FM_OK, NULL, 0);
+	stream_final(stream_id, 0);
+	check("stream final of the new stream", FM_OK, NULL, 0);
+
+	for(int ctr=0; ctr<opened; ctr++)
+	{
+		stream_final(ids[ctr], 0);
+		send_request();
+	}
+}
+
+
+
+void run_tests(void)
+{
+	uint8_t expected[EMU_MAX_MESSAGE_SIZE];
+	uint32_t expected_len = 0;
+	char all_bytes[256];
+	const uint8_t *reply = NULL;
+	uint32_t reply_len = 0;
+	uint8_t *p = expected;
+	int passed = 0;
+
+	printf("\n> Tests\n");
+
+	single_request(CAESAR_OP_ENCRYPT, "Hello, World xyz!", 17);
+	expected_len = single_reply(expected, "KHOOR, ZRUOG ABC!");
+	check("encrypt", FM_OK, expected, expected_len);
+
+	single_request(CAESAR_OP_DECRYPT, "KHOOR, ZRUOG ABC!", 17);
+	expected_len = single_reply(expected, "HELLO, WORLD XYZ!");
+	check("decrypt", FM_OK, expected, expected_len);
+
+	// Bytes other than letters are unchanged, and decrypt reverses encrypt for upper-case letters.
+	for(int ctr=0; ctr<256; ctr++)
+		all_bytes[ctr] = (char)ctr;
+	single_request(CAESAR_OP_ENCRYPT, all_bytes, 256);
+	emu_dispatch(request, request_len, &reply, &reply_len);
+	memcpy(expected, reply, reply_len);
+	single_request(CAESAR_OP_DECRYPT, (const char*)expected + 4, reply_len - 4);
+	emu_dispatch(request, request_len, &reply, &reply_len);
+	passed = (reply_len == 4 + 256);
+	for(int ctr=0; passed && ctr<256; ctr++)
+		passed = (reply[4 + ctr] == ((ctr >= 'a' && ctr <= 'z') ? ctr - 'a' + 'A' : ctr));
+	report("all byte values round trip", passed);
+
+	single_request(CAESAR_OP_ENCRYPT, "", 0);
+	expected_len = single_reply(expected, "");
+	check("empty message", FM_OK, expected, expected_len);
+
+	single_request(CAESAR_OP_ENCRYPT, (const char*)expected, CAESAR_MAX_DATA_SIZE);
+	check("largest message", FM_OK, NULL, 0);
+
+	request_len = 3;
+	check("request shorter than the slot", FM_ERR_INVALID_LENGTH, NULL, 0);
+
+	single_request(CAESAR_OP_ENCRYPT, "hello", 5);
+	request_len -= 1;
+	check("length larger than the message", FM_ERR_INVALID_LENGTH, NULL, 0);
+
+	single_request(CAESAR_OP_ENCRYPT, "hello", 5);
+	add_bytes("!", 1);
+	check("length smaller than the message", FM_ERR_INVALID_LENGTH, NULL, 0);
+
+	batch_request(CAESAR_BATCH_VERSION, 3);
+	add_record(CAESAR_OP_ENCRYPT, "abc");
+	add_record(7, "ignored");
+	add_record(CAESAR_OP_DECRYPT, "DEF");
+	p = expected;
+	memcpy(p, "\0\0\0\1\0\0\0\3", 8); // version, count
+	memcpy(p + 8, "\0\0\0\0\0\0\0\3DEF", 11); // OK, 3, DEF
+	memcpy(p + 19, "\0\0\0\1\0\0\0\0", 8); // bad operation, 0
+	memcpy(p + 27, "\0\0\0\0\0\0\0\3ABC", 11); // OK, 3, ABC
+	check("batch with a bad record", FM_OK, expected, 38);
+
+	batch_request(CAESAR_BATCH_VERSION, 0);
+	check("empty batch", FM_OK, (const uint8_t*)"\0\0\0\1\0\0\0\0", 8);
+
+	batch_request(CAESAR_BATCH_VERSION + 1, 1);
+	add_record(CAESAR_OP_ENCRYPT, "abc");
+	check("batch version", CAESAR_ERR_UNSUPPORTED_VERSION, NULL, 0);
+
+	batch_request(CAESAR_BATCH_VERSION, 2);
+	add_record(CAESAR_OP_ENCRYPT, "abc");
+	check("batch with a missing record", FM_ERR_INVALID_LENGTH, NULL, 0);
+
+	batch_request(CAESAR_BATCH_VERSION, 1);
+	add_record(CAESAR_OP_ENCRYPT, "abc");
+	request_len -= 1;
+	check("batch with a truncated record", FM_ERR_INVALID_LENGTH, NULL, 0);
+
+	batch_request(CAESAR_BATCH_VERSION, 1);
+	add_record(CAESAR_OP_ENCRYPT, "abc");
+	add_bytes("x", 1);
+	check("batch with trailing bytes", FM_ERR_INVALID_LENGTH, NULL, 0);
+
+	batch_request(CAESAR_BATCH_VERSION, CAESAR_BATCH_MAX_RECORDS + 1);
+	check("batch with too many records", FM_ERR_INVALID_LENGTH, NULL, 0);
+
+	run_stream_tests();
+}
+
+
+
+// Dispatches the current request repeatedly for BENCH_SECONDS. Returns the number of requests per second.
+double measure(void)
+{
+	const uint8_t *reply = NULL;
+	uint32_t reply_len = 0;
+	unsigned long count = 0;
+	struct timespec start;
+	double seconds = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	do
+	{
+		for(int ctr=0; ctr<64; ctr++)
+			emu_dispatch(request, request_len, &reply, &reply_len);
+		count += 64;
+		seconds = seconds_since(&start);
+	} while(seconds < BENCH_SECONDS);
+	return count / seconds;
+}
+
+
+
+void run_benchmarks(void)
+{
+	const uint32_t sizes[] = {16, 128, 1024, 16384, CAESAR_MAX_DATA_SIZE};
+	char *text = (char*)malloc(CAESAR_MAX_DATA_SIZE);
+	char record[BENCH_RECORD_SIZE + 1];
+	uint32_t stream_id = 0;
+	double rate = 0;
+
+	for(uint32_t ctr=0; ctr<CAESAR_MAX_DATA_SIZE; ctr++)
+		text[ctr] = "The quick brown fox jumps over the lazy dog. "[ctr % 45];
+
+	printf("\n> Single messages\n");
+	for(int ctr=0; ctr<sizeof(sizes)/sizeof(*sizes); ctr++)
+	{
+		single_request(CAESAR_OP_ENCRYPT, text, sizes[ctr]);
+		rate = measure();
+		printf("  --> %6u bytes : %10.0f messages/s, %8.1f MB/s\n", sizes[ctr], rate, rate * sizes[ctr] / 1e6);
+	}
+
+	printf("\n> Batches of %d records of %d bytes\n", CAESAR_BATCH_MAX_RECORDS, BENCH_RECORD_SIZE);
+	memcpy(record, text, BENCH_RECORD_SIZE);
+	record[BENCH_RECORD_SIZE] = '\0';
+	batch_request(CAESAR_BATCH_VERSION, CAESAR_BATCH_MAX_RECORDS);
+	for(int ctr=0; ctr<CAESAR_BATCH_MAX_RECORDS; ctr++)
+		add_record(ctr % 2 ? CAESAR_OP_DECRYPT : CAESAR_OP_ENCRYPT, record);
+	rate = measure();
+	printf("  --> %10.0f records/s\n", rate * CAESAR_BATCH_MAX_RECORDS);
+
+	printf("\n> Stream updates of %d bytes\n", CAESAR_STREAM_MAX_CHUNK);
+	stream_id = open_stream(CAESAR_OP_ENCRYPT);
+	stream_request(CAESAR_OP_STREAM_UPDATE, stream_id);
+	add_be64(0);
+	add_be32(CAESAR_STREAM_MAX_CHUNK);
+	add_bytes(text, CAESAR_STREAM_MAX_CHUNK);
+	rate = measure();
+	printf("  --> %10.0f updates/s, %8.1f MB/s\n", rate, rate * CAESAR_STREAM_MAX_CHUNK / 1e6);
+	stream_final(stream_id, 0);
+	send_request();
+	free(text);
+}
+
+
+
+int main(int argc, char *argv[])
+{
+	const char *mode = argc > 1 ? argv[1] : "all";
+
+	if(strcmp(mode, "test") && strcmp(mode, "bench") && strcmp(mode, "all"))
+	{
+		printf("\nUsage :-\n%s [test|bench]\n\n", argv[0]);
+		return 1;
+	}
+	if(!emu_start())
+		return 1;
+	if(strcmp(mode, "bench"))
+		run_tests();
+	if(strcmp(mode, "test"))
+		run_benchmarks();
+	if(failures)
+		printf("\n%d tests failed.\n", failures);
+	return failures ? 1 : 0;
+}
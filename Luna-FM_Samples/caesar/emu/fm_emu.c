@@ -0,0 +1,125 @@
+/*      **********************************************************************************
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+	Objective:
+	- Host-side stand-in for the FM runtime services used by the Caesar FM (FMSW_RegisterRandomDispatch, SVC_GetReplyBuffer,
+	  SVC_SendReply and GetFMID), so fm/caesar.c can be compiled and run on a Linux box without an HSM.
+	- The reply buffer handed to the FM is owned by the calling thread and reused, so the emulator adds no allocation
+	  or copy to the cost of a message.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <fm.h>
+#include <fmsw.h>
+#include "fm/common/fmerr.h"
+#include "fm_emu.h"
+
+
+// State of the message being dispatched; FmMsgHandle points to it.
+typedef struct
+{
+	uint8_t *reply;
+	uint32_t reply_len;
+	uint32_t status;
+	int replied;
+} EMU_MESSAGE;
+
+
+FM_RV Startup(void);
+
+static FMSW_DispatchFn_t dispatch = NULL;
+static uint16_t registered_fmid = 0;
+static pthread_once_t started = PTHREAD_ONCE_INIT;
+static pthread_mutex_t fm_lock = PTHREAD_MUTEX_INITIALIZER; // The FM handles one message at a time.
+static pthread_key_t reply_buffer; // One reply buffer per calling thread, freed when the thread exits.
+
+
+
+uint16_t GetFMID(void)
+{
+	return FMID_ALLOCATE_NORM;
+}
+
+
+
+FM_RV FMSW_RegisterRandomDispatch(uint16_t fmid, FMSW_DispatchFn_t fn)
+{
+	registered_fmid = fmid;
+	dispatch = fn;
+	return FM_OK;
+}
+
+
+
+void *SVC_GetReplyBuffer(FmMsgHandle token, uint32_t len)
+{
+	EMU_MESSAGE *message = (EMU_MESSAGE*)token;
+
+	if(len > EMU_MAX_MESSAGE_SIZE)
+		return NULL;
+	message->reply_len = len;
+	return message->reply;
+}
+
+
+
+void SVC_SendReply(FmMsgHandle token, uint32_t status)
+{
+	EMU_MESSAGE *message = (EMU_MESSAGE*)token;
+
+	message->status = status;
+	message->replied = 1;
+}
+
+
+
+static void start_fm(void)
+{
+	pthread_key_create(&reply_buffer, free);
+	if(Startup() != FM_OK || dispatch == NULL)
+		fprintf(stderr, "FM emulator : Startup() did not register a dispatch function.\n");
+}
+
+
+
+int emu_start(void)
+{
+	pthread_once(&started, start_fm);
+	return dispatch != NULL;
+}
+
+
+
+uint32_t emu_dispatch(void *req, uint32_t req_len, const uint8_t **reply, uint32_t *reply_len)
+{
+	EMU_MESSAGE message;
+	uint8_t *buffer = (uint8_t*)pthread_getspecific(reply_buffer);
+
+	if(buffer == NULL)
+	{
+		buffer = (uint8_t*)malloc(EMU_MAX_MESSAGE_SIZE);
+		pthread_setspecific(reply_buffer, buffer);
+	}
+	memset(&message, 0, sizeof(message));
+	message.reply = buffer;
+
+	pthread_mutex_lock(&fm_lock);
+	dispatch(&message, req, req_len);
+	pthread_mutex_unlock(&fm_lock);
+
+	*reply = message.reply;
+	*reply_len = (message.replied && message.status == FM_OK) ? message.reply_len : 0;
+	return message.replied ? message.status : FM_ERR_NO_REPLY;
+}
@@ -0,0 +1,16 @@
+#ifndef FM_EMU_H
+#define FM_EMU_H
+
+#include <stdint.h>
+
+// Largest request or reply the emulator exchanges with the FM.
+#define EMU_MAX_MESSAGE_SIZE (64 * 1024)
+
+// Calls the FM Startup() once.
+int emu_start(void);
+
+// Delivers one request to the FM dispatch function and returns the FM status. On FM_OK, reply points to the reply,
+// which stays valid until the calling thread dispatches its next request. Messages are dispatched one at a time, as on the HSM.
+uint32_t emu_dispatch(void *req, uint32_t req_len, const uint8_t **reply, uint32_t *reply_len);
+
+#endif
@@ -0,0 +1,9 @@
+/* Host emulator stand-in for the Cryptoki header : only the types the FM samples and MD API use. */
+
+#ifndef EMU_CRYPTOKI_H
+#define EMU_CRYPTOKI_H
+
+typedef unsigned long CK_ULONG;
+typedef CK_ULONG CK_SLOT_ID;
+
+#endif
@@ -0,0 +1,3 @@
+/* Host emulator stand-in for the FM SDK header of the same name. */
+
+#include "fm/hsm/fm.h"
@@ -0,0 +1,12 @@
+/* Host emulator stand-in for the FM SDK header of the same name. */
+
+#ifndef EMU_FM_BYTEORDER_H
+#define EMU_FM_BYTEORDER_H
+
+#include <arpa/inet.h>
+#include "fm/common/fmerr.h"
+
+#define fm_htobe32(x) htonl(x)
+#define fm_betoh32(x) ntohl(x)
+
+#endif
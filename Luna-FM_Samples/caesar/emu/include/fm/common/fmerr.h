@@ -0,0 +1,11 @@
+/* Host emulator stand-in for the FM SDK header of the same name. */
+
+#ifndef EMU_FMERR_H
+#define EMU_FMERR_H
+
+#define FM_OK 0
+#define FM_ERR_INVALID_LENGTH 0x0003
+#define FM_ERR_OUT_OF_MEMORY 0x0004
+#define FM_ERR_NO_REPLY 0x00FF // Emulator only : the dispatch function returned without SVC_SendReply.
+
+#endif
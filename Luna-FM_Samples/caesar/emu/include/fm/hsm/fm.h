@@ -0,0 +1,20 @@
+/*
+ * Host emulator stand-in for the FM SDK header of the same name.
+ * Declares only what the Caesar FM uses; the values are those of the emulator, not of the HSM.
+ */
+
+#ifndef EMU_FM_HSM_FM_H
+#define EMU_FM_HSM_FM_H
+
+#include <stdint.h>
+
+typedef uint32_t FM_RV;
+typedef void *FmMsgHandle; // Message being dispatched.
+
+#define FMID_ALLOCATE_NORM 0xA000
+
+uint16_t GetFMID(void);
+void *SVC_GetReplyBuffer(FmMsgHandle token, uint32_t len);
+void SVC_SendReply(FmMsgHandle token, uint32_t status);
+
+#endif
@@ -0,0 +1,12 @@
+/* Host emulator stand-in for the FM SDK header of the same name. */
+
+#ifndef EMU_FMSW_H
+#define EMU_FMSW_H
+
+#include "fm/hsm/fm.h"
+
+typedef void (*FMSW_DispatchFn_t)(FmMsgHandle token, void *req, uint32_t req_len);
+
+FM_RV FMSW_RegisterRandomDispatch(uint16_t fmid, FMSW_DispatchFn_t dispatch);
+
+#endif
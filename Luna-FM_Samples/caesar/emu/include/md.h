@@ -0,0 +1,37 @@
+/*
+ * Host emulator stand-in for the Message Dispatch (MD) API header.
+ * The functions are implemented by md_emu.c, which delivers requests to the FM compiled into the same program.
+ */
+
+#ifndef EMU_MD_H
+#define EMU_MD_H
+
+#include <stdint.h>
+#include "cryptoki.h"
+
+typedef uint32_t MD_RV;
+
+#define MDR_OK 0
+#define MDR_UNSUCCESSFUL 1
+#define MDR_INSUFFICIENT_RESOURCE 2
+#define MDR_INVALID_PARAMETER 3
+#define MDR_INVALID_HSM_INDEX 4
+#define MDR_NOT_INITIALIZED 5
+#define MDR_FM_NOT_AVAILABLE 6
+
+typedef struct
+{
+	uint8_t *pData;
+	uint32_t length;
+} MD_Buffer_t; // Arrays of buffers end with a NULL pData.
+
+MD_RV MD_Initialize(void);
+void MD_Finalize(void);
+MD_RV MD_GetHsmCount(uint32_t *pHsmCount);
+MD_RV MD_GetHsmIndexForSlot(uint32_t slotId, uint32_t *pHsmIndex);
+MD_RV MD_GetEmbeddedSlotID(uint32_t slotId, CK_SLOT_ID *pEmbeddedSlotId);
+MD_RV MD_GetFmIdFromName(uint32_t hsmIndex, char *name, uint32_t nameLength, uint32_t *pFmId);
+MD_RV MD_SendReceive(uint32_t hsmIndex, uint32_t originatorId, uint16_t fmNumber, MD_Buffer_t *pReq, uint32_t timeout,
+                     MD_Buffer_t *pResp, uint32_t *pReceivedLen, uint32_t *pFmStatus);
+
+#endif
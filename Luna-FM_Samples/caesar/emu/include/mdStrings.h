@@ -0,0 +1,10 @@
+/* Host emulator stand-in for the MD SDK header of the same name. */
+
+#ifndef EMU_MDSTRINGS_H
+#define EMU_MDSTRINGS_H
+
+#include "md.h"
+
+const char *MD_RvAsString(MD_RV rv);
+
+#endif
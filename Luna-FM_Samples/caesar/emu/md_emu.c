@@ -0,0 +1,190 @@
+/*      **********************************************************************************
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+
+	Objective:
+	- Host-side stand-in for the Message Dispatch (MD) API used by FM host applications. Requests sent with MD_SendReceive
+	  are delivered to the FM compiled into the same program (see fm_emu.c), so host/caesar_client.c runs unchanged.
+	- The emulator exposes FM_EMU_ADAPTERS adapters (1 by default, up to EMU_MAX_ADAPTERS), all hosting the FM named
+	  EMU_FM_NAME. Slot n is on adapter n modulo the adapter count, and its embedded slot is n. The adapters share the
+	  FM compiled into the program.
+	- Set FM_EMU_LATENCY_US to add a fixed delay to every MD_SendReceive, as a stand-in for the round trip to the HSM.
+	  A comma-separated list sets the delay of each adapter in turn; the last value applies to the remaining adapters.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <md.h>
+#include <mdStrings.h>
+#include <fm.h>
+#include "fm/common/fmerr.h"
+#include "fm_emu.h"
+
+#ifndef EMU_FM_NAME
+#define EMU_FM_NAME "Caesar"
+#endif
+
+#define EMU_MAX_ADAPTERS 16
+
+
+static int initialized = 0;
+static uint32_t adapter_count = 1;
+static useconds_t latency[EMU_MAX_ADAPTERS]; // Simulated round trip of each adapter, in microseconds.
+static __thread uint8_t *request_buffer = NULL; // Gathers multi-segment requests; one per calling thread.
+
+
+
+MD_RV MD_Initialize(void)
+{
+	const char *value = getenv("FM_EMU_ADAPTERS");
+	char *end = NULL;
+	useconds_t delay = 0;
+
+	adapter_count = value ? (uint32_t)strtoul(value, NULL, 10) : 1;
+	if(adapter_count < 1 || adapter_count > EMU_MAX_ADAPTERS)
+		return MDR_INVALID_PARAMETER;
+
+	value = getenv("FM_EMU_LATENCY_US");
+	for(uint32_t ctr=0; ctr<EMU_MAX_ADAPTERS; ctr++)
+	{
+		if(value != NULL && *value != '\0')
+		{
+			delay = (useconds_t)strtoul(value, &end, 10);
+			value = (*end == ',') ? end + 1 : end;
+		}
+		latency[ctr] = delay;
+	}
+
+	if(!emu_start())
+		return MDR_FM_NOT_AVAILABLE;
+	initialized = 1;
+	return MDR_OK;
+}
+
+
+
+void MD_Finalize(void)
+{
+	initialized = 0;
+}
+
+
+
+MD_RV MD_GetHsmCount(uint32_t *pHsmCount)
+{
+	if(!initialized)
+		return MDR_NOT_INITIALIZED;
+	*pHsmCount = adapter_count;
+	return MDR_OK;
+}
+
+
+
+MD_RV MD_GetHsmIndexForSlot(uint32_t slotId, uint32_t *pHsmIndex)
+{
+	if(!initialized)
+		return MDR_NOT_INITIALIZED;
+	*pHsmIndex = slotId % adapter_count;
+	return MDR_OK;
+}
+
+
+
+MD_RV MD_GetEmbeddedSlotID(uint32_t slotId, CK_SLOT_ID *pEmbeddedSlotId)
+{
+	if(!initialized)
+		return MDR_NOT_INITIALIZED;
+	*pEmbeddedSlotId = slotId;
+	return MDR_OK;
+}
+
+
+
+MD_RV MD_GetFmIdFromName(uint32_t hsmIndex, char *name, uint32_t nameLength, uint32_t *pFmId)
+{
+	if(!initialized)
+		return MDR_NOT_INITIALIZED;
+	if(hsmIndex >= adapter_count)
+		return MDR_INVALID_HSM_INDEX;
+	if(nameLength != strlen(EMU_FM_NAME) || memcmp(name, EMU_FM_NAME, nameLength) != 0)
+		return MDR_FM_NOT_AVAILABLE;
+	*pFmId = GetFMID();
+	return MDR_OK;
+}
+
+
+
+MD_RV MD_SendReceive(uint32_t hsmIndex, uint32_t originatorId, uint16_t fmNumber, MD_Buffer_t *pReq, uint32_t timeout,
+                     MD_Buffer_t *pResp, uint32_t *pReceivedLen, uint32_t *pFmStatus)
+{
+	uint8_t *req = pReq[0].pData;
+	uint32_t req_len = 0, copied = 0, part = 0;
+	const uint8_t *reply = NULL;
+	uint32_t reply_len = 0;
+
+	if(!initialized)
+		return MDR_NOT_INITIALIZED;
+	if(hsmIndex >= adapter_count)
+		return MDR_INVALID_HSM_INDEX;
+	if(fmNumber != GetFMID())
+		return MDR_FM_NOT_AVAILABLE;
+
+	// Gathers the request segments, unless there is only one.
+	for(MD_Buffer_t *segment=pReq; segment->pData!=NULL; segment++)
+		req_len += segment->length;
+	if(req_len > EMU_MAX_MESSAGE_SIZE)
+		return MDR_INVALID_PARAMETER;
+	if(pReq[0].pData != NULL && pReq[1].pData != NULL)
+	{
+		if(request_buffer == NULL)
+			request_buffer = (uint8_t*)malloc(EMU_MAX_MESSAGE_SIZE);
+		req = request_buffer;
+		for(MD_Buffer_t *segment=pReq; segment->pData!=NULL; segment++)
+		{
+			memcpy(req + copied, segment->pData, segment->length);
+			copied += segment->length;
+		}
+	}
+
+	if(latency[hsmIndex])
+		usleep(latency[hsmIndex]);
+	*pFmStatus = emu_dispatch(req, req_len, &reply, &reply_len);
+	*pReceivedLen = reply_len;
+
+	// Scatters the reply into the response segments.
+	copied = 0;
+	for(MD_Buffer_t *segment=pResp; segment->pData!=NULL && copied<reply_len; segment++)
+	{
+		part = (reply_len - copied < segment->length) ? reply_len - copied : segment->length;
+		memcpy(segment->pData, reply + copied, part);
+		copied += part;
+	}
+	return copied < reply_len ? MDR_INSUFFICIENT_RESOURCE : MDR_OK;
+}
+
+
+
+const char *MD_RvAsString(MD_RV rv)
+{
+	switch(rv)
+	{
+		case MDR_OK: return "MDR_OK";
+		case MDR_UNSUCCESSFUL: return "MDR_UNSUCCESSFUL";
+		case MDR_INSUFFICIENT_RESOURCE: return "MDR_INSUFFICIENT_RESOURCE";
+		case MDR_INVALID_PARAMETER: return "MDR_INVALID_PARAMETER";
+		case MDR_INVALID_HSM_INDEX: return "MDR_INVALID_HSM_INDEX";
+		case MDR_NOT_INITIALIZED: return "MDR_NOT_INITIALIZED";
+		case MDR_FM_NOT_AVAILABLE: return "MDR_FM_NOT_AVAILABLE";
+		default: return "UNKNOWN";
+	}
+}
@@ -12,28 +12,385 @@
 	Objective:
 	- This code for Functionality Module reads a text sent from FM host and encrypts it using Caesar cipher technique.
 	- The purpose of this code is to demonstrate how FM can be utilized to add a specific functionality, that isn't natively supported by an HSM.
+	- A batch request carries many records in one message, so the cost of a host to FM round trip is shared by all of
+	  them. The batch format is described in caesar_protocol.h.
+	- The cipher is a 256-entry lookup table per direction, built once at startup. Each message is transformed directly
+	  from the request into the reply buffer, without an intermediate copy, so its size is limited only by the largest
+	  message the FM exchanges (CAESAR_MAX_MESSAGE_SIZE). Custom FM ciphers can follow the same pattern.
+	- Inputs of any length are processed as a stream of chunks (begin, update, final). The FM only keeps a fixed table
+	  of small stream contexts, so its memory does not grow with the input. The FM has no clock, so the number of
+	  messages it has handled is used to find the contexts of streams abandoned by their client.
 */
 
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 #include <cryptoki.h>
 #include <fm.h>
 #include "fm/common/fm_byteorder.h"
 #include "caesar.h"
 #include <fmsw.h>
 
+// Reads a big-endian 32-bit integer from a buffer that may not be aligned.
+static uint32_t get_be32(const uint8_t *p)
+{
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return fm_betoh32(value);
+}
+
+
+
+// Writes a big-endian 32-bit integer to a buffer that may not be aligned.
+static void put_be32(uint8_t *p, uint32_t value)
+{
+	value = fm_htobe32(value);
+	memcpy(p, &value, sizeof(value));
+}
+
+
+
+// Reads a big-endian 64-bit integer, high word first.
+static uint64_t get_be64(const uint8_t *p)
+{
+	return ((uint64_t)get_be32(p) << 32) | get_be32(p + 4);
+}
+
+
+
+// Writes a big-endian 64-bit integer, high word first.
+static void put_be64(uint8_t *p, uint64_t value)
+{
+	put_be32(p, (uint32_t)(value >> 32));
+	put_be32(p + 4, (uint32_t)value);
+}
+
+
+
+// Context of an open stream. A stream id is its index in the table in the low byte, and a generation above it,
+// so the id of a freed context is not accepted once the context is reused.
+typedef struct
+{
+	uint32_t id; // 0 while the context is free.
+	uint32_t operation;
+	uint64_t processed; // Bytes of all updates.
+	uint64_t end; // Highest offset + length of an update.
+	uint32_t last_used; // Value of message_count at the last request for the stream.
+} STREAM;
+
+static STREAM streams[CAESAR_MAX_STREAMS];
+static uint32_t stream_generation = 0;
+static uint32_t message_count = 0; // Messages handled by the FM. Ages are computed modulo 2^32.
+
+
+
+// Substitution tables for encryption and decryption. Letters are upper-cased and shifted by 3, other bytes are unchanged.
+static uint8_t encrypt_table[256];
+static uint8_t decrypt_table[256];
+
+
+
+// Builds the substitution tables.
+static void build_tables(void)
+{
+	uint8_t ch;
+
+	for(uint32_t ctr=0; ctr<256; ctr++)
+	{
+		ch = (uint8_t)ctr;
+		if (ch >= 'a' && ch <= 'z')
+			ch = ch - 'a' + 'A';
+		encrypt_table[ctr] = ch;
+		decrypt_table[ctr] = ch;
+		if (ch >= 'A' && ch <= 'Z')
+		{
+			encrypt_table[ctr] = 'A' + (ch - 'A' + 3) % 26;
+			decrypt_table[ctr] = 'A' + (ch - 'A' + 23) % 26;
+		}
+	}
+}
+
+
+
+// Encrypts (operation 1) or decrypts (operation 0) len bytes from in to out, four bytes per iteration.
+static void caesar_transform(const uint8_t *in, uint8_t *out, uint32_t len, uint32_t operation)
+{
+	const uint8_t *table = (operation == CAESAR_OP_ENCRYPT) ? encrypt_table : decrypt_table;
+	uint32_t ctr = 0;
+
+	for(; ctr + 4 <= len; ctr += 4)
+	{
+		out[ctr] = table[in[ctr]];
+		out[ctr + 1] = table[in[ctr + 1]];
+		out[ctr + 2] = table[in[ctr + 2]];
+		out[ctr + 3] = table[in[ctr + 3]];
+	}
+	for(; ctr < len; ctr++)
+		out[ctr] = table[in[ctr]];
+}
+
+
+
+// Processes a batch request : version, record count, then per record operation, length and payload.
+// The records are checked and the reply sized in a first pass, so the reply buffer is requested only once.
+static void dispatch_batch(FmMsgHandle token, const uint8_t *req, uint32_t req_len)
+{
+	uint32_t version, count, operation, len, status;
+	uint32_t rep_len = CAESAR_BATCH_HEADER_SIZE;
+	const uint8_t *record;
+	uint32_t left;
+	uint8_t *rep;
+
+
+	// Reads version and record count.
+	if(req_len < CAESAR_BATCH_HEADER_SIZE)
+	{
+		SVC_SendReply(token, FM_ERR_INVALID_LENGTH);
+		return;
+	}
+	version = get_be32(req);
+	count = get_be32(req + 4);
+	req += CAESAR_BATCH_HEADER_SIZE;
+	req_len -= CAESAR_BATCH_HEADER_SIZE;
+	if(version != CAESAR_BATCH_VERSION)
+	{
+		SVC_SendReply(token, CAESAR_ERR_UNSUPPORTED_VERSION);
+		return;
+	}
+	if(count > CAESAR_BATCH_MAX_RECORDS)
+	{
+		SVC_SendReply(token, FM_ERR_INVALID_LENGTH);
+		return;
+	}
+
+
+	// Checks that the records exactly fill the request, and computes the reply length.
+	record = req;
+	left = req_len;
+	for(uint32_t ctr=0; ctr<count; ctr++)
+	{
+		if(left < CAESAR_RECORD_HEADER_SIZE || get_be32(record + 4) > left - CAESAR_RECORD_HEADER_SIZE)
+		{
+			SVC_SendReply(token, FM_ERR_INVALID_LENGTH);
+			return;
+		}
+		operation = get_be32(record);
+		len = get_be32(record + 4);
+		rep_len += CAESAR_RECORD_HEADER_SIZE;
+		if(operation <= CAESAR_OP_ENCRYPT)
+			rep_len += len;
+		record += CAESAR_RECORD_HEADER_SIZE + len;
+		left -= CAESAR_RECORD_HEADER_SIZE + len;
+	}
+	if(left != 0)
+	{
+		SVC_SendReply(token, FM_ERR_INVALID_LENGTH);
+		return;
+	}
+
+	if ((rep = (uint8_t*)SVC_GetReplyBuffer(token, rep_len)) == NULL)
+	{
+		SVC_SendReply(token, FM_ERR_OUT_OF_MEMORY);
+		return;
+	}
+	put_be32(rep, CAESAR_BATCH_VERSION);
+	put_be32(rep + 4, count);
+	rep += CAESAR_BATCH_HEADER_SIZE;
+
+
+	// Processes each record into the reply.
+	record = req;
+	for(uint32_t ctr=0; ctr<count; ctr++)
+	{
+		operation = get_be32(record);
+		len = get_be32(record + 4);
+		record += CAESAR_RECORD_HEADER_SIZE;
+
+		status = (operation > CAESAR_OP_ENCRYPT) ? CAESAR_RECORD_BAD_OPERATION : CAESAR_RECORD_OK;
+		put_be32(rep, status);
+		put_be32(rep + 4, status == CAESAR_RECORD_OK ? len : 0);
+		rep += CAESAR_RECORD_HEADER_SIZE;
+		if(status == CAESAR_RECORD_OK)
+		{
+			caesar_transform(record, rep, len, operation);
+			rep += len;
+		}
+		record += len;
+	}
+
+	SVC_SendReply(token, FM_OK);
+}
+
+
+
+// Returns the context of an open stream, or NULL if the id is unknown.
+static STREAM *find_stream(uint32_t id)
+{
+	uint32_t index = id & 0xFF;
+
+	if(id == 0 || index >= CAESAR_MAX_STREAMS || streams[index].id != id)
+		return NULL;
+	streams[index].last_used = message_count;
+	return &streams[index];
+}
+
+
+
+// Returns a free context or, when all are in use, the least recently used one if it has been idle for
+// CAESAR_STREAM_IDLE_MESSAGES messages. Its client has most likely died before final, but may also be a slow
+// client on a busy FM (see caesar_protocol.h). Returns NULL otherwise.
+static STREAM *free_stream(void)
+{
+	STREAM *oldest = NULL;
+
+	for(uint32_t ctr=0; ctr<CAESAR_MAX_STREAMS; ctr++)
+	{
+		if(streams[ctr].id == 0)
+			return &streams[ctr];
+		if(oldest == NULL || message_count - streams[ctr].last_used > message_count - oldest->last_used)
+			oldest = &streams[ctr];
+	}
+	if(message_count - oldest->last_used < CAESAR_STREAM_IDLE_MESSAGES)
+		return NULL;
+	return oldest;
+}
+
+
+
+// Opens a stream : operation. Replies with the stream id.
+static void stream_begin(FmMsgHandle token, const uint8_t *req, uint32_t req_len)
+{
+	uint32_t operation;
+	STREAM *stream = NULL;
+	uint8_t *rep;
+
+	if(req_len != 4)
+	{
+		SVC_SendReply(token, FM_ERR_INVALID_LENGTH);
+		return;
+	}
+	operation = get_be32(req);
+	if(operation > CAESAR_OP_ENCRYPT)
+	{
+		SVC_SendReply(token, CAESAR_ERR_BAD_OPERATION);
+		return;
+	}
+	if((stream = free_stream()) == NULL)
+	{
+		SVC_SendReply(token, CAESAR_ERR_NO_STREAM);
+		return;
+	}
+	if ((rep = (uint8_t*)SVC_GetReplyBuffer(token, 4)) == NULL)
+	{
+		SVC_SendReply(token, FM_ERR_OUT_OF_MEMORY);
+		return;
+	}
+
+	stream_generation = (stream_generation + 1) & 0xFFFFFF;
+	if(stream_generation == 0)
+		stream_generation = 1;
+	stream->id = (stream_generation << 8) | (uint32_t)(stream - streams);
+	stream->operation = operation;
+	stream->processed = 0;
+	stream->end = 0;
+	stream->last_used = message_count;
+	put_be32(rep, stream->id);
+	SVC_SendReply(token, FM_OK);
+}
+
+
+
+// Processes a chunk of a stream : stream id, offset, length and payload. Replies with the length and the processed chunk.
+static void stream_update(FmMsgHandle token, const uint8_t *req, uint32_t req_len)
+{
+	uint32_t len;
+	uint64_t offset;
+	STREAM *stream;
+	uint8_t *rep;
+
+	if(req_len < 16)
+	{
+		SVC_SendReply(token, FM_ERR_INVALID_LENGTH);
+		return;
+	}
+	if((stream = find_stream(get_be32(req))) == NULL)
+	{
+		SVC_SendReply(token, CAESAR_ERR_NO_STREAM);
+		return;
+	}
+	offset = get_be64(req + 4);
+	len = get_be32(req + 12);
+	req += 16;
+	req_len -= 16;
+	if(len != req_len || len > CAESAR_STREAM_MAX_CHUNK || offset > UINT64_MAX - len)
+	{
+		SVC_SendReply(token, FM_ERR_INVALID_LENGTH);
+		return;
+	}
+	if ((rep = (uint8_t*)SVC_GetReplyBuffer(token, sizeof(len) + len)) == NULL)
+	{
+		SVC_SendReply(token, FM_ERR_OUT_OF_MEMORY);
+		return;
+	}
+
+	put_be32(rep, len);
+	caesar_transform(req, rep + sizeof(len), len, stream->operation);
+	stream->processed += len;
+	if(offset + len > stream->end)
+		stream->end = offset + len;
+	SVC_SendReply(token, FM_OK);
+}
+
+
+
+// Closes a stream : stream id and total length. Replies with the total length if the updates cover it exactly.
+static void stream_final(FmMsgHandle token, const uint8_t *req, uint32_t req_len)
+{
+	uint64_t total, processed, end;
+	STREAM *stream;
+	uint8_t *rep;
+
+	if(req_len != 12)
+	{
+		SVC_SendReply(token, FM_ERR_INVALID_LENGTH);
+		return;
+	}
+	if((stream = find_stream(get_be32(req))) == NULL)
+	{
+		SVC_SendReply(token, CAESAR_ERR_NO_STREAM);
+		return;
+	}
+	total = get_be64(req + 4);
+	processed = stream->processed;
+	end = stream->end;
+	memset(stream, 0, sizeof(*stream));
+
+	// Catches missing, repeated and extra updates. An overlap exactly made up by a gap is not detected.
+	if(processed != total || end != total)
+	{
+		SVC_SendReply(token, CAESAR_ERR_STREAM_LENGTH);
+		return;
+	}
+	if ((rep = (uint8_t*)SVC_GetReplyBuffer(token, 8)) == NULL)
+	{
+		SVC_SendReply(token, FM_ERR_OUT_OF_MEMORY);
+		return;
+	}
+	put_be64(rep, total);
+	SVC_SendReply(token, FM_OK);
+}
+
+
+
 static void dispatch_message(FmMsgHandle token, void* req, uint32_t req_len)
 {
 	uint32_t len; // Length of message.
 	uint32_t slot; // embedded slot number
 	uint32_t operation; // requested cryptographic operation.
-	char buff[BUFFER_SIZE];
-	char *rep;
-	char ch;
+	uint8_t *rep;
 
+	message_count++;
 
 	// Reads embedded slot number.
 	if(req_len < sizeof(slot))
@@ -46,7 +403,8 @@ static void dispatch_message(FmMsgHandle token, void* req, uint32_t req_len)
 	req_len -= sizeof(uint32_t);
 
 
-	// Read requested cryptographic operation to perform. 1 for encrypt, 0 for decrypt.
+	// Read requested cryptographic operation to perform. 1 for encrypt, 0 for decrypt, 2 for a batch of records,
+	// 3 to 5 for a stream.
 	if(req_len < sizeof(operation))
 	{
 		SVC_SendReply(token, FM_ERR_INVALID_LENGTH);
@@ -56,6 +414,22 @@ static void dispatch_message(FmMsgHandle token, void* req, uint32_t req_len)
 	req += sizeof(uint32_t);
 	req_len -= sizeof(uint32_t);
 
+	switch(operation)
+	{
+		case CAESAR_OP_BATCH:
+			dispatch_batch(token, (const uint8_t*)req, req_len);
+			return;
+		case CAESAR_OP_STREAM_BEGIN:
+			stream_begin(token, (const uint8_t*)req, req_len);
+			return;
+		case CAESAR_OP_STREAM_UPDATE:
+			stream_update(token, (const uint8_t*)req, req_len);
+			return;
+		case CAESAR_OP_STREAM_FINAL:
+			stream_final(token, (const uint8_t*)req, req_len);
+			return;
+	}
+
 
 	// Read data size.
 	if (req_len < sizeof(len))
@@ -68,63 +442,25 @@ static void dispatch_message(FmMsgHandle token, void* req, uint32_t req_len)
 	req_len -= sizeof(uint32_t);
 
 
-	// Ensure sufficient memory is left.
-	if ((len > sizeof(buff) || (req_len!=len)))
+	// The message must fill the rest of the request, and its reply must fit in a message.
+	if ((len > CAESAR_MAX_DATA_SIZE || (req_len!=len)))
 	{
 		SVC_SendReply(token, FM_ERR_INVALID_LENGTH);
 		return;
 	}
 
 
-	// Copy message from the received request into buffer.
-	memcpy(buff, req, len);
-
-
-	// Encrypts message using Caesar shift technique.
-	if(operation==1)
-	{
-		for(uint32_t ctr=0; ctr<len; ctr++)
-		{
-			ch = toupper(buff[ctr]);
-			if (ch >= 65 && ch <= 90)
-			{
-				if (ch + 3 > 90)
-					ch = ch - 23;
-				else
-					ch = ch + 3;
-			}
-			buff[ctr] = ch;
-
-		}
-	}
-	else
-	{
-		for(uint32_t ctr=0; ctr<len; ctr++)
-		{
-			ch = toupper(buff[ctr]);
-			if (ch >= 65 && ch <= 90)
-			{
-				if (ch - 3 < 65)
-					ch+=23;
-				else
-					ch-=3;
-			}
-			buff[ctr] = ch;
-		}
-	}
-
-
-	if ((rep = (char*)SVC_GetReplyBuffer(token, sizeof(len)+len)) == NULL)
+	if ((rep = (uint8_t*)SVC_GetReplyBuffer(token, sizeof(len)+len)) == NULL)
 	{
 		SVC_SendReply(token, FM_ERR_OUT_OF_MEMORY);
 		return;
 	}
-	*(uint32_t*)rep = fm_htobe32(len);
+	put_be32(rep, len);
 	rep+=sizeof(uint32_t);
 
 
-	// Copy output into buffer
-	memcpy(rep, buff, len);
+	// Encrypts or decrypts the message from the request straight into the reply.
+	caesar_transform((const uint8_t*)req, rep, len, operation);
 
 	SVC_SendReply(token, FM_OK);
 	return;
@@ -133,6 +469,7 @@ static void dispatch_message(FmMsgHandle token, void* req, uint32_t req_len)
 
 FM_RV Startup(void)
 {
-	printf("Caesar FM loaded.");
+	printf("Caesar FM loaded.\n");
+	build_tables();
 	return FMSW_RegisterRandomDispatch(GetFMID(), dispatch_message);
 }
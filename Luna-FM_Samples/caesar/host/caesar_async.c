@@ -0,0 +1,438 @@
+        /*********************************************************************************\
+        *                                                                                *
+        * This file is part of the "luna-samples" project.                               *
+        *                                                                                *
+        * The "luna-samples" project is provided under the MIT license (see the          *
+        * following Web site for further details: https://mit-license.org/ ).            *
+        *                                                                                *
+        * Copyright © 2025 Thales Group                                                  *
+        *                                                                                *
+        **********************************************************************************
+	OBJECTIVE:
+	- This code implements the asynchronous Caesar FM client declared in caesar_async.h.
+	- Requests wait in a queue per adapter. Worker threads of the adapter take them one at a time and call
+	  MD_SendReceive, then move them to the completion queue shared by all adapters.
+	- caesarAsyncSend queues each request on the adapter with the fewest outstanding requests, breaking ties with
+	  the moving average of the round trips of each adapter.
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <md.h>
+#include <fm/common/fm_byteorder.h>
+#include <fm/common/fmerr.h>
+#include "caesar_protocol.h"
+#include "caesar_async.h"
+
+#define REQUEST_TIMEOUT 10000 // MD_SendReceive timeout, in milliseconds.
+
+
+// A request, from submission to completion.
+typedef struct REQUEST
+{
+	struct REQUEST *next;
+	uint8_t *body; // Slot number followed by the body given to caesarAsyncSend.
+	uint32_t bodyLength;
+	uint32_t replySize;
+	struct timespec submitted;
+	CAESAR_COMPLETION completion;
+} REQUEST;
+
+
+// An adapter hosting the FM, with its queue of requests.
+typedef struct
+{
+	struct CAESAR_ASYNC *owner;
+	uint32_t hsmIndex;
+	uint32_t fmid;
+	uint32_t embeddedSlot;
+	REQUEST *first, *last; // Requests waiting for a worker.
+	int queued;
+	int outstanding; // Queued or being sent.
+	unsigned long requests, failures;
+	double totalLatency, averageLatency; // MD_SendReceive round trips, in seconds.
+	pthread_cond_t notEmpty;
+} ADAPTER;
+
+
+struct CAESAR_ASYNC
+{
+	ADAPTER *adapters;
+	int adapterCount;
+	pthread_t *workers;
+	int workerCount;
+	REQUEST *completedFirst, *completedLast;
+	unsigned long outstanding; // Submitted and not yet collected.
+	int closing;
+	pthread_mutex_t lock;
+	pthread_cond_t completed, notFull;
+};
+
+
+
+// Returns the seconds elapsed since start.
+static double secondsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+
+// Worker thread of an adapter; sends one request at a time until the client is closed.
+static void *worker(void *arg)
+{
+	ADAPTER *adapter = (ADAPTER*)arg;
+	CAESAR_ASYNC *async = adapter->owner;
+	MD_Buffer_t request[2], response[2];
+	uint32_t receivedLength = 0;
+	REQUEST *req = NULL;
+	struct timespec sent;
+	double roundTrip = 0;
+
+	while(1)
+	{
+		pthread_mutex_lock(&async->lock);
+		while(adapter->queued==0 && !async->closing)
+			pthread_cond_wait(&adapter->notEmpty, &async->lock);
+		if(adapter->queued==0)
+		{
+			pthread_mutex_unlock(&async->lock);
+			break;
+		}
+		req = adapter->first;
+		adapter->first = req->next;
+		if(adapter->first==NULL)
+			adapter->last = NULL;
+		adapter->queued--;
+		pthread_cond_broadcast(&async->notFull);
+		pthread_mutex_unlock(&async->lock);
+
+		request[0].pData = req->body;
+		request[0].length = req->bodyLength;
+		request[1].pData = NULL;
+		request[1].length = 0;
+		req->completion.reply = (uint8_t*)malloc(req->replySize ? req->replySize : 1);
+		response[0].pData = req->completion.reply;
+		response[0].length = req->replySize;
+		response[1].pData = NULL;
+		response[1].length = 0;
+		receivedLength = 0;
+		clock_gettime(CLOCK_MONOTONIC, &sent);
+		req->completion.mdStatus = MD_SendReceive(adapter->hsmIndex, 0, (uint16_t)adapter->fmid, request, REQUEST_TIMEOUT,
+		                                          response, &receivedLength, &req->completion.fmStatus);
+		roundTrip = secondsSince(&sent);
+		req->completion.replyLength = receivedLength;
+		req->completion.adapter = adapter->hsmIndex;
+		req->completion.latency = secondsSince(&req->submitted);
+		free(req->body);
+		req->body = NULL;
+		req->next = NULL;
+
+		pthread_mutex_lock(&async->lock);
+		adapter->outstanding--;
+		adapter->requests++;
+		if(req->completion.mdStatus!=MDR_OK || req->completion.fmStatus!=FM_OK)
+			adapter->failures++;
+		adapter->totalLatency += roundTrip;
+		adapter->averageLatency = adapter->requests==1 ? roundTrip
+		                        : adapter->averageLatency + CAESAR_ASYNC_LATENCY_WEIGHT * (roundTrip - adapter->averageLatency);
+		if(async->completedLast!=NULL)
+			async->completedLast->next = req;
+		else
+			async->completedFirst = req;
+		async->completedLast = req;
+		pthread_cond_signal(&async->completed);
+		pthread_mutex_unlock(&async->lock);
+	}
+	return NULL;
+}
+
+
+
+// Allocates a client for up to adapterCount adapters. Called after MD_Initialize.
+static CAESAR_ASYNC *createClient(uint32_t adapterCount)
+{
+	CAESAR_ASYNC *async = (CAESAR_ASYNC*)calloc(1, sizeof(CAESAR_ASYNC));
+
+	async->adapters = (ADAPTER*)calloc(adapterCount ? adapterCount : 1, sizeof(ADAPTER));
+	pthread_mutex_init(&async->lock, NULL);
+	pthread_cond_init(&async->completed, NULL);
+	pthread_cond_init(&async->notFull, NULL);
+	return async;
+}
+
+
+
+// Frees a client whose workers are stopped or were never started, and finalizes MD.
+static void destroyClient(CAESAR_ASYNC *async)
+{
+	pthread_cond_destroy(&async->notFull);
+	pthread_cond_destroy(&async->completed);
+	pthread_mutex_destroy(&async->lock);
+	free(async->workers);
+	free(async->adapters);
+	free(async);
+	MD_Finalize();
+}
+
+
+
+// Starts depth workers for each adapter of the client.
+static void startWorkers(CAESAR_ASYNC *async, int depth)
+{
+	depth = depth<1 ? 1 : depth;
+	async->workerCount = depth * async->adapterCount;
+	async->workers = (pthread_t*)malloc(async->workerCount * sizeof(pthread_t));
+	for(int ctr=0; ctr<async->adapterCount; ctr++)
+	{
+		async->adapters[ctr].owner = async;
+		pthread_cond_init(&async->adapters[ctr].notEmpty, NULL);
+		for(int thread=0; thread<depth; thread++)
+			pthread_create(&async->workers[ctr * depth + thread], NULL, &worker, &async->adapters[ctr]);
+	}
+}
+
+
+
+CAESAR_ASYNC *caesarAsyncOpen(int slotId, const char *fmName, int depth, MD_RV *rv)
+{
+	CAESAR_ASYNC *async = NULL;
+	ADAPTER *adapter = NULL;
+	CK_SLOT_ID embeddedSlotId = 0;
+
+	if((*rv = MD_Initialize())!=MDR_OK)
+		return NULL;
+	async = createClient(1);
+	adapter = &async->adapters[0];
+	if((*rv = MD_GetHsmIndexForSlot(slotId, &adapter->hsmIndex))!=MDR_OK
+	   || (*rv = MD_GetEmbeddedSlotID(slotId, &embeddedSlotId))!=MDR_OK
+	   || (*rv = MD_GetFmIdFromName(adapter->hsmIndex, (char*)fmName, (uint32_t)strlen(fmName), &adapter->fmid))!=MDR_OK)
+	{
+		destroyClient(async);
+		return NULL;
+	}
+	adapter->embeddedSlot = (uint32_t)embeddedSlotId;
+	async->adapterCount = 1;
+	startWorkers(async, depth);
+	return async;
+}
+
+
+
+CAESAR_ASYNC *caesarAsyncOpenAll(const char *fmName, int depth, MD_RV *rv)
+{
+	CAESAR_ASYNC *async = NULL;
+	ADAPTER *adapter = NULL;
+	uint32_t hsmCount = 0;
+
+	if((*rv = MD_Initialize())!=MDR_OK)
+		return NULL;
+	if((*rv = MD_GetHsmCount(&hsmCount))!=MDR_OK)
+	{
+		MD_Finalize();
+		return NULL;
+	}
+	async = createClient(hsmCount);
+
+	// Keeps the adapters the FM is loaded on.
+	for(uint32_t hsmIndex=0; hsmIndex<hsmCount; hsmIndex++)
+	{
+		adapter = &async->adapters[async->adapterCount];
+		if(MD_GetFmIdFromName(hsmIndex, (char*)fmName, (uint32_t)strlen(fmName), &adapter->fmid)!=MDR_OK)
+			continue;
+		adapter->hsmIndex = hsmIndex;
+		async->adapterCount++;
+	}
+	if(async->adapterCount==0)
+	{
+		*rv = MDR_FM_NOT_AVAILABLE;
+		destroyClient(async);
+		return NULL;
+	}
+	startWorkers(async, depth);
+	return async;
+}
+
+
+
+// Returns the adapter with the fewest outstanding requests, or the lowest average latency among those. Called with the lock held.
+static ADAPTER *chooseAdapter(CAESAR_ASYNC *async)
+{
+	ADAPTER *best = &async->adapters[0];
+
+	for(int ctr=1; ctr<async->adapterCount; ctr++)
+	{
+		ADAPTER *adapter = &async->adapters[ctr];
+		if(adapter->outstanding<best->outstanding
+		   || (adapter->outstanding==best->outstanding && adapter->averageLatency<best->averageLatency))
+			best = adapter;
+	}
+	return best;
+}
+
+
+
+// Queues a request on adapter, or on the least loaded adapter if adapter is NULL.
+static int queueRequest(CAESAR_ASYNC *async, ADAPTER *adapter, const void *body, uint32_t bodyLength, uint32_t replySize, void *context)
+{
+	REQUEST *req = (REQUEST*)calloc(1, sizeof(REQUEST));
+	ADAPTER *pinned = adapter;
+	uint32_t slot = 0;
+
+	req->bodyLength = sizeof(slot) + bodyLength;
+	req->body = (uint8_t*)malloc(req->bodyLength);
+	memcpy(req->body + sizeof(slot), body, bodyLength);
+	req->replySize = replySize;
+	req->completion.context = context;
+
+	pthread_mutex_lock(&async->lock);
+	while((adapter = pinned ? pinned : chooseAdapter(async))->queued>=CAESAR_ASYNC_QUEUE_SIZE && !async->closing)
+		pthread_cond_wait(&async->notFull, &async->lock);
+	if(async->closing)
+	{
+		pthread_mutex_unlock(&async->lock);
+		free(req->body);
+		free(req);
+		return 0;
+	}
+	slot = fm_htobe32(adapter->embeddedSlot);
+	memcpy(req->body, &slot, sizeof(slot));
+	clock_gettime(CLOCK_MONOTONIC, &req->submitted);
+	if(adapter->last!=NULL)
+		adapter->last->next = req;
+	else
+		adapter->first = req;
+	adapter->last = req;
+	adapter->queued++;
+	adapter->outstanding++;
+	async->outstanding++;
+	pthread_cond_signal(&adapter->notEmpty);
+	pthread_mutex_unlock(&async->lock);
+	return 1;
+}
+
+
+
+int caesarAsyncSend(CAESAR_ASYNC *async, const void *body, uint32_t bodyLength, uint32_t replySize, void *context)
+{
+	return queueRequest(async, NULL, body, bodyLength, replySize, context);
+}
+
+
+
+int caesarAsyncSendTo(CAESAR_ASYNC *async, uint32_t hsmIndex, const void *body, uint32_t bodyLength, uint32_t replySize, void *context)
+{
+	for(int ctr=0; ctr<async->adapterCount; ctr++)
+		if(async->adapters[ctr].hsmIndex==hsmIndex)
+			return queueRequest(async, &async->adapters[ctr], body, bodyLength, replySize, context);
+	return 0;
+}
+
+
+
+int caesarAsyncSubmit(CAESAR_ASYNC *async, uint32_t operation, const void *message, uint32_t length, void *context)
+{
+	uint8_t *body = (uint8_t*)malloc(8 + length);
+	uint32_t value = 0;
+	int queued = 0;
+
+	value = fm_htobe32(operation);
+	memcpy(body, &value, sizeof(value));
+	value = fm_htobe32(length);
+	memcpy(body + 4, &value, sizeof(value));
+	memcpy(body + 8, message, length);
+	queued = caesarAsyncSend(async, body, 8 + length, 4 + length, context);
+	free(body);
+	return queued;
+}
+
+
+
+// Takes the first completed request. Called with the lock held.
+static int takeCompletion(CAESAR_ASYNC *async, CAESAR_COMPLETION *completion)
+{
+	REQUEST *req = async->completedFirst;
+
+	if(req==NULL)
+		return 0;
+	async->completedFirst = req->next;
+	if(async->completedFirst==NULL)
+		async->completedLast = NULL;
+	async->outstanding--;
+	*completion = req->completion;
+	free(req);
+	return 1;
+}
+
+
+
+int caesarAsyncWait(CAESAR_ASYNC *async, CAESAR_COMPLETION *completion)
+{
+	int taken = 0;
+
+	pthread_mutex_lock(&async->lock);
+	while(async->completedFirst==NULL && async->outstanding>0)
+		pthread_cond_wait(&async->completed, &async->lock);
+	taken = takeCompletion(async, completion);
+	pthread_mutex_unlock(&async->lock);
+	return taken;
+}
+
+
+
+int caesarAsyncPoll(CAESAR_ASYNC *async, CAESAR_COMPLETION *completion)
+{
+	int taken = 0;
+
+	pthread_mutex_lock(&async->lock);
+	taken = takeCompletion(async, completion);
+	pthread_mutex_unlock(&async->lock);
+	return taken;
+}
+
+
+
+int caesarAsyncStats(CAESAR_ASYNC *async, CAESAR_ADAPTER_STATS *stats, int maxCount)
+{
+	pthread_mutex_lock(&async->lock);
+	for(int ctr=0; ctr<async->adapterCount && ctr<maxCount; ctr++)
+	{
+		ADAPTER *adapter = &async->adapters[ctr];
+		stats[ctr].hsmIndex = adapter->hsmIndex;
+		stats[ctr].requests = adapter->requests;
+		stats[ctr].failures = adapter->failures;
+		stats[ctr].outstanding = adapter->outstanding;
+		stats[ctr].meanLatency = adapter->requests ? adapter->totalLatency / adapter->requests : 0;
+		stats[ctr].averageLatency = adapter->averageLatency;
+	}
+	pthread_mutex_unlock(&async->lock);
+	return async->adapterCount;
+}
+
+
+
+void caesarAsyncClose(CAESAR_ASYNC *async)
+{
+	CAESAR_COMPLETION completion;
+
+	pthread_mutex_lock(&async->lock);
+	async->closing = 1;
+	for(int ctr=0; ctr<async->adapterCount; ctr++)
+		pthread_cond_broadcast(&async->adapters[ctr].notEmpty);
+	pthread_cond_broadcast(&async->notFull);
+	pthread_mutex_unlock(&async->lock);
+	for(int ctr=0; ctr<async->workerCount; ctr++)
+		pthread_join(async->workers[ctr], NULL);
+
+	while(caesarAsyncPoll(async, &completion))
+		free(completion.reply);
+	for(int ctr=0; ctr<async->adapterCount; ctr++)
+		pthread_cond_destroy(&async->adapters[ctr].notEmpty);
+	destroyClient(async);
+}
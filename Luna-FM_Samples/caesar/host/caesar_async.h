@@ -0,0 +1,84 @@
+/*
+ * Asynchronous client for the Caesar FM.
+ *
+ * MD_Initialize, the adapters and the FM ID are resolved once when the client is opened. Each adapter then has a
+ * number of worker threads (the depth), so that many requests are in flight at once even though MD_SendReceive
+ * blocks. Any thread may submit requests; completed requests are collected from a completion queue, in the order
+ * they complete.
+ *
+ * A client opened with caesarAsyncOpenAll uses every adapter hosting the FM. Each request goes to the adapter with
+ * the fewest outstanding requests and, between adapters with as many, to the one whose recent round trips were
+ * the shortest.
+ */
+
+#ifndef CAESAR_ASYNC_H
+#define CAESAR_ASYNC_H
+
+#include <stdint.h>
+#include <md.h>
+
+#define CAESAR_ASYNC_QUEUE_SIZE 256 // Requests waiting per adapter before caesarAsyncSend blocks.
+#define CAESAR_ASYNC_LATENCY_WEIGHT 0.125 // Weight of the last round trip in the average latency of an adapter.
+
+
+typedef struct CAESAR_ASYNC CAESAR_ASYNC;
+
+
+// A completed request.
+typedef struct
+{
+	void *context; // As given to caesarAsyncSend.
+	MD_RV mdStatus;
+	uint32_t fmStatus;
+	uint8_t *reply; // Reply of the FM; free it with free().
+	uint32_t replyLength;
+	uint32_t adapter; // HSM index the request was sent to.
+	double latency; // Seconds from submission to completion.
+} CAESAR_COMPLETION;
+
+
+// Counters of an adapter.
+typedef struct
+{
+	uint32_t hsmIndex;
+	unsigned long requests; // Completed requests.
+	unsigned long failures; // Completed requests with an MD or FM status other than OK.
+	int outstanding; // Requests queued or being sent.
+	double meanLatency; // Mean MD_SendReceive round trip, in seconds.
+	double averageLatency; // Moving average of the round trip, as used to choose an adapter.
+} CAESAR_ADAPTER_STATS;
+
+
+// Initializes MD, resolves the adapter of a slot and the FM ID, and starts depth worker threads.
+// Returns NULL on failure, with the MD status in rv.
+CAESAR_ASYNC *caesarAsyncOpen(int slotId, const char *fmName, int depth, MD_RV *rv);
+
+// Initializes MD and starts depth worker threads for every adapter hosting the FM. Requests carry embedded slot 0.
+// Returns NULL on failure, with the MD status in rv (MDR_FM_NOT_AVAILABLE if no adapter hosts the FM).
+CAESAR_ASYNC *caesarAsyncOpenAll(const char *fmName, int depth, MD_RV *rv);
+
+// Queues a request on the least loaded adapter. body is the request after the slot number (which the client adds);
+// it is copied. replySize is the largest reply expected. Blocks while the queue of the adapter is full.
+// Returns 0 once the client is closing.
+int caesarAsyncSend(CAESAR_ASYNC *async, const void *body, uint32_t bodyLength, uint32_t replySize, void *context);
+
+// Queues a request on a given adapter, the one in the completion of an earlier request. Used for requests that
+// depend on state held by the FM of that adapter. Returns 0 if the client has no such adapter, or is closing.
+int caesarAsyncSendTo(CAESAR_ASYNC *async, uint32_t hsmIndex, const void *body, uint32_t bodyLength, uint32_t replySize, void *context);
+
+// Queues an encrypt or decrypt request for a message.
+int caesarAsyncSubmit(CAESAR_ASYNC *async, uint32_t operation, const void *message, uint32_t length, void *context);
+
+// Waits for the next completed request. Returns 0 if no request is outstanding.
+int caesarAsyncWait(CAESAR_ASYNC *async, CAESAR_COMPLETION *completion);
+
+// Returns the next completed request without waiting. Returns 0 if none has completed yet.
+int caesarAsyncPoll(CAESAR_ASYNC *async, CAESAR_COMPLETION *completion);
+
+// Copies the counters of up to maxCount adapters into stats. Returns the number of adapters.
+int caesarAsyncStats(CAESAR_ASYNC *async, CAESAR_ADAPTER_STATS *stats, int maxCount);
+
+// Waits for the outstanding requests, stops the workers and finalizes MD. Completions not collected are discarded.
+void caesarAsyncClose(CAESAR_ASYNC *async);
+
+#endif
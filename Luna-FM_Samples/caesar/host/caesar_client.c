@@ -11,6 +11,15 @@
 	OBJECTIVE:
 	- This code demonstrates how a host application communicates with an FM.
 	- This code sends a text to the FM for encryption or decryption, and reads the received response.
+	- In batch mode (-B), it reads one record per line from a file, packs up to CAESAR_BATCH_MAX_RECORDS records into
+	  each request, and sends them with one MD_SendReceive per batch instead of one per record.
+	- In pipelined mode (-P), it sends each record of the file as its own request through the asynchronous client
+	  (caesar_async.h), keeping up to <depth> requests in flight, and prints the replies in the order of the file.
+	- In multi-adapter mode (-M), it does the same over every adapter hosting the FM, keeping up to <depth> requests
+	  in flight per adapter, and prints the requests and latency of each adapter.
+	- In stream mode (-S), it encrypts or decrypts a file of any length as a stream of chunks (begin, update and final
+	  requests), with up to <depth> chunks in flight. The FM holds the context of the stream, so all the chunks go to
+	  the adapter that opened it.
 */
 
 
@@ -18,10 +27,29 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
 #include <md.h>
 #include <mdStrings.h>
 #include <fm/common/fm_byteorder.h>
 #include <fm/common/fmerr.h>
+#include "caesar_protocol.h"
+#include "caesar_async.h"
+
+#define MAX_LINE_LEN (CAESAR_MAX_DATA_SIZE + 3) // Operation, space and newline.
+#define DEFAULT_DEPTH 8 // Requests in flight per adapter in pipelined mode.
+#define MAX_ADAPTERS 64 // Adapters reported in multi-adapter mode.
+#define STREAM_CHUNK_SIZE (32 * 1024) // Bytes per update in stream mode; at most CAESAR_STREAM_MAX_CHUNK.
+
+
+// A record of a batch.
+typedef struct
+{
+	uint32_t operation;
+	uint32_t length;
+	char *text;
+} RECORD;
+
 
 MD_RV retValue = MDR_OK;
 int slotId;
@@ -30,7 +58,7 @@ uint32_t adapterNumber;
 uint32_t fmid;
 char *message = NULL;
 char *fmName = "Caesar";
-char buffer[128];
+char *buffer = NULL; // Received message.
 uint32_t doEncryption = 0;
 
 
@@ -38,13 +66,27 @@ uint32_t doEncryption = 0;
 void usage(const char *exeName)
 {
 	printf("\nUsage :-\n");
-	printf("%s <slot_number> -<OPERATION> <message>\n\n", exeName);
+	printf("%s <slot_number> -<OPERATION> <message>\n", exeName);
+	printf("%s <slot_number> -B <file>\n", exeName);
+	printf("%s <slot_number> -P <file> [depth]\n", exeName);
+	printf("%s <slot_number> -M <file> [depth]\n", exeName);
+	printf("%s <slot_number> -S <E|D> <input_file> <output_file> [depth]\n\n", exeName);
 	printf("<OPERATIONS>:\n");
 	printf("-E : Encrypt message\n");
-	printf("-D : Decrypt message\n\n");
+	printf("-D : Decrypt message\n");
+	printf("-B : Batch mode. Each line of the file (- for standard input) is a record : E <message> or D <message>\n");
+	printf("-P : Pipelined mode. Same file as -B, one request per record with up to depth (default %d) requests in flight\n", DEFAULT_DEPTH);
+	printf("-M : Multi-adapter mode. Same as -P over every adapter hosting the FM, with depth requests in flight per adapter.\n");
+	printf("     The slot number is not used\n");
+	printf("-S : Stream mode. Encrypts (E) or decrypts (D) a file of any length in chunks of %d bytes,\n", STREAM_CHUNK_SIZE);
+	printf("     with up to depth (default %d) chunks in flight\n\n", DEFAULT_DEPTH);
 	printf("Example : \n");
 	printf("./bin/caesar_client 0 -E \"Hello World.\"\n");
-	printf("./bin/caesar_client 0 -D \"Khoor Zruog.\"\n\n");
+	printf("./bin/caesar_client 0 -D \"Khoor Zruog.\"\n");
+	printf("./bin/caesar_client 0 -B records.txt\n");
+	printf("./bin/caesar_client 0 -P records.txt 16\n");
+	printf("./bin/caesar_client 0 -M records.txt 16\n");
+	printf("./bin/caesar_client 0 -S E plain.txt cipher.txt\n\n");
 }
 
 
@@ -115,6 +157,7 @@ void sendRequest()
 
 	// Crafting the buffer for storing a response from FM.
 	response_len = 0;
+	buffer = (char*)calloc(message_len + 1, 1);
 
 	response[0].pData = (uint8_t *)&response_len;
 	response[0].length = sizeof(response_len);
@@ -138,6 +181,411 @@ void sendRequest()
 	}
 }
 
+// Returns the seconds elapsed since start.
+double secondsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+
+// Writes a big-endian 32-bit integer.
+void putBe32(uint8_t *p, uint32_t value)
+{
+	value = fm_htobe32(value);
+	memcpy(p, &value, sizeof(value));
+}
+
+
+
+// Reads a big-endian 32-bit integer.
+uint32_t getBe32(const uint8_t *p)
+{
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return fm_betoh32(value);
+}
+
+
+
+// Reads the records of a batch file. Each line is "E <message>" or "D <message>".
+RECORD *readRecords(const char *fileName, uint32_t *recordCount)
+{
+	FILE *file = strcmp(fileName, "-")==0 ? stdin : fopen(fileName, "r");
+	char line[MAX_LINE_LEN];
+	RECORD *records = NULL;
+	uint32_t capacity = 0;
+	size_t len = 0;
+
+	if(file==NULL)
+	{
+		printf("Failed to open %s.\n", fileName);
+		exit(1);
+	}
+	*recordCount = 0;
+	while(fgets(line, sizeof(line), file)!=NULL)
+	{
+		len = strcspn(line, "\r\n");
+		line[len] = '\0';
+		if(len==0)
+			continue;
+		if(len<2 || (line[0]!='E' && line[0]!='D') || line[1]!=' ')
+		{
+			printf("Invalid record : %s\n", line);
+			exit(1);
+		}
+		if(*recordCount==capacity)
+		{
+			capacity = capacity ? capacity * 2 : 64;
+			records = (RECORD*)realloc(records, capacity * sizeof(RECORD));
+		}
+		records[*recordCount].operation = line[0]=='E' ? CAESAR_OP_ENCRYPT : CAESAR_OP_DECRYPT;
+		records[*recordCount].length = (uint32_t)(len - 2);
+		records[*recordCount].text = strdup(line + 2);
+		(*recordCount)++;
+	}
+	if(file!=stdin)
+		fclose(file);
+	return records;
+}
+
+
+
+// Sends count records in one batch request and prints the replies.
+void sendBatch(RECORD *records, uint32_t first, uint32_t count, uint32_t requestLength)
+{
+	MD_Buffer_t request[2];
+	MD_Buffer_t response[2];
+	uint8_t *req = (uint8_t*)malloc(requestLength);
+	uint8_t *rep = (uint8_t*)malloc(requestLength); // A reply is never longer than its request.
+	uint8_t *p = req;
+	uint32_t receive_len, fm_status, status, len;
+
+	putBe32(p, (uint32_t)embeddedSlotId);
+	putBe32(p + 4, CAESAR_OP_BATCH);
+	putBe32(p + 8, CAESAR_BATCH_VERSION);
+	putBe32(p + 12, count);
+	p += 8 + CAESAR_BATCH_HEADER_SIZE;
+	for(uint32_t ctr=first; ctr<first + count; ctr++)
+	{
+		putBe32(p, records[ctr].operation);
+		putBe32(p + 4, records[ctr].length);
+		memcpy(p + CAESAR_RECORD_HEADER_SIZE, records[ctr].text, records[ctr].length);
+		p += CAESAR_RECORD_HEADER_SIZE + records[ctr].length;
+	}
+
+	request[0].pData = req;
+	request[0].length = requestLength;
+	request[1].pData = NULL;
+	request[1].length = 0;
+	response[0].pData = rep;
+	response[0].length = requestLength;
+	response[1].pData = NULL;
+	response[1].length = 0;
+
+	checkOperation(MD_SendReceive(adapterNumber, 0, (uint16_t)fmid, request, 10000, response, &receive_len, &fm_status), "MD_SendReceive");
+	if(fm_status!=FM_OK)
+	{
+		printf("FM failed : %d", fm_status);
+		MD_Finalize();
+		exit(1);
+	}
+	if(receive_len<CAESAR_BATCH_HEADER_SIZE || getBe32(rep)!=CAESAR_BATCH_VERSION || getBe32(rep + 4)!=count)
+	{
+		printf("Invalid batch reply.\n");
+		MD_Finalize();
+		exit(1);
+	}
+
+	p = rep + CAESAR_BATCH_HEADER_SIZE;
+	for(uint32_t ctr=first; ctr<first + count; ctr++)
+	{
+		if(p + CAESAR_RECORD_HEADER_SIZE > rep + receive_len)
+		{
+			printf("Truncated batch reply.\n");
+			MD_Finalize();
+			exit(1);
+		}
+		status = getBe32(p);
+		len = getBe32(p + 4);
+		p += CAESAR_RECORD_HEADER_SIZE;
+		if(len > (uint32_t)(rep + receive_len - p))
+		{
+			printf("Truncated batch reply.\n");
+			MD_Finalize();
+			exit(1);
+		}
+		if(status==CAESAR_RECORD_OK)
+			printf("Record %u : %.*s\n", ctr, (int)len, (char*)p);
+		else
+			printf("Record %u : failed with status %u.\n", ctr, status);
+		p += len;
+	}
+	free(req);
+	free(rep);
+}
+
+
+
+// Sends all records of a file, as few batches as the record and message size limits allow.
+void runBatch(const char *fileName)
+{
+	uint32_t recordCount = 0, first = 0, count = 0, batches = 0;
+	uint32_t requestLength = 0, recordLength = 0;
+	RECORD *records = readRecords(fileName, &recordCount);
+	struct timespec start;
+	double seconds = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while(first<recordCount)
+	{
+		requestLength = 8 + CAESAR_BATCH_HEADER_SIZE; // slot, operation, version and record count.
+		for(count=0; first + count<recordCount && count<CAESAR_BATCH_MAX_RECORDS; count++)
+		{
+			recordLength = CAESAR_RECORD_HEADER_SIZE + records[first + count].length;
+			if(requestLength + recordLength>CAESAR_MAX_MESSAGE_SIZE)
+				break;
+			requestLength += recordLength;
+		}
+		if(count==0)
+		{
+			printf("Record %u is too long for a message.\n", first);
+			exit(1);
+		}
+		sendBatch(records, first, count, requestLength);
+		first += count;
+		batches++;
+	}
+	seconds = secondsSince(&start);
+
+	printf("\n%u records sent in %u batches, in %.3f seconds.\n", recordCount, batches, seconds);
+	if(seconds>0)
+		printf("%.0f records per second.\n", recordCount / seconds);
+	for(uint32_t ctr=0; ctr<recordCount; ctr++)
+		free(records[ctr].text);
+	free(records);
+}
+
+
+
+// Prints the counters of each adapter of an asynchronous client.
+void printAdapterStats(CAESAR_ASYNC *async)
+{
+	CAESAR_ADAPTER_STATS stats[MAX_ADAPTERS];
+	int count = caesarAsyncStats(async, stats, MAX_ADAPTERS);
+
+	for(int ctr=0; ctr<count && ctr<MAX_ADAPTERS; ctr++)
+		printf("Adapter %u : %lu requests (%lu failed), mean latency %.3f ms.\n", stats[ctr].hsmIndex,
+		       stats[ctr].requests, stats[ctr].failures, stats[ctr].meanLatency * 1000);
+}
+
+
+
+// Sends every record of a file as its own request, keeping up to depth requests in flight per adapter.
+// With allAdapters, the requests are spread over every adapter hosting the FM instead of the adapter of the slot.
+void runPipelined(const char *fileName, int depth, bool allAdapters)
+{
+	uint32_t recordCount = 0, next = 0, done = 0, failed = 0;
+	RECORD *records = readRecords(fileName, &recordCount);
+	char **replies = (char**)calloc(recordCount ? recordCount : 1, sizeof(char*));
+	CAESAR_ASYNC *async = NULL;
+	CAESAR_COMPLETION completion;
+	uint32_t index = 0, len = 0, window = 0;
+	struct timespec start;
+	double seconds = 0, latency = 0;
+
+	if(allAdapters)
+	{
+		async = caesarAsyncOpenAll(fmName, depth, &retValue);
+		checkOperation(retValue, "caesarAsyncOpenAll");
+	}
+	else
+	{
+		async = caesarAsyncOpen(slotId, fmName, depth, &retValue);
+		checkOperation(retValue, "caesarAsyncOpen");
+	}
+	window = (uint32_t)depth * (uint32_t)caesarAsyncStats(async, NULL, 0);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while(done<recordCount)
+	{
+		// Keeps the pipeline full, then collects one completion.
+		for(; next<recordCount && next - done<window; next++)
+		{
+			if(records[next].length>CAESAR_MAX_DATA_SIZE)
+			{
+				printf("Record %u is too long for a message.\n", next);
+				exit(1);
+			}
+			caesarAsyncSubmit(async, records[next].operation, records[next].text, records[next].length, (void*)(intptr_t)next);
+		}
+		if(!caesarAsyncWait(async, &completion))
+			break;
+		done++;
+		index = (uint32_t)(intptr_t)completion.context;
+		latency += completion.latency;
+		len = completion.replyLength>=4 ? getBe32(completion.reply) : 0;
+		if(completion.mdStatus!=MDR_OK || completion.fmStatus!=FM_OK || completion.replyLength<4 || len>completion.replyLength - 4)
+		{
+			failed++;
+			if(completion.mdStatus!=MDR_OK)
+				printf("Record %u : MD_SendReceive failed with : %s.\n", index, MD_RvAsString(completion.mdStatus));
+			else
+				printf("Record %u : FM failed : %d\n", index, completion.fmStatus);
+		}
+		else
+			replies[index] = strndup((char*)completion.reply + 4, len);
+		free(completion.reply);
+	}
+	seconds = secondsSince(&start);
+
+	for(uint32_t ctr=0; ctr<recordCount; ctr++)
+	{
+		if(replies[ctr]!=NULL)
+			printf("Record %u : %s\n", ctr, replies[ctr]);
+		free(replies[ctr]);
+		free(records[ctr].text);
+	}
+	printf("\n%u records sent with %u requests in flight, in %.3f seconds (%u failed).\n", recordCount, window, seconds, failed);
+	if(seconds>0)
+		printf("%.0f records per second.\n", recordCount / seconds);
+	if(done>0)
+		printf("Mean latency : %.3f ms.\n", latency * 1000 / done);
+	if(allAdapters)
+		printAdapterStats(async);
+	caesarAsyncClose(async);
+	free(replies);
+	free(records);
+}
+
+
+
+// Waits for the reply to a stream begin or final, the only request outstanding. Exits if it failed.
+void waitStreamReply(CAESAR_ASYNC *async, CAESAR_COMPLETION *completion, const char *request, uint32_t replyLength)
+{
+	if(!caesarAsyncWait(async, completion))
+	{
+		printf("Stream %s was not sent.\n", request);
+		exit(1);
+	}
+	if(completion->mdStatus!=MDR_OK)
+	{
+		printf("Stream %s failed with : %s.\n", request, MD_RvAsString(completion->mdStatus));
+		exit(1);
+	}
+	if(completion->fmStatus!=FM_OK || completion->replyLength!=replyLength)
+	{
+		printf("Stream %s : FM failed : 0x%X\n", request, completion->fmStatus);
+		exit(1);
+	}
+}
+
+
+
+// Encrypts or decrypts a file into another as a stream, keeping up to depth updates in flight.
+void runStream(uint32_t direction, const char *inputName, const char *outputName, int depth)
+{
+	FILE *input = fopen(inputName, "rb");
+	FILE *output = NULL;
+	uint8_t *body = (uint8_t*)malloc(CAESAR_STREAM_UPDATE_HEADER_SIZE - 4 + STREAM_CHUNK_SIZE);
+	CAESAR_ASYNC *async = NULL;
+	CAESAR_COMPLETION completion;
+	uint32_t streamId = 0, adapter = 0, len = 0, failed = 0;
+	uint64_t total = 0, chunk = 0, next = 0, done = 0;
+	struct timespec start;
+	double seconds = 0;
+	bool eof = false;
+
+	if(input==NULL || (output = fopen(outputName, "wb"))==NULL)
+	{
+		printf("Failed to open %s.\n", input==NULL ? inputName : outputName);
+		exit(1);
+	}
+	async = caesarAsyncOpen(slotId, fmName, depth, &retValue);
+	checkOperation(retValue, "caesarAsyncOpen");
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	// Opens the stream; its context lives in the FM of the adapter that replied.
+	putBe32(body, CAESAR_OP_STREAM_BEGIN);
+	putBe32(body + 4, direction);
+	caesarAsyncSend(async, body, 8, 4, NULL);
+	waitStreamReply(async, &completion, "begin", 4);
+	streamId = getBe32(completion.reply);
+	adapter = completion.adapter;
+	free(completion.reply);
+
+	// Reads and sends the chunks while fewer than depth are in flight, and writes each reply at its offset.
+	putBe32(body, CAESAR_OP_STREAM_UPDATE);
+	putBe32(body + 4, streamId);
+	while(!eof || done<next)
+	{
+		while(!eof && failed==0 && next - done<(uint64_t)depth)
+		{
+			len = (uint32_t)fread(body + 20, 1, STREAM_CHUNK_SIZE, input);
+			if(len==0)
+			{
+				eof = true;
+				break;
+			}
+			putBe32(body + 8, (uint32_t)(total >> 32));
+			putBe32(body + 12, (uint32_t)total);
+			putBe32(body + 16, len);
+			caesarAsyncSendTo(async, adapter, body, 20 + len, 4 + len, (void*)(intptr_t)next);
+			total += len;
+			next++;
+		}
+		if(done==next)
+			break;
+		caesarAsyncWait(async, &completion);
+		done++;
+		chunk = (uint64_t)(intptr_t)completion.context;
+		len = completion.replyLength>=4 ? getBe32(completion.reply) : 0;
+		if(completion.mdStatus!=MDR_OK || completion.fmStatus!=FM_OK || completion.replyLength<4 || len!=completion.replyLength - 4)
+		{
+			if(failed++==0)
+				printf("Chunk %lu failed : MD status %s, FM status 0x%X.\n", (unsigned long)chunk,
+				       MD_RvAsString(completion.mdStatus), completion.fmStatus);
+		}
+		else if(fseeko(output, (off_t)(chunk * STREAM_CHUNK_SIZE), SEEK_SET)!=0 || fwrite(completion.reply + 4, 1, len, output)!=len)
+		{
+			printf("Failed to write %s.\n", outputName);
+			failed++;
+		}
+		free(completion.reply);
+	}
+
+	// Closes the stream, even after a failure, to free its context in the FM.
+	putBe32(body, CAESAR_OP_STREAM_FINAL);
+	putBe32(body + 4, streamId);
+	putBe32(body + 8, (uint32_t)(total >> 32));
+	putBe32(body + 12, (uint32_t)total);
+	caesarAsyncSendTo(async, adapter, body, 16, 8, NULL);
+	if(failed==0)
+	{
+		waitStreamReply(async, &completion, "final", 8);
+		free(completion.reply);
+	}
+	seconds = secondsSince(&start);
+	caesarAsyncClose(async);
+	fclose(input);
+	fclose(output);
+	free(body);
+	if(failed)
+	{
+		printf("%u chunks failed.\n", failed);
+		exit(1);
+	}
+
+	printf("%lu bytes in %lu chunks sent to adapter %u, with up to %d in flight, in %.3f seconds.\n",
+	       (unsigned long)total, (unsigned long)next, adapter, depth, seconds);
+	if(seconds>0)
+		printf("%.1f MB per second.\n", total / seconds / 1e6);
+}
+
+
+
 int main(int argc, char *argv[])
 {
 	char *operation=NULL;
@@ -154,10 +602,43 @@ int main(int argc, char *argv[])
 	strncpy(operation, (char*)argv[2], 2);
 
 	// Read the message passed as argument.
-	message = malloc(strlen((const char*)argv[3]));
-	strncpy(message, (char*)argv[3], strlen((const char*)argv[3]));
+	message = strdup((const char*)argv[3]);
 
-	if(strncmp(operation, "-E", 2)==0)
+	if(strncmp(operation, "-B", 2)==0)
+	{
+		connectToFM();
+		runBatch((const char*)argv[3]);
+		MD_Finalize();
+		return 0;
+	}
+	else if(strncmp(operation, "-P", 2)==0 || strncmp(operation, "-M", 2)==0)
+	{
+		int depth = argc>4 ? atoi((const char*)argv[4]) : DEFAULT_DEPTH;
+		if(depth<1)
+		{
+			printf("%s is an invalid depth.\n", argv[4]);
+			exit(1);
+		}
+		runPipelined((const char*)argv[3], depth, operation[1]=='M');
+		return 0;
+	}
+	else if(strncmp(operation, "-S", 2)==0)
+	{
+		int depth = argc>6 ? atoi((const char*)argv[6]) : DEFAULT_DEPTH;
+		if(argc<6 || (strcmp(argv[3], "E")!=0 && strcmp(argv[3], "D")!=0))
+		{
+			usage((char*)argv[0]);
+			exit(1);
+		}
+		if(depth<1)
+		{
+			printf("%s is an invalid depth.\n", argv[6]);
+			exit(1);
+		}
+		runStream(argv[3][0]=='E' ? CAESAR_OP_ENCRYPT : CAESAR_OP_DECRYPT, (const char*)argv[4], (const char*)argv[5], depth);
+		return 0;
+	}
+	else if(strncmp(operation, "-E", 2)==0)
 		doEncryption = 1;
 	else if(strncmp(operation, "-D", 2)==0)
 		doEncryption = 0;
@@ -166,6 +647,11 @@ int main(int argc, char *argv[])
 		printf("%s is an invalid operation. Please use -E to encrypt, or -D to decrypt.\n", operation);
 		exit(1);
 	}
+	if(strlen(message)>CAESAR_MAX_DATA_SIZE)
+	{
+		printf("The message is longer than %d bytes.\n", CAESAR_MAX_DATA_SIZE);
+		exit(1);
+	}
 	connectToFM();
 	printf("FM Name is : %s.\n", fmName);
 	printf("FM ID is : %04x\n", fmid);
@@ -173,6 +659,8 @@ int main(int argc, char *argv[])
 	printf("Embedded Slot ID : %ld.\n", embeddedSlotId);
 	sendRequest();
 	printf("Received message : %s.\n", buffer);
+	free(buffer);
+	free(message);
 
 	// Finalize Message Dispatch.
 	MD_Finalize();
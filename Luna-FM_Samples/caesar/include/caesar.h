@@ -5,10 +5,10 @@
 #include <stddef.h>
 
 #include "fm/hsm/fm.h"
+#include "caesar_protocol.h"
 
 #define CAESAR_FM_ID FMID_ALLOCATE_NORM
 #define CAESAR_FM_PRODUCT_ID "Caesar"
 #define CAESAR_FM_MANUFACTURER_ID "Thales"
-#define BUFFER_SIZE 128
 
 #endif
@@ -0,0 +1,64 @@
+#ifndef CAESAR_PROTOCOL_H
+#define CAESAR_PROTOCOL_H
+
+// Messages exchanged between the Caesar FM and its host applications.
+
+// Every request starts with the embedded slot number and the operation, as big-endian 32-bit integers.
+#define CAESAR_OP_DECRYPT 0
+#define CAESAR_OP_ENCRYPT 1
+#define CAESAR_OP_BATCH 2
+
+// Largest request or reply the host sends to or expects from the FM.
+#define CAESAR_MAX_MESSAGE_SIZE (64 * 1024)
+
+// Largest text of a single encrypt or decrypt message : the request also holds the slot, operation and length.
+#define CAESAR_MAX_DATA_SIZE (CAESAR_MAX_MESSAGE_SIZE - 12)
+
+
+// Batch messages carry many records in one MD_SendReceive. All integers are big-endian 32-bit.
+//   request : slot, CAESAR_OP_BATCH, version, record count, then per record : operation, length, payload.
+//   reply   : version, record count, then per record : status, length, payload.
+// A record that fails gets a status other than CAESAR_RECORD_OK and an empty payload; the other records are processed.
+#define CAESAR_BATCH_VERSION 1
+#define CAESAR_BATCH_MAX_RECORDS 1024
+#define CAESAR_BATCH_HEADER_SIZE 8 // version and record count.
+#define CAESAR_RECORD_HEADER_SIZE 8 // operation (or status) and length.
+
+#define CAESAR_RECORD_OK 0
+#define CAESAR_RECORD_BAD_OPERATION 1
+
+// Reply status of a batch whose version the FM does not support.
+#define CAESAR_ERR_UNSUPPORTED_VERSION 0xCAE50001
+
+
+// Stream messages process an input of any length as a sequence of chunks, with a small context held by the FM
+// between requests. Integers are big-endian 32-bit, except offsets and totals which are 64-bit (high word first).
+//   begin  : slot, CAESAR_OP_STREAM_BEGIN, CAESAR_OP_ENCRYPT or CAESAR_OP_DECRYPT.  reply : stream id.
+//   update : slot, CAESAR_OP_STREAM_UPDATE, stream id, offset, length, payload.   reply : length, payload.
+//   final  : slot, CAESAR_OP_STREAM_FINAL, stream id, total length.               reply : total length.
+// Each chunk of a Caesar stream is independent, so updates may be in flight together and complete in any order.
+// final checks that the updates add up to the total and frees the context, whatever its status.
+// A client that dies before final leaves its context behind. When all contexts are in use, begin takes over the
+// one used least recently, if the FM has handled CAESAR_STREAM_IDLE_MESSAGES messages since it was last used.
+// Idle time is counted in messages to the whole FM, not in seconds : while the table is full, a live stream that
+// waits longer than CAESAR_STREAM_IDLE_MESSAGES messages of other clients between two requests can be taken over,
+// and its next request fails with CAESAR_ERR_NO_STREAM. Such a client has to start its stream again.
+// A context belongs to the FM of one adapter : all the messages of a stream must be sent to the same adapter.
+#define CAESAR_OP_STREAM_BEGIN 3
+#define CAESAR_OP_STREAM_UPDATE 4
+#define CAESAR_OP_STREAM_FINAL 5
+
+#define CAESAR_MAX_STREAMS 64 // Streams open at once in the FM.
+#define CAESAR_STREAM_IDLE_MESSAGES 4096 // Messages without a request for a stream after which it can be taken over.
+#define CAESAR_STREAM_UPDATE_HEADER_SIZE 24 // slot, operation, stream id, offset and length.
+#define CAESAR_STREAM_MAX_CHUNK (CAESAR_MAX_MESSAGE_SIZE - CAESAR_STREAM_UPDATE_HEADER_SIZE)
+
+// Reply status of a begin when all contexts are in use and none is idle, or of an update or final with an unknown
+// (finished or taken over) stream id.
+#define CAESAR_ERR_NO_STREAM 0xCAE50002
+// Reply status of a final when the updates overlap, leave a gap or do not end at the total length.
+#define CAESAR_ERR_STREAM_LENGTH 0xCAE50003
+// Reply status of a begin with an operation other than CAESAR_OP_ENCRYPT or CAESAR_OP_DECRYPT.
+#define CAESAR_ERR_BAD_OPERATION 0xCAE50004
+
+#endif
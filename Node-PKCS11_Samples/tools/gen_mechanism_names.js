@@ -1,35 +1,114 @@
 #!/usr/bin/env node
-/** One-shot: convert lunacm "partition showmechanism" text dump -> lib/mechanism_names.js */
+/**
+ * Generates the mechanism name tables shared by the Node and C samples:
+ *   - lib/mechanism_names.js
+ *   - ../C_Samples/misc/mechanism_names.h
+ *
+ * Inputs are a lunacm "partition showmechanism" text dump, and optionally cryptoki headers
+ * (e.g. cryptoki_v2.h from the Luna SDK) whose CKM_* defines add the names the dump does not list.
+ * When several names share a code, the dump name wins, then the first name defined in a header.
+ *
+ * --require <file> lists CKM_* names (one per line, # for comments) the C table must name, e.g.
+ * tools/luna_mechanism_names.txt. A required name that no input gives a code for is added to the C header as an
+ * entry resolved by the compiler from cryptoki_v2.h, guarded by #ifdef so other headers still compile.
+ * In the C table, a required name also wins the code it names, so the C samples print the names they always printed.
+ */
 "use strict";
 const fs = require("fs");
 const path = require("path");
 
-const src = process.argv[2];
+const args = process.argv.slice(2);
+let required = [];
+const requireAt = args.indexOf("--require");
+if (requireAt >= 0) {
+  required = fs
+    .readFileSync(args[requireAt + 1], "utf8")
+    .split(/\r?\n/)
+    .map((line) => line.replace(/#.*/, "").trim())
+    .filter((line) => line.startsWith("CKM_"));
+  args.splice(requireAt, 2);
+}
+const [src, ...headers] = args;
 if (!src) {
-  console.error("Usage: node tools/gen_mechanism_names.js <lunacm-dump.txt>");
+  console.error("Usage: node tools/gen_mechanism_names.js <lunacm-dump.txt> [cryptoki-header.h ...] [--require names.txt]");
   process.exit(1);
 }
+
+const byName = new Map(); // name -> code
+const canonical = new Map(); // code -> name
+
 const text = fs.readFileSync(src, "utf8");
 const re = /^\s*0x([0-9a-fA-F]+)\s+-\s+(CKM_\S+)/gm;
-const map = new Map();
 let m;
 while ((m = re.exec(text))) {
-  map.set(parseInt(m[1], 16), m[2]);
+  const code = parseInt(m[1], 16) >>> 0;
+  byName.set(m[2], code);
+  canonical.set(code, m[2]);
 }
-const ids = [...map.keys()].sort((a, b) => a - b);
-const lines = [
+
+// Resolves "#define CKM_X <expr>" where <expr> is a number, another define, or a sum / shift of those.
+for (const header of headers) {
+  const defines = new Map();
+  const order = [];
+  const dre = /^\s*#\s*define\s+(CK[MA]?_\w+)\s+(.+?)\s*(?:\/\/.*|\/\*.*)?$/gm;
+  const htext = fs.readFileSync(header, "utf8");
+  while ((m = dre.exec(htext))) {
+    defines.set(m[1], m[2]);
+    if (m[1].startsWith("CKM_") && m[1] !== "CKM_VENDOR_DEFINED") order.push(m[1]);
+  }
+  const resolve = (expr, depth) => {
+    if (depth > 16) return undefined;
+    const e = expr.replace(/\((?:unsigned long|CK_ULONG|CK_MECHANISM_TYPE)\)/g, "").replace(/[()]/g, "").trim();
+    const shift = e.split("<<");
+    if (shift.length === 2) {
+      const a = resolve(shift[0], depth + 1), b = resolve(shift[1], depth + 1);
+      return a === undefined || b === undefined ? undefined : (a * 2 ** b) >>> 0;
+    }
+    const terms = e.split(/[+|]/);
+    if (terms.length > 1) {
+      let sum = 0;
+      for (const t of terms) {
+        const v = resolve(t, depth + 1);
+        if (v === undefined) return undefined;
+        sum += v;
+      }
+      return sum >>> 0;
+    }
+    if (/^(0x[0-9a-fA-F]+|\d+)[uUlL]*$/.test(e)) return parseInt(e.replace(/[uUlL]+$/, ""), e.startsWith("0x") ? 16 : 10) >>> 0;
+    if (defines.has(e)) return resolve(defines.get(e), depth + 1);
+    return undefined;
+  };
+  for (const name of order) {
+    const code = resolve(defines.get(name), 0);
+    if (code === undefined || byName.has(name)) continue;
+    byName.set(name, code);
+    if (!canonical.has(code)) canonical.set(code, name);
+  }
+}
+
+const fromHeader = [...new Set(required)].filter((name) => !byName.has(name)).sort();
+const canonicalC = new Map(canonical);
+for (const name of required) if (byName.has(name)) canonicalC.set(byName.get(name), name);
+const names = [...byName.keys()].sort((a, b) => (a < b ? -1 : a > b ? 1 : 0)); // strcmp order
+const codes = [...canonical.keys()].sort((a, b) => a - b);
+const indexOf = new Map(names.map((n, i) => [n, i]));
+const hex = (v, w) => "0x" + v.toString(16).padStart(w, "0");
+
+const js = [
   '"use strict";',
   "",
   "/**",
-  " * CKM_* names graphene-pk11 does not resolve.",
-  ' * Generated from Luna lunacm: partition showmechanism',
+  " * CKM_* name of every mechanism code listed by the HSM or defined in the cryptoki headers, and the code of every",
+  " * name including aliases.",
+  " * Generated by tools/gen_mechanism_names.js from Luna lunacm: partition showmechanism,",
+  " * and shared with C_Samples/misc/mechanism_names.h.",
   " */",
   "const NAMES = {",
 ];
-for (const id of ids) {
-  lines.push(`  0x${id.toString(16)}: "${map.get(id)}",`);
-}
-lines.push(
+for (const code of codes) js.push(`  ${hex(code, 1)}: "${canonical.get(code)}",`);
+js.push("};", "", "/** Code of every known name, including the aliases of a code. */", "const CODES = {");
+for (const name of names) js.push(`  ${name}: ${hex(byName.get(name), 1)},`);
+js.push(
   "};",
   "",
   "let pkcs11ByValue = null;",
@@ -59,9 +138,130 @@ lines.push(
   '  return "0x" + t.toString(16);',
   "}",
   "",
-  "module.exports = { mechanismName, NAMES };",
+  "/** Code of a mechanism name, with or without the CKM_ prefix. undefined if unknown. */",
+  "function mechanismCode(name) {",
+  '  const n = String(name).startsWith("CKM_") ? String(name) : "CKM_" + name;',
+  "  return Object.prototype.hasOwnProperty.call(CODES, n) ? CODES[n] : undefined;",
+  "}",
+  "",
+  "module.exports = { mechanismName, mechanismCode, NAMES, CODES };",
   ""
 );
-const out = path.join(__dirname, "..", "lib", "mechanism_names.js");
-fs.writeFileSync(out, lines.join("\n"));
-console.log("Wrote", out, "(" + map.size + " names)");
+
+const c = [
+  "/*",
+  " * Mechanism names shared by the misc samples.",
+  " * Generated by Node-PKCS11_Samples/tools/gen_mechanism_names.js, do not edit.",
+  " *",
+  " * mechanismNames[] is sorted by name, and mechanismsByCode[] holds one index into it per code, sorted by code,",
+  " * so both lookups are a binary search over a constant table.",
+  " * Everything is static, so the header can be included by several files of the same program.",
+  " * Names without a code in the generator inputs are in mechanismNamesFromHeader[], resolved from cryptoki_v2.h.",
+  " */",
+  "",
+  "#ifndef MECHANISM_NAMES_H",
+  "#define MECHANISM_NAMES_H",
+  "",
+  "#include <string.h>",
+  "",
+  "",
+  "typedef struct",
+  "{",
+  "\tCK_MECHANISM_TYPE code;",
+  "\tconst char *name;",
+  "} MECHANISM_NAME;",
+  "",
+  "",
+  "static const MECHANISM_NAME mechanismNames[] = {",
+];
+names.forEach((name, i) => c.push(`\t{${hex(byName.get(name), 8)}, "${name}"}${i + 1 < names.length ? "," : ""}`));
+c.push("};", "", "static const unsigned short mechanismsByCode[] = {");
+for (let i = 0; i < codes.length; i += 12) {
+  const row = codes.slice(i, i + 12).map((code) => indexOf.get(canonicalC.get(code)));
+  c.push("\t" + row.join(", ") + (i + 12 < codes.length ? "," : ""));
+}
+c.push(
+  "};",
+  "",
+  "#define MECHANISM_NAME_COUNT (sizeof(mechanismNames)/sizeof(*mechanismNames))",
+  "#define MECHANISM_CODE_COUNT (sizeof(mechanismsByCode)/sizeof(*mechanismsByCode))",
+  "",
+  "",
+  "// Luna mechanisms with no code in the generator inputs. Their codes come from cryptoki_v2.h at compile time,",
+  "// so they are searched linearly after the tables above. The list ends with a NULL name.",
+  "static const MECHANISM_NAME mechanismNamesFromHeader[] = {"
+);
+for (const name of fromHeader) c.push(`#ifdef ${name}`, `\t{${name}, "${name}"},`, "#endif");
+c.push(
+  "\t{0, NULL}",
+  "};",
+  "",
+  "",
+  "",
+  "// Returns the name of a mechanism code, or NULL if the code is unknown.",
+  "static inline const char *mechanismNameOf(CK_MECHANISM_TYPE code)",
+  "{",
+  "\tsize_t low = 0, high = MECHANISM_CODE_COUNT;",
+  "",
+  "\twhile(low<high)",
+  "\t{",
+  "\t\tsize_t mid = (low + high) / 2;",
+  "\t\tconst MECHANISM_NAME *entry = &mechanismNames[mechanismsByCode[mid]];",
+  "\t\tif(entry->code==code)",
+  "\t\t\treturn entry->name;",
+  "\t\tif(entry->code<code)",
+  "\t\t\tlow = mid + 1;",
+  "\t\telse",
+  "\t\t\thigh = mid;",
+  "\t}",
+  "\tfor(const MECHANISM_NAME *entry=mechanismNamesFromHeader; entry->name!=NULL; entry++)",
+  "\t\tif(entry->code==code)",
+  "\t\t\treturn entry->name;",
+  "\treturn NULL;",
+  "}",
+  "",
+  "",
+  "",
+  "// Finds the code of a mechanism name. Returns 0 if the name is unknown.",
+  "static inline int mechanismCodeOf(const char *name, CK_MECHANISM_TYPE *code)",
+  "{",
+  "\tsize_t low = 0, high = MECHANISM_NAME_COUNT;",
+  "",
+  "\twhile(low<high)",
+  "\t{",
+  "\t\tsize_t mid = (low + high) / 2;",
+  "\t\tint cmp = strcmp(mechanismNames[mid].name, name);",
+  "\t\tif(cmp==0)",
+  "\t\t{",
+  "\t\t\t*code = mechanismNames[mid].code;",
+  "\t\t\treturn 1;",
+  "\t\t}",
+  "\t\tif(cmp<0)",
+  "\t\t\tlow = mid + 1;",
+  "\t\telse",
+  "\t\t\thigh = mid;",
+  "\t}",
+  "\tfor(const MECHANISM_NAME *entry=mechanismNamesFromHeader; entry->name!=NULL; entry++)",
+  "\t{",
+  "\t\tif(strcmp(entry->name, name)==0)",
+  "\t\t{",
+  "\t\t\t*code = entry->code;",
+  "\t\t\treturn 1;",
+  "\t\t}",
+  "\t}",
+  "\treturn 0;",
+  "}",
+  "",
+  "#endif",
+  ""
+);
+
+const jsOut = path.join(__dirname, "..", "lib", "mechanism_names.js");
+const cOut = path.join(__dirname, "..", "..", "C_Samples", "misc", "mechanism_names.h");
+fs.writeFileSync(jsOut, js.join("\n"));
+fs.writeFileSync(cOut, c.join("\n"));
+console.log("Wrote", jsOut, "and", cOut, "(" + names.length + " names, " + codes.length + " codes)");
+if (fromHeader.length) {
+  console.log(fromHeader.length + " required names have no code in the inputs; the C header resolves them from cryptoki_v2.h:");
+  console.log("  " + fromHeader.join(" "));
+}